@@ -6,11 +6,39 @@
 #include <LWETypes.h>
 #include <LWEJobQueue.h>
 #include "State.h"
+#include "ExportShard.h"
 
 class Renderer;
 
 class Scene;
 
+class ExportServer;
+
+struct ServerJob;
+
+//Paths for an unattended export run from the command line, the export is run to completion and the app exits without taking any input.
+//Usage: IsoSpriteGenerator [--software] [--texture-arrays] [--verify-meta] --export <Model.gltf> <Settings.json> <Output.png>
+//Or, to keep running and take export jobs from ExportServer: IsoSpriteGenerator [--software] [--texture-arrays] [--verify-meta] --server [Port]
+//Exports can be split by adding --shard <Index> <Count> to --export, and the shards packed together afterwards with: IsoSpriteGenerator --merge <Output.png>
+struct BatchExport {
+	static const uint32_t NoBatch = 0; //No --export or --server argument was passed, run normally.
+	static const uint32_t Valid = 1;
+	static const uint32_t Invalid = 2; //--export, --shard, or --merge was passed with missing or invalid arguments.
+
+	char8_t m_ModelPath[256];
+	char8_t m_SettingsPath[256];
+	char8_t m_OutputPath[256];
+	bool m_Software = false; //--software renders the export on the cpu instead of the gpu.
+	bool m_TextureArrays = false; //--texture-arrays packs material textures into texture arrays, see RenderSettings::m_TextureArrays.
+	bool m_VerifyMeta = false; //--verify-meta fails the export unless the binary meta-data reads back the same as the json, see State_Viewer::VerifyMetaData.
+	bool m_Server = false;
+	bool m_Merge = false; //--merge only packs existing shards, m_OutputPath is the only path set.
+	ExportShard m_Shard;
+	uint16_t m_ServerPort = 0; //0 uses ExportServer::DefaultPort.
+
+	static uint32_t ParseArguments(int32_t argc, LWUTF8Iterator *argv, BatchExport &Batch);
+};
+
 class App {
 public:
 	static const uint32_t MessageFreq = 3; //Seconds.
@@ -21,7 +49,14 @@ public:
 
 	void RenderJob(LWEJob &J, LWEJobThread &Th, LWEJobQueue &Q, uint64_t lCurrentTime);
 
-	void Run(void);
+	//Replaces InputJob for batch exports, finishes the job queue once the export is done.
+	void BatchJob(LWEJob &J, LWEJobThread &Th, LWEJobQueue &Q, uint64_t lCurrentTime);
+
+	//Replaces InputJob for server mode, runs queued export jobs one after another until the server is told to quit.
+	void ServeJob(LWEJob &J, LWEJobThread &Th, LWEJobQueue &Q, uint64_t lCurrentTime);
+
+	//Returns the exit code for the process.
+	int32_t Run(void);
 
 	void SetMessage(const LWUTF8Iterator &Message);
 
@@ -44,7 +79,9 @@ public:
 
 	LWAllocator &GetAllocator(void);
 
-	App(LWAllocator &Allocator);
+	bool isBatchMode(void) const;
+
+	App(LWAllocator &Allocator, const BatchExport *Batch = nullptr);
 
 	~App();
 private:
@@ -57,10 +94,15 @@ private:
 	LWEUIManager *m_UIManager = nullptr;
 	LWEAssetManager *m_AssetManager = nullptr;
 	LWEUILabel *m_MessageLbl = nullptr;
+	ExportServer *m_Server = nullptr;
+	ServerJob *m_ActiveJob = nullptr;
 	uint64_t m_LastUpdateTime = -1;
 	uint64_t m_LastInputTime = -1;
 	uint64_t m_MessageTime = 0;
 	uint32_t m_ActiveState = State::Viewer;
+	int32_t m_ExitCode = 0;
+	bool m_BatchMode = false;
+	bool m_TextureArrays = false; //Applied with the renderer's first settings, before any material texture is loaded.
 };
 
 #endif
\ No newline at end of file
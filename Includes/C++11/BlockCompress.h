@@ -0,0 +1,36 @@
+#ifndef BLOCKCOMPRESS_H
+#define BLOCKCOMPRESS_H
+#include <LWCore/LWTypes.h>
+
+//CPU encoders for the BCn block formats used by sheet exports, each block covers 4x4 texels.
+struct BlockCompress {
+	static const uint32_t BC4 = 0; //Single channel, 8 bytes per block.
+	static const uint32_t BC5 = 1; //Two channels each stored as a BC4 block, 16 bytes per block.
+	static const uint32_t BC7 = 2; //RGBA, 16 bytes per block.
+	static const uint32_t FormatCount = 3;
+
+	static const uint32_t QualityFast = 0; //Bounding box endpoints.
+	static const uint32_t QualityNormal = 1; //Principal axis endpoints with p-bit search.
+	static const uint32_t QualityBest = 2; //Normal, followed by least squares endpoint refinement.
+	static const uint32_t QualityCount = 3;
+
+	static const char8_t *FormatNames[FormatCount];
+
+	//Returns the number of bytes per 4x4 block.
+	static uint32_t GetBlockSize(uint32_t Format);
+
+	//Values are 16 single channel texels in row order.
+	static void EncodeBC4Block(const uint8_t *Values, uint8_t *Out, uint32_t Quality);
+
+	//Texels are 16 RGBA8 texels in row order, ChannelA and ChannelB select which components are stored in the red/green blocks.
+	static void EncodeBC5Block(const uint8_t *Texels, uint32_t ChannelA, uint32_t ChannelB, uint8_t *Out, uint32_t Quality);
+
+	//Texels are 16 RGBA8 texels in row order, encoded with mode 6(single subset with alpha).
+	static void EncodeBC7Block(const uint8_t *Texels, uint8_t *Out, uint32_t Quality);
+
+	//Compresses Height rows of RGBA8 texels with Width texels per row, both Width and Height must be a multiple of 4.
+	//Block rows are written sequentially into Out, and are split into one contiguous span per worker across at most ThreadCount threads of a persistent pool(0 uses every pool thread).
+	static void CompressRows(const uint8_t *Rows, uint32_t Width, uint32_t Height, uint32_t Format, uint32_t ChannelA, uint32_t ChannelB, uint32_t Quality, uint8_t *Out, uint32_t ThreadCount = 0);
+};
+
+#endif
\ No newline at end of file
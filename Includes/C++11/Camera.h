@@ -77,7 +77,9 @@ public:
 
 	static uint32_t GetPassesForConeInCamerasf(uint32_t CameraCnt, const LWSVector4f &Position, const LWSVector4f &Direction, float Length, float Theta, ...);
 
-	static uint32_t MakeCascadeCameraViews(const LWSVector4f &LightDir, const LWSVector4f &ViewPosition, const LWSVector4f *ViewFrustumPoints, const LWSMatrix4f &ProjViewMatrix, Camera *CamBuffer, uint32_t CascadeCnt, const LWSVector4f &SceneAABBMin, const LWSVector4f &SceneAABBMax);
+	//Splits the part of the view frustum that overlaps the scene's world bounds into CascadeCnt orthographic light cameras, each clipped to the bounds so no shadow texels are spent outside the scene.
+	//The extents are snapped to ShadowMapSize texels so the cascades stay stable while the bounds change between frames, 0 skips snapping.
+	static uint32_t MakeCascadeCameraViews(const LWSVector4f &LightDir, const LWSVector4f &ViewPosition, const LWSVector4f *ViewFrustumPoints, Camera *CamBuffer, uint32_t CascadeCnt, const LWSVector4f &SceneAABBMin, const LWSVector4f &SceneAABBMax, uint32_t ShadowMapSize);
 
 	Camera &SetPosition(const LWSVector4f &Position);
 
@@ -0,0 +1,73 @@
+#ifndef EXPORTSERVER_H
+#define EXPORTSERVER_H
+#include <LWCore/LWTypes.h>
+#include <LWNetwork/LWSocket.h>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+//An export request received by ExportServer, times are LWTimer values.
+struct ServerJob {
+	char8_t m_ModelPath[256];
+	char8_t m_SettingsPath[256];
+	char8_t m_OutputPath[256];
+	LWSocket m_Client;
+	uint32_t m_ID = 0;
+	uint64_t m_QueuedTime = 0;
+	uint64_t m_StartTime = 0;
+	uint64_t m_LoadedTime = 0;
+	bool m_SceneCached = false; //The model was already loaded by an earlier job.
+};
+
+//Accepts export jobs from local clients and queues them for App to run one at a time, so assets, shaders, and loaded scenes stay resident between exports.
+//Each connection sends one tab separated line, read on a thread of it's own so a slow client doesn't hold up other connections, and is answered once it's job finishes:
+//	export\t<Model.gltf>\t<Settings.json>\t<Output.png>\n -> done <ID> <ok|failed> queue=<ms> load=<ms> export=<ms> total=<ms> cached=<0|1>\n
+//	quit\n -> ok quit\n, no further jobs are accepted and the server exits once the queue is empty.
+class ExportServer {
+public:
+	static const uint16_t DefaultPort = 7420;
+	static const uint32_t MaxLineLength = 1024;
+	static const uint32_t MaxReadingClients = 16; //Connections still sending their request, further connections are turned away until one finishes.
+
+	//Starts listening for jobs on Port, only loopback connections are accepted.
+	bool Start(uint16_t Port);
+
+	//Returns the next queued job or null if the queue is empty, the caller owns the job until it's passed to FinishJob.
+	ServerJob *PopJob(void);
+
+	//Replies to the job's client with the result and timings, then releases the job.
+	void FinishJob(ServerJob *Job, bool Result);
+
+	//Returns true once quit was requested and every queued job has been taken.
+	bool isFinished(void);
+
+	ExportServer(LWAllocator &Allocator);
+
+	~ExportServer();
+private:
+	void ListenThread(void);
+
+	//Reads Job's request and queues it, or replies and releases the job if it isn't an export.
+	void ReadThread(ServerJob *Job);
+
+	//Reads a single line from Client, without the line ending, returns false if the client disconnected first or the line is too long.
+	bool ReadLine(LWSocket &Client, char *Buffer, uint32_t BufferLen);
+
+	void Reply(LWSocket &Client, const char *Text);
+
+	LWAllocator &m_Allocator;
+	LWSocket m_Listener;
+	std::thread m_Thread;
+	std::mutex m_QueueLock;
+	std::deque<ServerJob*> m_Queue;
+	std::vector<ServerJob*> m_Reading; //Jobs whose request is still being read, their clients are closed on shutdown to wake the reader.
+	std::condition_variable m_ReadersDone;
+	uint32_t m_ReaderCount = 0; //Reader threads that haven't exited, guarded by m_QueueLock like m_Reading.
+	std::atomic<bool> m_Quit{ false };
+	uint32_t m_NextJobID = 0;
+};
+
+#endif
\ No newline at end of file
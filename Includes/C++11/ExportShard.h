@@ -0,0 +1,34 @@
+#ifndef EXPORTSHARD_H
+#define EXPORTSHARD_H
+#include <LWCore/LWTypes.h>
+#include <LWCore/LWUnicode.h>
+
+//Selects a contiguous range of directions for an export to render, so a large export can be split across processes or machines and packed back together with Merge.
+//Every shard lays out the full sheet exactly as a single export would, but only renders it's own directions.  Shards always write lossless QOI sheets, and a meta-data json that also records the final export settings:
+//	<Output>.shard<Index>.json, <Output>.shard<Index>.qoi, <Output>.shard<Index>_Normals.qoi, etc.
+struct ExportShard {
+	static const uint32_t MaxShards = 256;
+
+	uint32_t m_Index = 0;
+	uint32_t m_Count = 0; //0 when the export isn't split.
+
+	//Packs the sheets of every shard of OutputPath into the final sheets, and writes the combined meta-data, the result is identical to running the same export in a single process.
+	//Shard files are expected next to OutputPath, and are left in place.
+	static bool Merge(const LWUTF8Iterator &OutputPath, LWAllocator &Allocator);
+
+	//Directions are spread as evenly as possible, with the remainder going to the later shards.
+	uint32_t GetFirstDirection(uint32_t DirectionCnt) const;
+
+	uint32_t GetDirectionCount(uint32_t DirectionCnt) const;
+
+	//Writes OutputPath with it's extension replaced by the shard's suffix(i.e. Output.shard0) to Buffer.
+	void MakePathNoExt(const LWUTF8Iterator &OutputPath, char8_t *Buffer, uint32_t BufferLen) const;
+
+	bool isSharded(void) const;
+
+	ExportShard(uint32_t Index, uint32_t Count);
+
+	ExportShard() = default;
+};
+
+#endif
\ No newline at end of file
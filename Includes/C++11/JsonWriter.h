@@ -0,0 +1,62 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+#include <LWCore/LWTypes.h>
+#include <LWCore/LWUnicode.h>
+#include <LWPlatform/LWFileStream.h>
+
+//Streaming json writer, elements are written straight to the file through a small fixed buffer so the output size is unbounded and no document is built in memory.
+//The root object is opened by Open and closed by Finish, Name should be null for elements inside of arrays.
+class JsonWriter {
+public:
+	static const uint32_t BufferSize = 16 * 1024;
+	static const uint32_t MaxDepth = 32;
+	static const uint32_t MaxStringLength = 1024;
+
+	bool Open(const LWUTF8Iterator &Path, LWAllocator &Allocator);
+
+	JsonWriter &BeginObject(const char8_t *Name = nullptr);
+
+	JsonWriter &EndObject(void);
+
+	JsonWriter &BeginArray(const char8_t *Name = nullptr);
+
+	JsonWriter &EndArray(void);
+
+	JsonWriter &Value(const char8_t *Name, float Value);
+
+	JsonWriter &Value(const char8_t *Name, double Value);
+
+	JsonWriter &Value(const char8_t *Name, int32_t Value);
+
+	JsonWriter &Value(const char8_t *Name, uint32_t Value);
+
+	JsonWriter &Value(const char8_t *Name, bool Value);
+
+	//Value is escaped, and truncated to MaxStringLength bytes.
+	JsonWriter &String(const char8_t *Name, const LWUTF8Iterator &Value);
+
+	//Closes the root object and flushes the remaining output, returns false if any write failed or scopes were left open.
+	bool Finish(void);
+
+	bool isOpen(void) const;
+private:
+	JsonWriter &BeginScope(const char8_t *Name, char Open);
+
+	JsonWriter &EndScope(char Close);
+
+	void WriteKey(const char8_t *Name);
+
+	void Write(const char *Text, uint32_t Len);
+
+	void Flush(void);
+
+	LWFileStream m_Stream;
+	char m_Buffer[BufferSize];
+	uint32_t m_BufferLen = 0;
+	uint32_t m_Depth = 0;
+	bool m_HasElements[MaxDepth];
+	bool m_Open = false;
+	bool m_Error = false;
+};
+
+#endif
\ No newline at end of file
@@ -109,6 +109,12 @@ public:
 
 	Material &UpdatedTweens(void);
 
+	//Stores the evaluated constants of a material that isn't animated, so they don't have to be re-evaluated every time it's drawn.  Any change to the material's tweens or transparency discards them.
+	Material &CacheConstants(const GMaterial &Constants);
+
+	//Returns null if no constants are cached.
+	const GMaterial *GetCachedConstants(void) const;
+
 	const LWETween<LWVector4f> &GetColorTween(uint32_t i) const;
 
 	const LWETween<LWVector4f> &GetTextureTween(uint32_t i) const;
@@ -141,6 +147,9 @@ public:
 
 	bool isPlaying(void) const;
 
+	//Returns true if any of the material's tweens has more than one frame, or it's a cloud material which reads it's time.
+	bool isAnimated(void) const;
+
 	Material(uint32_t PipelineID, uint32_t NameHash);
 
 	Material() = default;
@@ -155,6 +164,8 @@ private:
 	LWETween<LWVector4f> m_ColorTweens[MaxColorTweens];
 	LWETween<LWVector4f> m_TextureTweens[MaxTextures]; //SubTexture dimensions, where x,y = offset, and z,w = size(in uv units).
 	MaterialTexture m_TextureList[MaxTextures];
+	GMaterial m_Constants;
+	bool m_ConstantsCached = false;
 };
 
 #endif
\ No newline at end of file
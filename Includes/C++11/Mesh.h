@@ -44,7 +44,8 @@ struct MeshGeometry {
 	uint32_t m_TypeSize = 0;
 	uint32_t m_Count = 0;
 
-	bool UploadData(Renderer *R, LWAllocator &Allocator, bool CopyOut);
+	//Indices pass the id of the vertices they index, so they can share the renderer's geometry arenas.
+	bool UploadData(Renderer *R, LWAllocator &Allocator, bool CopyOut, uint32_t VerticeID = 0);
 
 	MeshGeometry(char *Data, uint32_t BufferType, uint32_t TypeSize, uint32_t Count);
 
@@ -10,8 +10,13 @@
 #include "Config.h"
 #include "Material.h"
 #include "Light.h"
+#include "SoftRenderer.h"
+#include "WorkerPool.h"
+#include "SlotTable.h"
 #include <atomic>
+#include <mutex>
 #include <array>
+#include <algorithm>
 
 //TODO: Fix reflection maps for IBL processing.
 
@@ -23,8 +28,12 @@ const uint32_t MaxBones = 32;
 const uint32_t MaxPassElements = 4096 * 16;
 const uint32_t MaxAnimations = 1024 * 16;
 const uint32_t MaxModels = 8192 * 8;
+const uint32_t MaxInstances = 128; //Instances drawn by a single instanced draw.
+const uint32_t MaxInstanceBlocks = 256;
 const uint32_t MaxPendingGeometry = 1024;
+const uint32_t MaxGeometryArenas = 4; //One per vertex format, plus the shared index arena.
 const uint32_t MaxPendingTexture = 1024;
+const uint32_t MaxTextureArrays = 16; //Distinct size, format and mipmap count combinations of material textures when texture arrays are enabled.
 
 const uint32_t RenderDefault = 0;
 const uint32_t RenderEmissions = 1;
@@ -60,6 +69,7 @@ struct RenderSettings {
 	uint32_t m_ShadowQuality = ShadowQuality_Ultra;
 	uint32_t m_ReflectionQuality = ReflectionQuality_Ultra;
 	uint32_t m_SampleCount = 4;
+	bool m_TextureArrays = false; //Packs material textures into texture arrays by size and format, can only be changed before the first material texture is loaded.
 
 	RenderSettings() = default;
 };
@@ -76,20 +86,322 @@ struct PendingGeometry {
 	uint32_t m_ID;
 	uint32_t m_BufferType;
 	uint32_t m_TypeSize;
-	uint32_t m_Count;
+	uint32_t m_Count; //0 releases the geometry.
+	uint32_t m_VerticeID; //For indices, the vertices they index into.
 
 	LWVideoBuffer *MakeBuffer(LWVideoDriver *Driver, LWAllocator &Allocator);
 
 	void Finished(void);
 
-	PendingGeometry(char *Data, uint32_t ID, uint32_t BufferType, uint32_t DataTypeSize, uint32_t Count);
+	PendingGeometry(char *Data, uint32_t ID, uint32_t BufferType, uint32_t DataTypeSize, uint32_t Count, uint32_t VerticeID = 0);
 
 	PendingGeometry() = default;
 };
 
+//Sub-allocates geometry of a single buffer type and element size out of one video buffer, so every model with the same vertex format shares a buffer.
+//A cpu copy of the arena is kept, so it can grow and be compacted without reading back from the gpu.
+class GeometryArena {
+public:
+	static const uint32_t InitialCapacity = 64 * 1024; //Elements.
+
+	struct Range {
+		uint32_t m_Offset;
+		uint32_t m_Count;
+	};
+
+	//Returns the element offset of Count elements, or -1 if the arena couldn't grow.  The caller writes the elements with GetData.
+	uint32_t Allocate(uint32_t Count, LWAllocator &Allocator);
+
+	//Returns the range to the free list, merging it with it's neighbours.
+	void Free(uint32_t Offset, uint32_t Count);
+
+	//Moves the element range at Offset to NewOffset, which must not be after Offset.  Used by Renderer::CompactGeometry once it has worked out where everything goes.
+	void Move(uint32_t Offset, uint32_t NewOffset, uint32_t Count);
+
+	//Subtracts Delta from Count 32 bit indices at Offset, for when the vertices they index were moved.
+	void Rebase(uint32_t Offset, uint32_t Count, uint32_t Delta);
+
+	//Drops the free list, leaving End elements in use.
+	void ResetFreeList(uint32_t End);
+
+	//Uploads the elements written since the last update, the video buffer is only recreated when the arena has grown past it's capacity.
+	bool Update(LWVideoDriver *Driver, LWAllocator &Allocator);
+
+	void Destroy(LWVideoDriver *Driver);
+
+	//True once more than half of the arena is free space.
+	bool NeedsCompaction(void) const;
+
+	bool isFormat(uint32_t BufferType, uint32_t TypeSize) const;
+
+	char *GetData(uint32_t Offset);
+
+	LWVideoBuffer *GetBuffer(void) const;
+
+	uint32_t GetUsed(void) const;
+
+	uint32_t GetEnd(void) const;
+
+	uint32_t GetTypeSize(void) const;
+
+	GeometryArena(uint32_t BufferType, uint32_t TypeSize);
+
+	GeometryArena() = default;
+private:
+	std::vector<Range> m_FreeList; //Sorted by offset.
+	char *m_Data = nullptr;
+	LWVideoBuffer *m_Buffer = nullptr;
+	uint32_t m_BufferType = 0;
+	uint32_t m_TypeSize = 0;
+	uint32_t m_Capacity = 0;
+	uint32_t m_End = 0; //Elements past the last allocation are never handed out by the free list.
+	uint32_t m_Used = 0;
+	uint32_t m_BufferCapacity = 0; //Elements m_Buffer was created with, matches m_Capacity so the buffer grows geometrically with the cpu copy.
+	uint32_t m_DirtyBegin = -1; //Element range written since the last update.
+	uint32_t m_DirtyEnd = 0;
+
+	void MarkDirty(uint32_t Offset, uint32_t Count);
+};
+
+//Stands in for a fence per uniform ring region, as the driver exposes none.  Signal clears the region's 1x1 target with a new tag after the last draw that reads the region is queued, and Wait reads the target back before the region is rewritten.
+//The readback only waits for the commands queued before the region's signal, so the frames applied since then stay in flight.
+class GRingFence {
+public:
+	static const uint32_t RingFrames = 3;
+
+	void Signal(LWVideoDriver *Driver, uint32_t Frame, LWAllocator &Allocator);
+
+	//Returns immediately if Frame's region hasn't been signaled since it was last waited on.
+	void Wait(LWVideoDriver *Driver, uint32_t Frame);
+
+	void Destroy(LWVideoDriver *Driver);
+private:
+	LWFrameBuffer *m_FrameBuffer = nullptr;
+	LWTexture *m_Targets[RingFrames] = {};
+	uint32_t m_Tags[RingFrames] = {}; //Tag each region was last signaled with, 0 once it's been waited on.
+	uint32_t m_NextTag = 0;
+};
+
+//Padded uniform block split into one region per frame in flight.  Each applied frame uploads into the next region without overwriting the others, so the gpu keeps reading the previous frames' regions and the driver never orphans the buffer.
+//A region is only rewritten once Renderer's GRingFence shows the last frame drawn from it has finished.
+//Members are defined in Renderer.cpp, the only place rings are used.
+template<class Type>
+class GUniformRing {
+public:
+	static const uint32_t RingFrames = GRingFence::RingFrames;
+
+	//Uploads Count elements into Frame's region, growing every region if it's too small.  Returns the element index of the region's first element, to add to the ids bound from it.
+	uint32_t Write(LWVideoDriver *Driver, uint32_t Frame, const char *Data, uint32_t Count, LWAllocator &Allocator);
+
+	bool Grow(LWVideoDriver *Driver, uint32_t Capacity, LWAllocator &Allocator);
+
+	void Destroy(LWVideoDriver *Driver);
+
+	LWVideoBuffer *GetBuffer(void) const;
+
+	uint32_t GetRegionCapacity(void) const;
+
+	GUniformRing(uint32_t InitialCount, uint32_t MaxCount);
+private:
+	LWVideoBuffer *m_Buffer = nullptr;
+	uint32_t m_RegionCapacity = 0;
+	uint32_t m_InitialCount;
+	uint32_t m_MaxCount;
+};
+
+//Tightly packed storage buffer split into regions the same way as GUniformRing, shaders index it's elements instead of binding each one as a block.
+template<class Type>
+class GStorageRing {
+public:
+	static const uint32_t RingFrames = GRingFence::RingFrames;
+
+	//Uploads Count elements into Frame's region, growing every region if it's too small.  Returns the element index of the region's first element.
+	uint32_t Write(LWVideoDriver *Driver, uint32_t Frame, const Type *Data, uint32_t Count, LWAllocator &Allocator);
+
+	bool Grow(LWVideoDriver *Driver, uint32_t Capacity, LWAllocator &Allocator);
+
+	void Destroy(LWVideoDriver *Driver);
+
+	LWVideoBuffer *GetBuffer(void) const;
+
+	uint32_t GetRegionCapacity(void) const;
+
+	GStorageRing(uint32_t InitialCount, uint32_t MaxCount);
+private:
+	LWVideoBuffer *m_Buffer = nullptr;
+	uint32_t m_RegionCapacity = 0;
+	uint32_t m_InitialCount;
+	uint32_t m_MaxCount;
+};
+
+//Where a geometry id's data lives, either a range of an arena, or a buffer of it's own.
+struct GGeometry {
+	LWVideoBuffer *m_Buffer = nullptr; //Only set for standalone buffers.
+	uint32_t m_Arena = -1;
+	uint32_t m_Offset = 0;
+	uint32_t m_Count = 0;
+	uint32_t m_VerticeID = 0; //Indices in an arena are rebased onto this geometry's vertices.
+
+	bool isLoaded(void) const;
+
+	GGeometry(LWVideoBuffer *Buffer);
+
+	GGeometry(uint32_t Arena, uint32_t Offset, uint32_t Count, uint32_t VerticeID);
+
+	GGeometry() = default;
+};
+
 struct PendingTexture {
 	LWImage *m_Image = nullptr;
 	uint32_t m_ID;
+	bool m_Material = false; //Only material textures are placed in texture arrays.
+};
+
+//Material textures of one size, format and mipmap count, packed as the layers of a single texture array, so draws whose materials share arrays don't rebind textures.
+//Images are only kept until they're uploaded to their layer, the array is created with room for more layers than it needs, and only grows once every layer is used.
+class GTextureArray {
+public:
+	static const uint32_t MaxLayers = 256;
+	static const uint32_t InitialLayers = 8; //Layers the array is first created with, doubled each time it grows.
+
+	//Takes ownership of Image until it's uploaded, returns the layer it was placed in, or -1 if the array is full.
+	uint32_t Insert(uint32_t ID, LWImage *Image);
+
+	//Frees the layer, it's reused by a later insert.
+	void Remove(uint32_t Layer);
+
+	//Creates or grows the texture if more layers are used than it has, then uploads the layers inserted since the last update and destroys their images, returns true if any layer changed.
+	bool Update(LWVideoDriver *Driver, LWAllocator &Allocator);
+
+	void Destroy(LWVideoDriver *Driver);
+
+	bool isFormat(const LWImage &Image) const;
+
+	bool isFull(void) const;
+
+	LWTexture *GetTexture(void) const;
+
+	//Texture id of each layer, 0 for free layers.
+	const std::vector<uint32_t> &GetLayerIDs(void) const;
+
+	GTextureArray(const LWImage &Image);
+
+	GTextureArray() = default;
+private:
+	std::vector<LWImage*> m_Pending; //Indexed by layer, images waiting to be uploaded.
+	std::vector<uint32_t> m_IDs;
+	std::vector<uint32_t> m_FreeLayers;
+	LWTexture *m_Texture = nullptr;
+	LWVector2i m_Size;
+	uint32_t m_PackType = 0;
+	uint32_t m_MipmapCount = 0;
+	uint32_t m_Capacity = 0; //Layers m_Texture was created with.
+	bool m_Dirty = false;
+};
+
+struct GTextureLayer {
+	uint32_t m_Array = -1;
+	uint32_t m_Layer = 0;
+
+	GTextureLayer(uint32_t Array, uint32_t Layer);
+
+	GTextureLayer() = default;
+};
+
+//State last applied to a scene pipeline by PreparePipeline, so draws that share state don't resend it to the driver.
+struct GPipelineState {
+	LWShader *m_VertexShader = nullptr;
+	LWTexture *m_Textures[MaxTextures] = {};
+	uint32_t m_TextureIDs[MaxTextures] = {};
+	uint32_t m_BoundTextures = 0; //Bit for each texture slot bound since the renderer's textures last changed.
+	bool m_Blending = false;
+	bool m_DepthOutput = false;
+	bool m_Applied = false; //Blend and depth state have been applied at least once.
+	uint32_t m_PassOffset = -1; //Ring offset of the pass data block, and the model, anim, and material storage buffers, bound since the pipeline's stages were last updated.
+	LWVideoBuffer *m_ModelList = nullptr;
+	LWVideoBuffer *m_AnimList = nullptr;
+	LWVideoBuffer *m_MaterialList = nullptr;
+};
+
+//Pipeline state work done while drawing a frame's scene passes.
+struct RenderStats {
+	uint32_t m_DrawCalls = 0;
+	uint32_t m_InstancedModels = 0; //Models drawn as part of an instanced draw.
+	uint32_t m_PipelineSwitches = 0;
+	uint32_t m_ResourceBinds = 0;
+	uint32_t m_RedundantSkipped = 0; //Shader, blend, depth, texture, and resource updates skipped because they were already applied.
+	uint64_t m_UploadBytes = 0; //Per frame data(lights, global, pass and instance blocks, and the anim, model, and material lists) uploaded when the frame was applied, 0 if it was drawn again.
+	uint32_t m_Materials = 0; //Distinct materials uploaded for the frame's models.
+	uint32_t m_ShadowPassesRendered = 0;
+	uint32_t m_ShadowPassesSkipped = 0; //Shadow maps reused because nothing they draw changed since they were last rendered.
+
+	RenderStats &operator += (const RenderStats &O);
+};
+
+//GPU memory held by the renderer's render targets, tracked as they're created and reported when the renderer is destroyed.
+struct GPUMemoryReport {
+	static const uint32_t ScreenTargets = 0;
+	static const uint32_t HighlightTargets = 1;
+	static const uint32_t BlurTargets = 2;
+	static const uint32_t LightArray = 3;
+	static const uint32_t ShadowArray = 4;
+	static const uint32_t ShadowCubeArray = 5;
+	static const uint32_t ReflectionTargets = 6;
+	static const uint32_t OutputArray = 7;
+	static const uint32_t PooledTargets = 8; //Released targets waiting in the GRenderTargetPool to be reused or trimmed.
+	static const uint32_t ResourceCount = 9;
+	static const char8_t *ResourceNames[ResourceCount];
+
+	uint64_t m_Bytes[ResourceCount] = {};
+	uint64_t m_PeakBytes[ResourceCount] = {};
+
+	//Every render target format the renderer creates(RGBA8, DEPTH32, DEPTH24STENCIL8) is 4 bytes per texel, mipmapped textures add a third for their mip chain.
+	static uint64_t TextureBytes(const LWVector2i &Size, uint32_t Layers = 1, uint32_t Samples = 1, bool Mipmapped = false);
+
+	GPUMemoryReport &Set(uint32_t Resource, uint64_t Bytes);
+
+	uint64_t GetTotal(void) const;
+};
+
+struct GPooledTarget {
+	LWTexture *m_Texture = nullptr;
+	LWVector2i m_Size;
+	uint32_t m_Flags = 0;
+	uint32_t m_PackType = 0;
+	uint32_t m_Samples = 0;
+	uint32_t m_ReleasedFrame = 0;
+	bool m_InUse = true;
+};
+
+//Size dependent render targets, released targets are kept and handed back to later requests with the same size, format, sample count and flags, so resizing back to a recent size or toggling a setting back doesn't reallocate.
+//A released target isn't handed out again until ReuseFrames frames later so frames still in flight never see it overwritten, free targets unused for TrimFrames frames, or beyond MaxFreeTargets, are destroyed oldest first.
+class GRenderTargetPool {
+public:
+	static const uint32_t ReuseFrames = 3; //Renderer::MaxFrames.
+	static const uint32_t TrimFrames = 300;
+	static const uint32_t MaxFreeTargets = 16; //Enough to keep one full set of window sized targets.
+
+	//Samples of 0 creates a regular 2D texture, anything else a multisampled one.
+	LWTexture *Acquire(LWVideoDriver *Driver, uint32_t Flags, uint32_t PackType, const LWVector2i &Size, uint32_t Samples, LWAllocator &Allocator);
+
+	//Returns Tex to the pool, textures that weren't acquired from it are ignored.
+	void Release(LWTexture *Tex);
+
+	//Advances the pool's frame, destroying free targets that are past TrimFrames or MaxFreeTargets.
+	void NextFrame(LWVideoDriver *Driver);
+
+	void Destroy(LWVideoDriver *Driver);
+
+	uint64_t GetFreeBytes(void) const;
+
+	uint32_t GetReusedCount(void) const;
+
+	uint32_t GetCreatedCount(void) const;
+private:
+	std::vector<GPooledTarget> m_Targets;
+	uint32_t m_Frame = 0;
+	uint32_t m_Reused = 0;
+	uint32_t m_Created = 0;
 };
 
 struct GLight {
@@ -110,6 +422,8 @@ struct GGlobalData {
 	LWVector2i TileSize;
 	int32_t LightCount;
 	int32_t RenderOutput = 0;
+	uint32_t AnimBase = 0; //First element of the anim ring region the frame was applied to, skinned models add it to their AnimID.
+	uint32_t MaterialBase = 0; //First element of the material ring region, models add it to their MaterialIndex.
 };
 
 struct GGaussianKernel {
@@ -159,22 +473,37 @@ struct GMaterial {
 	LWVector4f EmissiveFactor = LWVector4f(0.0f);
 	LWVector4f SubTextures[MaxTextures];
 	uint32_t HasTexturesFlag = 0;
-	uint32_t Pad[3];
+	uint32_t TextureLayers[3] = {}; //Texture array layer of each texture, two 16 bit layers per element with the even texture in the low bits.  Written by the renderer when texture arrays are enabled.
 
 	GMaterial() = default;
 
 };
 
 
+//Element of the ModelList storage buffer, the layout has to match the shaders' GModelData.
 struct GModelData {
 	LWSMatrix4f TransformMatrix;
-	GMaterial Material;
+	uint32_t MaterialIndex = 0; //Element of the frame's MaterialList, models with the same material and textures share it.
+	uint32_t AnimID = 0;
+	uint32_t Pad[2];
 };
 
+//MaxBones elements of the AnimList storage buffer.
 struct GAnimData {
 	LWSMatrix4f BoneMatrixs[MaxBones];
 };
 
+//The driver has no draw id, so each draw binds the block of a static table whose ModelIndex is the ModelList element it reads.
+struct GDrawData {
+	uint32_t ModelIndex;
+	uint32_t Pad[3];
+};
+
+//Per instance transforms of an instanced draw, the material is shared and read from the first instance's GModelData.
+struct GInstanceData {
+	LWSMatrix4f InstanceTransforms[MaxInstances];
+};
+
 struct GModelTexture {
 	uint32_t m_TextureID = 0;
 	uint32_t m_TextureState = 0;
@@ -224,6 +553,92 @@ struct GElement {
 	GElement() = default;
 };
 
+//A draw submitted to a pass, passes are drawn in m_SortKey order.
+//Opaque keys group draws by state so pipelines and textures are bound as few times as possible, and sort front to back within the same state:
+//	[63: Transparent=0][62-61: Draw order][60-24: State][23-0: Depth]
+//Transparent keys must blend back to front, so depth is sorted before state:
+//	[63: Transparent=1][62-61: Draw order][60-37: Inverted depth][36-0: State]
+//State is [36-29: Pipeline][28-16: Vertex buffer][15-0: Texture set], the vertex buffer decides the vertex shader.
+struct GPassElement {
+	static const uint64_t TransparentBit = 0x8000000000000000ull;
+	static const uint32_t OrderBitsOffset = 61;
+	static const uint32_t DepthBits = 24;
+	static const uint32_t StateBits = 37;
+
+	uint64_t m_SortKey;
+	uint32_t m_Index;
+
+	//Packs the model's pipeline, vertex buffer, and textures into the StateBits of a key.
+	static uint64_t MakeStateKey(const GFrameModel &Mdl);
+
+	static uint64_t MakeSortKey(uint64_t StateKey, uint32_t Flags, float DistanceSq, bool Transparent);
+
+	bool isTransparent(void) const;
+
+	GPassElement(uint32_t Index, uint64_t SortKey);
+
+	GPassElement() = default;
+};
+
+//A run of a finalized pass's elements that are drawn together, runs of models sharing geometry, pipeline, textures, and material are drawn with one instanced draw.
+struct GPassBatch {
+	uint32_t m_First;
+	uint32_t m_Count;
+	uint32_t m_InstanceID; //GInstanceData block of the batch, or -1 if it's elements are drawn one at a time.
+
+	GPassBatch(uint32_t First, uint32_t Count, uint32_t InstanceID);
+
+	GPassBatch() = default;
+};
+
+//Per frame list storage that starts empty and doubles when full, capacity is kept between frames so a frame only allocates when it draws more than any frame before it.
+template<class Type>
+class GFrameArray {
+public:
+	static const uint32_t InitialCapacity = 64;
+
+	//Doubles the capacity up to MaxCount, returns false if the array already holds MaxCount elements.
+	bool Grow(uint32_t MaxCount, LWAllocator &Allocator) {
+		if (m_Capacity >= MaxCount) return false;
+		uint32_t Capacity = std::min<uint32_t>(std::max<uint32_t>(m_Capacity * 2, InitialCapacity), MaxCount);
+		Type *Data = Allocator.Allocate<Type>(Capacity);
+		std::copy(m_Data, m_Data + m_Capacity, Data);
+		if (m_Data) LWAllocator::Destroy(m_Data);
+		m_Data = Data;
+		m_Capacity = Capacity;
+		return true;
+	}
+
+	Type &operator[](uint32_t i) {
+		return m_Data[i];
+	}
+
+	const Type &operator[](uint32_t i) const {
+		return m_Data[i];
+	}
+
+	Type *begin(void) {
+		return m_Data;
+	}
+
+	uint32_t GetCapacity(void) const {
+		return m_Capacity;
+	}
+
+	uint32_t GetStorageSize(void) const {
+		return m_Capacity * sizeof(Type);
+	}
+
+	GFrameArray() = default;
+
+	~GFrameArray() {
+		if (m_Data) LWAllocator::Destroy(m_Data);
+	}
+private:
+	Type *m_Data = nullptr;
+	uint32_t m_Capacity = 0;
+};
+
 struct GFramePass {
 	enum {
 		Shadowed = 0x1,
@@ -236,10 +651,12 @@ struct GFramePass {
 	LWSVector4f m_Forward;
 	LWSVector4f m_Right;
 	LWSVector4f m_Up;
-	std::array<GElement, MaxPassElements> m_OpaqueElements;
-	std::array<GElement, MaxPassElements> m_TransparentElements;
-	std::atomic<uint32_t> m_TransparentCount;
-	std::atomic<uint32_t> m_OpaqueCount;
+	GFrameArray<GPassElement> m_Elements; //Opaque draws followed by transparent draws once the pass is finalized.
+	GFrameArray<GPassElement> m_SortScratch;
+	GFrameArray<GPassBatch> m_Batches;
+	LWAllocator *m_Allocator = nullptr;
+	uint32_t m_ElementCount = 0;
+	uint32_t m_BatchCount = 0;
 	uint32_t m_Flag;
 	uint32_t m_SourceIndex = 0;
 	uint32_t m_TargetIndex = 0;
@@ -254,7 +671,7 @@ struct GFramePass {
 
 	bool isInitialized(uint32_t FrameID) const;
 
-	bool PushElement(uint32_t ID, uint32_t Flag, const LWSVector4f &Position, bool Transparent);
+	bool PushElement(uint32_t ID, uint32_t Flag, uint64_t StateKey, const LWSVector4f &Position, bool Transparent);
 
 	bool SphereInFrustum(const LWSVector4f &Position, float Radius);
 
@@ -264,12 +681,20 @@ struct GFramePass {
 
 	bool LightInFrustrum(const Light &L);
 
+	//Radix sorts the pass's elements by their sort key.
 	void FinalizePass(uint32_t FrameID);
 
 	void Initialize(Camera &Cam, GGlobalData &GlobalBlock, GPassData *PassData, uint32_t TargetID, uint32_t TargetFace, uint32_t SourceIndex, uint32_t FrameID, uint32_t PassID);
 
 };
 
+//Slot of a frame's material hash table, slots written by an earlier frame are empty.
+struct GMaterialSlot {
+	uint64_t m_Hash = 0;
+	uint32_t m_FrameID = -1;
+	uint32_t m_Index = 0;
+};
+
 struct GFrame {
 	static const uint32_t MainViewPass = 0;
 	static const uint32_t OutlinePass = 1;
@@ -285,19 +710,28 @@ struct GFrame {
 
 	static const uint32_t MaxUIElements = 1024;
 	static const uint32_t MaxParticleVertices = 8048 * 4;
+	static const uint32_t InitialAnimations = 16;
+	static const uint32_t InitialInstanceBlocks = 4;
+	static const uint32_t ParallelSortElements = 8192; //Frames with at least this many pass elements sort their passes on multiple threads.
 	LWEUIFrame m_UIFrame;
 	GFramePass m_PassList[MaxRawPasses];
-	GFrameModel m_ModelList[MaxModels];
+	GFrameArray<GFrameModel> m_ModelList; //m_ModelDataBuffer, m_MaterialBuffer, and m_MaterialModels are grown alongside to the same capacity.
 	GGlobalData m_GlobalData;
 	LWSVector4f m_ShadowPosition;
 	LWVector4f m_ViewBounds;
 	LWVector4i m_TargetViewBounds;
 	LWVector2i m_TargetTextureSize;
+	uint32_t m_TargetLayers = 0; //Bits of the RenderOutput layers being exported, the output array only holds these layers.
 	std::array<GElement, MaxShadowRTs+1> m_ShadowLightList;
 	LWVideoDriver *m_Driver = nullptr;
+	LWAllocator *m_Allocator = nullptr;
 	char *m_PassDataBuffer = nullptr;
-	char *m_AnimDataBuffer = nullptr;
-	char *m_ModelDataBuffer = nullptr;
+	GAnimData *m_AnimDataBuffer = nullptr;
+	GModelData *m_ModelDataBuffer = nullptr;
+	GMaterial *m_MaterialBuffer = nullptr;
+	uint32_t *m_MaterialModels = nullptr; //First model to use each material, it's textures are the material's textures.
+	GMaterialSlot *m_MaterialTable = nullptr; //Open addressed with twice the model capacity, so it never fills.
+	char *m_InstanceDataBuffer = nullptr;
 	GLight *m_LightsBuffer = nullptr;
 	ParticleVert *m_ParticleVertices = nullptr;
 
@@ -305,11 +739,21 @@ struct GFrame {
 
 	uint32_t m_ShadowArrayCount = 0;
 	uint32_t m_ShadowCubeCount = 0;
+	uint32_t m_ShadowMapSize = 0; //Size of the shadow array's layers, cascades are snapped to it's texels.
 	uint32_t m_ReflectionBits = 0;
 
 	uint32_t m_FrameID = -1;
 	uint32_t m_AnimCount = 0;
+	uint32_t m_AnimCapacity = 0;
 	uint32_t m_ModelCount = 0;
+	uint32_t m_MaterialCount = 0;
+	uint32_t m_InstanceCount = 0;
+	uint32_t m_InstanceCapacity = 0;
+	uint32_t m_PassRingBase = 0; //First element of the uniform ring regions this frame was applied to.
+	uint32_t m_AnimRingBase = 0;
+	uint32_t m_ModelRingBase = 0;
+	uint32_t m_MaterialRingBase = 0;
+	uint32_t m_InstanceRingBase = 0;
 	uint32_t m_ShadowCount = 0;
 	uint32_t m_ParticleCount = 0;
 	uint32_t m_LightCount = 0;
@@ -317,7 +761,14 @@ struct GFrame {
 
 	GFrame &InitializeFrame(uint32_t FrameID);
 
-	GFrame &FinalizeFrame(void);
+	//Pass sorts run on Pool once the frame has ParallelSortElements elements.
+	GFrame &FinalizeFrame(WorkerPool &Pool);
+
+	//Splits each sorted pass into batches, and writes the instance transforms of batches that can be instanced.
+	void BuildPassBatches(void);
+
+	//Returns true if the models can be drawn by the same instanced draw.
+	bool CanInstance(uint32_t ModelA, uint32_t ModelB);
 
 	GPassData *GetPassDataAt(uint32_t i);
 
@@ -325,6 +776,10 @@ struct GFrame {
 
 	GAnimData *GetAnimDataAt(uint32_t i);
 
+	GMaterial *GetMaterialAt(uint32_t i);
+
+	GInstanceData *GetInstanceDataAt(uint32_t i);
+
 	GFrame &InitializeShadowPosition(const LWSVector4f &ShadowPos);
 
 	GFrame &InitializeSunDirection(const LWSVector4f &SunDirection);
@@ -338,6 +793,9 @@ struct GFrame {
 	//Copys the output of ViewBounds to the TargetBounds of the texture.
 	GFrame &InitializeDirectionPass(const LWVector4f &ViewBounds, const LWVector4i &TargetBounds);
 
+	//Grows the animation buffer if it's full, returns false once MaxAnimations are in use.
+	bool ReserveAnimation(void);
+
 	uint32_t NextAnimation(void);
 
 	uint32_t PushAnimation(LWSMatrix4f *BoneMatrixs, uint32_t BoneCount);
@@ -348,10 +806,19 @@ struct GFrame {
 
 	uint32_t PushModel(GFrameModel &Mdl, uint32_t PassBits, uint32_t AnimID, const LWSMatrix4f &Transform, const GMaterial &Material, bool Transparent);
 
+	//Returns the index of Material in the frame's material list, it's only added if no earlier model of the frame has the same material and textures.
+	uint32_t PushMaterial(const GMaterial &Material, uint32_t ModelID);
+
+	//Reallocates the material table for the model list's capacity, and reinserts the frame's materials.
+	void GrowMaterialTable(void);
+
 	uint32_t WriteParticles(uint32_t Count);
 
 	uint32_t PushLight(const Light &L);
 
+	//Returns the bytes of memory held by the frame's draw lists and data buffers.
+	uint32_t GetStorageSize(void) const;
+
 	GFrame() = default;
 
 	GFrame(LWVideoDriver *Driver, LWAllocator &Allocator);
@@ -364,11 +831,14 @@ public:
 	static const uint32_t MaxFrames = 3;
 	static const uint32_t ScreenGaussianKernel = 0;
 	static const uint32_t GaussianKernelCount = 2;
+	static const uint32_t ResizeSettleFrames = 10; //Frames the window has to keep the same size before window sized targets are rebuilt for it.
 
-	static const uint32_t MetallicRoughnessTexOffset = 7;
-	static const uint32_t SpecularGlossinessTexOffset = 7;
-	static const uint32_t UnlitTexOffset = 3;
-	static const uint32_t SkyboxTexOffset = 0;
+	static const uint32_t MetallicRoughnessTexOffset = 10; //Every scene shader's resource map starts with the ModelList, AnimList, and MaterialList.
+	static const uint32_t SpecularGlossinessTexOffset = 10;
+	static const uint32_t UnlitTexOffset = 6;
+	static const uint32_t SkyboxTexOffset = 3;
+	static const uint32_t ShadowPipelineState = Material::Cloud + 1; //Scene pipelines are tracked by their material pipeline id, followed by the shadow pipeline.
+	static const uint32_t PipelineStateCount = ShadowPipelineState + 1;
 
 	Renderer &SizeUpdated(LWWindow *Window);
 
@@ -380,7 +850,12 @@ public:
 
 	Renderer &EndFrame(void);
 
-	LWPipeline *PreparePipeline(GFrame &F, const GFrameModel &Mdl, bool isSkinned, bool Transparent, bool IsShadowed);
+	LWPipeline *PreparePipeline(GFrame &F, const GFrameModel &Mdl, bool isSkinned, bool Transparent, bool IsShadowed, bool isInstanced = false);
+
+	GPipelineState &GetPipelineState(const GFrameModel &Mdl, bool IsShadowed);
+
+	//Binds the data a draw of Mdl reads, the pass block and storage buffers are only rebound when they change, the AnimList is only bound for skinned draws, and the draw index block is bound every draw.
+	Renderer &BindDrawData(GFrame &F, LWPipeline *P, GPipelineState &S, const GFrameModel &Mdl, uint32_t PassID, bool isSkinned);
 
 	Renderer &ApplyFrame(GFrame &F);
 
@@ -388,18 +863,46 @@ public:
 
 	Renderer &RenderModel(GFrame &F, const GFrameModel &Mdl, uint32_t PassID, bool Transparent, bool IsShadowed);
 
+	//Draws InstanceCount instances of Mdl with the transforms in InstanceID, returns false if the geometry can't be instanced(skinned or not loaded) and has to be drawn one model at a time.
+	bool RenderInstances(GFrame &F, const GFrameModel &Mdl, uint32_t PassID, bool Transparent, bool IsShadowed, uint32_t InstanceID, uint32_t InstanceCount);
+
 	Renderer &RenderPass(GFrame &F, uint32_t PassID);
 
 	Renderer &RenderBlurPass(GFrame &F, uint32_t KernelOffset, LWFrameBuffer *FB, LWTexture *SourceTex, LWTexture *TempTexture, LWTexture *ResultTex, uint32_t ResultLayer = 0, uint32_t ResultFace = 0);
 
+	//Skips the pass if it's hash matches the hash the target shadow map was last rendered with.
 	Renderer &RenderShadowPass(GFrame &F, uint32_t PassID);
 
+	//Hashes everything that decides the depth written by a shadow pass: the light's projection, and each draw's geometry, transform, and bone matrixs.
+	uint64_t HashShadowPass(GFrame &F, uint32_t PassID);
+
+	//Creates the output array the first time it's written, and recreates it when the export's size or layers change.
 	Renderer &CopyOutput(GFrame &F);
 
+	//Point light shadows and reflections are rarely used, so their targets are only created by the first pass that needs them.
+	bool ReserveShadowCubeTargets(void);
+
+	bool ReserveReflectionTargets(void);
+
+	void ReleaseShadowCubeTargets(void);
+
+	void ReleaseReflectionTargets(void);
+
 	Renderer &Render(LWWindow *Window);
 
+	//Offscreen renderers stop after the export output is written, nothing is drawn to the window's back buffer or presented.  The gpu is only waited on when a uniform ring region is about to be reused, or an output layer is read back.
+	Renderer &SetOffscreen(bool Offscreen);
+
+	//Software renderers draw scene frames with SoftRenderer on the cpu instead of the gpu, only export frames are drawn and nothing is presented.
+	Renderer &SetSoftware(bool Software);
+
+	bool isSoftware(void) const;
+
 	GMaterial PrepareGMaterial(GFrameModel &Mdl, const LWVector2f &AtlasSubPosition, const LWVector2f &AtlasSubSize, float TransparencyMult, Material &Mat);
 
+	//Evaluates Mat's tweens at it's current time, without atlas placement or a transparency multiplier applied.
+	GMaterial EvaluateGMaterial(const Material &Mat);
+
 	Renderer &WriteDebugLine(GFrame &F, uint32_t PassBits, const LWSVector4f &APnt, const LWSVector4f &BPnt, float Thickness, const LWVector4f &Color, uint32_t Flags = 0);
 
 	Renderer &WriteLine(GFrame &F, uint32_t PassBits, const LWSVector4f &APnt, const LWSVector4f &BPnt, float Thickness, Material &Mat, uint32_t Flags = 0);
@@ -434,14 +937,22 @@ public:
 
 	uint32_t WriteGeometry(GFrame &F, uint32_t VerticeID, uint32_t IndiceID, uint32_t AnimID, uint32_t PassBits, const LWSMatrix4f &Transform, Material &Mat, uint32_t Flags = 0, uint32_t Offset = 0, uint32_t Count = 0);
 
-	uint32_t PushPendingGeometry(uint32_t ID, uint32_t DataType, char *Data, uint32_t DataCnt, uint32_t DataSize, LWAllocator &Allocator, bool Copy);
+	//Vertices are placed in the arena for their format, indices passing the VerticeID they index are rebased into the shared 32 bit index arena, anything else gets a buffer of it's own.
+	uint32_t PushPendingGeometry(uint32_t ID, uint32_t DataType, char *Data, uint32_t DataCnt, uint32_t DataSize, LWAllocator &Allocator, bool Copy, uint32_t VerticeID = 0);
 
 	template<class Type>
-	uint32_t PushPendingGeometry(uint32_t ID, uint32_t DataType, Type *Data, uint32_t DataCnt, LWAllocator &Allocator, bool Copy = false) {
-		return PushPendingGeometry(ID, DataType, (char*)Data, DataCnt, sizeof(Type), Allocator, Copy);
+	uint32_t PushPendingGeometry(uint32_t ID, uint32_t DataType, Type *Data, uint32_t DataCnt, LWAllocator &Allocator, bool Copy = false, uint32_t VerticeID = 0) {
+		return PushPendingGeometry(ID, DataType, (char*)Data, DataCnt, sizeof(Type), Allocator, Copy, VerticeID);
 	}
 
-	uint32_t PushPendingTexture(uint32_t ID, LWImage *Image);
+	//Queues ID to be released, returning it's range to the arena, and it's slot for reuse.
+	bool ReleaseGeometry(uint32_t ID);
+
+	//Material textures are placed in texture arrays when they're enabled, other textures(i.e. image based lighting) always get a texture of their own.
+	uint32_t PushPendingTexture(uint32_t ID, LWImage *Image, bool isMaterial = false);
+
+	//Queues ID to be released, returning it's slot for reuse.
+	bool ReleaseTexture(uint32_t ID);
 
 	void ProcessPendingGeometry(void);
 
@@ -453,10 +964,22 @@ public:
 
 	void SetIBLSpecularTexture(LWTexture *Tex);
 
+	//Returns the whole texture array for textures placed in one.
 	LWTexture *GetTexture(uint32_t ID);
 
 	LWTexture *GetOutputTexture(void);
 
+	LWVector2i GetOutputSize(void);
+
+	//Copies the rgba8 texels of an export layer into Texels, which must hold GetOutputSize texels.
+	bool ReadOutputLayer(uint32_t Layer, uint8_t *Texels);
+
+	//Returns the index of a RenderOutput layer in the output array, or -1 if the array wasn't created with it.
+	uint32_t GetOutputLayerIndex(uint32_t Layer) const;
+
+	const GPUMemoryReport &GetGPUMemory(void) const;
+
+	//Returns the buffer ID is drawn from, which is shared with other geometry for arena allocations.
 	LWVideoBuffer *GetGeometry(uint32_t ID);
 
 	bool GeometryIsLoaded(uint32_t ID) const;
@@ -507,11 +1030,54 @@ public:
 
 	RenderSettings GetSettings(void) const;
 
+	//Returns the stats of the last frame drawn by the render thread.
+	RenderStats GetFrameStats(void) const;
+
 	Renderer(LWVideoDriver *Driver, LWAllocator &Allocator);
 
 	~Renderer();
 private:
+	Renderer &RenderSoftware(void);
+
+	//Finds the vertex and index buffers of Mdl, the number of vertices to draw, and the arena offset of it's first vertice or indice.  Returns false if the geometry isn't loaded.
+	bool FindGeometry(const GFrameModel &Mdl, LWVideoBuffer *&VBuffer, LWVideoBuffer *&IBuffer, uint32_t &Count, uint32_t &Offset);
+
+	//Places PGeom in an arena, returns -1 if it needs a buffer of it's own instead.
+	uint32_t AllocateGeometry(const PendingGeometry &PGeom, uint32_t &Offset);
+
+	//Packs every arena that's mostly free space, and fixes up the indices that referenced moved vertices.
+	void CompactGeometry(void);
+
+	uint32_t FindGeometryArena(uint32_t BufferType, uint32_t TypeSize);
+
+	//Places a material texture in a texture array when they're enabled, taking ownership of it's image.  Returns false if it needs a texture of it's own.
+	bool PlaceTextureLayer(PendingTexture &PTex);
+
+	//Frees ID's layer, returns false if ID isn't in a texture array.
+	bool ReleaseTextureLayer(uint32_t ID);
+
+	//Returns an array with room for Image, or -1 if every array is in use.
+	uint32_t FindTextureArray(const LWImage &Image);
+
+	//Recreates arrays that gained layers, and points their textures at the new array.
+	void UpdateTextureArrays(void);
+
+	//Writes the array layer of each model's textures into it's material.
+	void WriteTextureLayers(GFrame &F);
+
+	//Switches the material pipelines to the pixel shaders that match m_Settings.m_TextureArrays.
+	void ApplyTextureMode(void);
+
+	//Recreates the draw index table once the model ring has grown past it, returns false if it couldn't be created.
+	bool UpdateDrawIndexTable(void);
+
 	GFrame m_Frames[MaxFrames];
+	GPipelineState m_PipelineStates[PipelineStateCount];
+	LWPipeline *m_LastPipeline = nullptr;
+	RenderStats m_Stats;
+	RenderStats m_FrameStats;
+	RenderStats m_TotalStats;
+	uint32_t m_StatsFrameCount = 0;
 	PendingTexture m_PendingTextures[MaxPendingTexture];
 	PendingGeometry m_PendingGeometry[MaxPendingGeometry];
 	RenderSettings m_Settings;
@@ -524,14 +1090,36 @@ private:
 
 	LWShader *m_StaticVertexShader = nullptr;
 	LWShader *m_SkeletonVertexShader = nullptr;
+	LWShader *m_InstancedVertexShader = nullptr;
+
+	LWShader *m_PBRMetallicShader = nullptr;
+	LWShader *m_PBRSpecularGlossinessShader = nullptr;
+	LWShader *m_PBRUnlitShader = nullptr;
+	LWShader *m_SkyboxShader = nullptr;
+	LWShader *m_PBRMetallicArrayShader = nullptr;
+	LWShader *m_PBRSpecularGlossinessArrayShader = nullptr;
+	LWShader *m_PBRUnlitArrayShader = nullptr;
+	LWShader *m_SkyboxArrayShader = nullptr;
 
 	LWVideoBuffer *m_UIUniform = nullptr;
 	LWVideoBuffer *m_LightDataBuffer = nullptr;
 	LWVideoBuffer *m_LightArrayBuffer = nullptr;
+	uint32_t m_LightArrayLength = 0;
 	LWVideoBuffer *m_GlobalDataBlock = nullptr;
-	LWVideoBuffer *m_PassDataBlock = nullptr;
-	LWVideoBuffer *m_AnimDataBlock = nullptr;
-	LWVideoBuffer *m_ModelDataBlock = nullptr;
+	GUniformRing<GPassData> m_PassDataRing = GUniformRing<GPassData>(MaxRawPasses, MaxRawPasses);
+	GStorageRing<GAnimData> m_AnimDataRing = GStorageRing<GAnimData>(GFrame::InitialAnimations, MaxAnimations);
+	GStorageRing<GModelData> m_ModelDataRing = GStorageRing<GModelData>(GFrameArray<GFrameModel>::InitialCapacity, MaxModels);
+	GStorageRing<GMaterial> m_MaterialDataRing = GStorageRing<GMaterial>(GFrameArray<GFrameModel>::InitialCapacity, MaxModels);
+	LWVideoBuffer *m_DrawIndexBuffer = nullptr; //GDrawData blocks for every element of the model ring.
+	uint32_t m_DrawIndexCount = 0;
+	GUniformRing<GInstanceData> m_InstanceDataRing = GUniformRing<GInstanceData>(GFrame::InitialInstanceBlocks, MaxInstanceBlocks);
+	GRingFence m_RingFence;
+	uint32_t m_AppliedFrames = 0;
+	uint64_t m_AppliedUploadBytes = 0;
+	uint32_t m_AppliedMaterials = 0;
+	uint64_t m_ShadowArrayHashes[GFrame::MaxShadowRTs] = {}; //Hash of the pass each shadow map was last rendered with, 0 if it has to be redrawn.
+	uint64_t m_ShadowCubeHashes[GFrame::MaxShadowRTs * 6] = {};
+	uint32_t m_GeometryRevision = 0; //Incremented whenever geometry is uploaded, replaced, or moved, as the same id can then draw different vertices.
 
 	LWVideoBuffer *m_ParticleVertBuffer = nullptr;
 
@@ -545,17 +1133,21 @@ private:
 	LWPipeline *m_LightCullPipeline = nullptr;
 	LWPipeline *m_PostProcessMS = nullptr;
 
+	GRenderTargetPool m_RenderTargets; //Owns every window sized target below.
+	uint32_t m_TargetSamples = 0;
+	LWVector2i m_SettlingSize; //Window size waiting to be held for ResizeSettleFrames.
+	uint32_t m_SettlingFrames = 0;
 	LWFrameBuffer *m_ScreenFB = nullptr;
 	LWTexture *m_ScreenTexMS = nullptr;
 	LWTexture *m_ScreenTex = nullptr;
-	LWTexture *m_FinalScreenTex = nullptr;
+	LWTexture *m_FinalScreenTex = nullptr; //Aliases m_EmissionTex.
 	LWTexture *m_EmissionTexMS = nullptr;
 	LWTexture *m_EmissionTex = nullptr;
 	LWTexture *m_ScreenDepth = nullptr;
 
 	LWFrameBuffer *m_HighlightFB = nullptr;
 	LWTexture *m_HighlightTex = nullptr;
-	LWTexture *m_HighlightTexMS = nullptr;
+	LWTexture *m_HighlightTexMS = nullptr; //Aliases m_EmissionTexMS.
 
 	LWFrameBuffer *m_BlurFB = nullptr;
 	LWTexture *m_BlurTempTexture = nullptr;
@@ -569,22 +1161,38 @@ private:
 	LWTexture *m_ReflectionDepthmap = nullptr;
 	LWTexture *m_ReflectionCubemap[2] = { nullptr, nullptr };
 
+	LWVector2i m_ReflectionSize;
+
 	LWFrameBuffer *m_OutputFramebuffer = nullptr;
 	LWTexture *m_OutputTexture = nullptr;
+	uint32_t m_OutputLayers = 0;
 
 	LWFrameBuffer *m_ShadowFrameBuffer = nullptr;
 	LWFrameBuffer *m_ShadowCubeFrameBuffer = nullptr;
 	LWTexture *m_ShadowTextureArray = nullptr;
 	LWTexture *m_ShadowCubemapArray = nullptr;
+	LWTexture *m_EmptyShadowCubemap = nullptr; //1x1 cube array bound in place of m_ShadowCubemapArray until a point light casts shadows.
+	LWVector2i m_ShadowCubeSize;
+
+	GPUMemoryReport m_GPUMemory;
 
 	LWVideoBuffer *m_PostProcessGeometry = nullptr;
 	LWVideoBuffer *m_CopyGeometry = nullptr;
 	LWVideoBuffer *m_GaussianKernel = nullptr;
 
-	std::unordered_map<uint32_t, LWVideoBuffer*> m_GeometryMap;
-	std::unordered_map<uint32_t, LWTexture*> m_TextureMap;
-	uint32_t m_NextTextureID = 0;
-	uint32_t m_NextGeometryID = 0;
+	SoftRenderer *m_SoftRenderer = nullptr;
+
+	WorkerPool m_SortPool{ std::min<uint32_t>(std::thread::hardware_concurrency(), MaxRawPasses) }; //Kept alive so large frames don't create threads every frame.
+
+	GeometryArena m_GeometryArenas[MaxGeometryArenas];
+	GSlotTable<GGeometry> m_GeometrySlots;
+	GSlotTable<LWTexture*> m_TextureSlots;
+	GTextureArray m_TextureArrays[MaxTextureArrays];
+	GSlotTable<GTextureLayer> m_TextureLayers;
+	uint32_t m_TextureArrayCount = 0;
+	GSlotAllocator m_GeometryIDs;
+	GSlotAllocator m_TextureIDs;
+	uint32_t m_GeometryArenaCount = 0;
 
 	uint32_t m_PendingGeomReadFrame = 0;
 	uint32_t m_PendingGeomWriteFrame = 0;
@@ -606,7 +1214,10 @@ private:
 	uint32_t m_PlaneVertID = 0;
 	uint32_t m_SkyBoxVertID = 0;
 	uint32_t m_SkyBoxIdxID = 0;
+	uint32_t m_FrameStorageSize = 0; //Largest frame storage reported so far.
 	bool m_SizeChanged = true;
+	bool m_Offscreen = false;
+	bool m_MaterialTexturesLoaded = false;
 
 };
 
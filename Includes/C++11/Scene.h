@@ -9,12 +9,15 @@ class Renderer;
 
 class Animation;
 
+class SpriteHasher;
+
 struct Node {
 	LWSMatrix4f m_Transform;
 	std::vector<uint32_t> m_MaterialList;
 	std::vector<uint32_t> m_ChildrenList;
 	Mesh *m_Mesh = nullptr;
 	Animation *m_Animation = nullptr;
+	uint64_t m_MeshHash = 0; //Content hash of the mesh's vertices and indices.
 
 	Node(Node &&O) noexcept;
 
@@ -32,7 +35,8 @@ public:
 
 	static bool LoadGLTFFile(Scene &S, const LWUTF8Iterator &Path, Renderer *R, LWAllocator &Allocator);
 
-	bool PushImageTexID(uint32_t ID);
+	//ContentHash is a hash of the image's texels, so sprites can tell when a texture they use has changed.
+	bool PushImageTexID(uint32_t ID, uint64_t ContentHash);
 
 	bool PushMaterial(const Material &Mat);
 
@@ -40,17 +44,23 @@ public:
 
 	void DrawScene(GFrame &F, Renderer *R, float Time, uint32_t PassBits, const LWSMatrix4f &Transform);
 
+	//Hashes everything DrawScene would submit for Time and Transform, the geometry, the posed node and bone transforms, and each material as it appears at Time along with it's textures.
+	void HashScene(SpriteHasher &H, Renderer *R, float Time, const LWSMatrix4f &Transform);
+
 	//Calculates both the 2D tight screen bounding, and the 3D bounding box for the objects in the scene.
 	//Returns the 2d tight screen bounding, writes into BoundsMin, and BoundsMax the 3d bounding box.
 	LWVector4i CaclulateBounding(float Time, const LWSMatrix4f &Transform, const LWVector2f &WndSize, Camera &Cam, int32_t BorderSize, LWSVector4f &BoundsMin, LWSVector4f &BoundsMax);
 
 	void Finalize(void);
 
-	//Releases all internal resources(textures
+	//Releases the scene's geometry and textures from R, called by the destructor for the renderer the scene was loaded with.
 	void Release(Renderer *R);
 
 	uint32_t GetImageTexID(uint32_t Idx);
 
+	//Returns the content hash of the image uploaded as TexID, or 0 if TexID isn't one of the scene's images.
+	uint64_t GetImageHash(uint32_t TexID) const;
+
 	Material &GetMaterial(uint32_t Idx);
 
 	float GetTotalTime(void) const;
@@ -60,9 +70,11 @@ public:
 	~Scene();
 private:
 	std::vector<uint32_t> m_ImageTexID;
+	std::vector<uint64_t> m_ImageHash;
 	std::vector<uint32_t> m_RootNodes;
 	std::vector<Node> m_NodeList;
 	std::vector<Material> m_MaterialList;
+	Renderer *m_Renderer = nullptr;
 	float m_TotalTime = 0.0f;
 };
 
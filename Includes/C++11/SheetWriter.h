@@ -0,0 +1,163 @@
+#ifndef SHEETWRITER_H
+#define SHEETWRITER_H
+#include <LWCore/LWTypes.h>
+#include <LWCore/LWVector.h>
+#include <LWCore/LWUnicode.h>
+#include <LWPlatform/LWFileStream.h>
+#include <zlib.h>
+#include "BlockCompress.h"
+
+//Per layer encoding settings, only used by writers that output block compressed textures.
+struct SheetEncoding {
+	uint32_t m_BlockFormat = BlockCompress::BC7;
+	uint32_t m_ChannelA = 0; //Source channels stored by BC4/BC5.
+	uint32_t m_ChannelB = 1;
+	uint32_t m_Quality = BlockCompress::QualityNormal;
+	bool m_sRGB = false;
+
+	SheetEncoding(uint32_t BlockFormat, uint32_t ChannelA, uint32_t ChannelB, bool sRGB);
+
+	SheetEncoding() = default;
+};
+
+//Streaming consumer for exported sprite sheet layers, rows are handed over top to bottom in bands as they are read back so a full sized image never has to be built before encoding.
+class SheetWriter {
+public:
+	static const uint32_t FormatPNG = 0;
+	static const uint32_t FormatDDS = 1;
+	static const uint32_t FormatKTX2 = 2;
+	static const uint32_t FormatQOI = 3; //Fast lossless intermediate for iteration, converted to a final format with Convert.
+	static const uint32_t FormatCount = 4;
+	static const uint32_t BandRows = 64; //Number of rows passed to WriteRows at a time.
+
+	//Creates a writer for the requested format, or null if the format is unknown.
+	static SheetWriter *Make(uint32_t Format, LWAllocator &Allocator);
+
+	//Returns the file extension(without '.') for the format.
+	static const char8_t *GetExtension(uint32_t Format);
+
+	//Re-encodes a sheet written with FormatQOI into Format, rows are streamed through in BandRows bands.
+	static bool Convert(const LWUTF8Iterator &SrcPath, const LWUTF8Iterator &DstPath, uint32_t Format, const SheetEncoding &Encoding, LWAllocator &Allocator);
+
+	virtual bool Begin(const LWUTF8Iterator &Path, const LWVector2i &Size, const SheetEncoding &Encoding, LWAllocator &Allocator) = 0;
+
+	//Rows are tightly packed RGBA8 texels, RowCount rows are expected to follow the previously written rows.
+	virtual bool WriteRows(const uint8_t *Rows, uint32_t RowCount) = 0;
+
+	virtual bool Finish(void) = 0;
+
+	virtual ~SheetWriter() = default;
+protected:
+	LWVector2i m_Size;
+	uint32_t m_RowsWritten = 0;
+};
+
+class SheetWriterPNG : public SheetWriter {
+public:
+	static const uint32_t IDATSize = 64 * 1024; //Size of each compressed IDAT chunk written.
+	static const int32_t CompressionLevel = 6;
+
+	bool Begin(const LWUTF8Iterator &Path, const LWVector2i &Size, const SheetEncoding &Encoding, LWAllocator &Allocator);
+
+	bool WriteRows(const uint8_t *Rows, uint32_t RowCount);
+
+	bool Finish(void);
+
+	~SheetWriterPNG();
+private:
+	bool WriteChunk(const char *Type, const uint8_t *Data, uint32_t Len);
+
+	bool Deflate(const uint8_t *Data, uint32_t Len, int32_t Flush);
+
+	//Picks the png filter with the smallest sum of absolute differences for Row, and writes the filtered row(with filter byte) to m_FilterRow.
+	void FilterRow(const uint8_t *Row);
+
+	LWFileStream m_Stream;
+	z_stream m_ZStream;
+	bool m_ZStreamValid = false;
+	uint8_t *m_PrevRow = nullptr;
+	uint8_t *m_FilterRow = nullptr;
+	uint8_t *m_TestRow = nullptr;
+	uint8_t *m_IDATBuffer = nullptr;
+};
+
+//Writes BC4/BC5/BC7 blocks into a DDS or KTX2 container, rows are gathered into bands of block rows which are compressed across worker threads.
+class SheetWriterBC : public SheetWriter {
+public:
+	static const uint32_t BandBlockRows = 32; //Block rows compressed per band.
+
+	bool Begin(const LWUTF8Iterator &Path, const LWVector2i &Size, const SheetEncoding &Encoding, LWAllocator &Allocator);
+
+	bool WriteRows(const uint8_t *Rows, uint32_t RowCount);
+
+	bool Finish(void);
+
+	SheetWriterBC(uint32_t Container);
+
+	~SheetWriterBC();
+private:
+	bool WriteDDSHeader(uint32_t DataSize);
+
+	bool WriteKTX2Header(uint32_t DataSize);
+
+	bool CompressBand(void);
+
+	LWFileStream m_Stream;
+	SheetEncoding m_Encoding;
+	uint32_t m_Container = FormatDDS;
+	uint32_t m_PaddedWidth = 0;
+	uint32_t m_BandRows = 0; //Rows currently held in m_Band.
+	uint8_t *m_Band = nullptr;
+	uint8_t *m_Blocks = nullptr;
+};
+
+//Writes sheets as QOI, which encodes in a single pass with no entropy coding so exports are limited by readback rather than compression.
+class SheetWriterQOI : public SheetWriter {
+public:
+	static const uint32_t BufferSize = 64 * 1024;
+
+	bool Begin(const LWUTF8Iterator &Path, const LWVector2i &Size, const SheetEncoding &Encoding, LWAllocator &Allocator);
+
+	bool WriteRows(const uint8_t *Rows, uint32_t RowCount);
+
+	bool Finish(void);
+
+	~SheetWriterQOI();
+private:
+	bool FlushBuffer(void);
+
+	LWFileStream m_Stream;
+	uint8_t *m_Buffer = nullptr;
+	uint32_t m_BufferLen = 0;
+	uint32_t m_Index[64];
+	uint32_t m_Prev = 0;
+	uint32_t m_Run = 0;
+};
+
+//Streaming decoder for sheets written by SheetWriterQOI.
+class SheetReaderQOI {
+public:
+	static const uint32_t BufferSize = 64 * 1024;
+
+	bool Open(const LWUTF8Iterator &Path, LWAllocator &Allocator);
+
+	//Decodes the next RowCount rows into tightly packed RGBA8 texels.
+	bool ReadRows(uint8_t *Rows, uint32_t RowCount);
+
+	const LWVector2i &GetSize(void) const;
+
+	~SheetReaderQOI();
+private:
+	bool NextByte(uint8_t &Byte);
+
+	LWFileStream m_Stream;
+	LWVector2i m_Size;
+	uint8_t *m_Buffer = nullptr;
+	uint32_t m_BufferLen = 0;
+	uint32_t m_BufferPos = 0;
+	uint32_t m_Index[64];
+	uint32_t m_Prev = 0;
+	uint32_t m_Run = 0;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+#ifndef SLOTTABLE_H
+#define SLOTTABLE_H
+#include <LWCore/LWTypes.h>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+//Hands out generational ids, the low SlotBits index a GSlotTable directly, and the high bits count how often the slot has been reused, so a released id never finds the slot's next owner.
+//Ids are allocated by whichever thread pushes pending data, and freed by the render thread, so the allocator is locked, while the tables themselves are only touched by the render thread.
+class GSlotAllocator {
+public:
+	static const uint32_t SlotBits = 20;
+	static const uint32_t SlotMask = (1 << SlotBits) - 1;
+	static const uint32_t GenerationMask = 0xFFFFFFFF >> SlotBits; //Generations wrap after this many reuses of a slot.
+
+	static uint32_t GetSlot(uint32_t ID);
+
+	//Returns 0 if every slot is in use, slot 0 is never handed out so 0 is never a valid id.
+	uint32_t Allocate(void);
+
+	//Bumps the slot's generation, and makes it available for reuse.
+	void Free(uint32_t ID);
+
+	bool isValid(uint32_t ID);
+private:
+	std::mutex m_Lock;
+	std::vector<uint32_t> m_Generations; //Indexed by slot.
+	std::vector<uint32_t> m_FreeSlots;
+};
+
+//Values stored directly at their id's slot, lookups compare the whole id so stale ids miss instead of finding a reused slot.
+template<class Type>
+class GSlotTable {
+public:
+	struct Slot {
+		uint32_t m_ID = 0; //0 for empty slots.
+		Type m_Value = Type();
+	};
+
+	Type *Find(uint32_t ID) {
+		uint32_t Idx = GSlotAllocator::GetSlot(ID);
+		if (!ID || Idx >= m_Slots.size() || m_Slots[Idx].m_ID != ID) return nullptr;
+		return &m_Slots[Idx].m_Value;
+	}
+
+	const Type *Find(uint32_t ID) const {
+		uint32_t Idx = GSlotAllocator::GetSlot(ID);
+		if (!ID || Idx >= m_Slots.size() || m_Slots[Idx].m_ID != ID) return nullptr;
+		return &m_Slots[Idx].m_Value;
+	}
+
+	//Returns ID's value, replacing whatever was in it's slot.
+	Type &Insert(uint32_t ID) {
+		uint32_t Idx = GSlotAllocator::GetSlot(ID);
+		if (Idx >= m_Slots.size()) m_Slots.resize(std::max<size_t>(Idx + 1, m_Slots.size() * 2));
+		Slot &S = m_Slots[Idx];
+		if (S.m_ID != ID) S = Slot();
+		S.m_ID = ID;
+		return S.m_Value;
+	}
+
+	bool Remove(uint32_t ID) {
+		if (!Find(ID)) return false;
+		m_Slots[GSlotAllocator::GetSlot(ID)] = Slot();
+		return true;
+	}
+
+	//Iterates every slot, including empty ones with an m_ID of 0.
+	typename std::vector<Slot>::iterator begin(void) {
+		return m_Slots.begin();
+	}
+
+	typename std::vector<Slot>::iterator end(void) {
+		return m_Slots.end();
+	}
+private:
+	std::vector<Slot> m_Slots;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,151 @@
+#ifndef SOFTRENDERER_H
+#define SOFTRENDERER_H
+#include <LWCore/LWTypes.h>
+#include <LWCore/LWVector.h>
+#include <LWCore/LWSVector.h>
+#include <LWCore/LWSMatrix.h>
+#include <LWVideo/LWTypes.h>
+#include "WorkerPool.h"
+#include <unordered_map>
+#include <vector>
+
+struct GFrame;
+
+struct GFrameModel;
+
+struct GModelData;
+
+struct GAnimData;
+
+struct GMaterial;
+
+//CPU copy of an uploaded geometry buffer, vertices are GStaticVertice/GSkeletonVertice and indices are 16 or 32 bit depending on TypeSize.
+struct SoftGeometry {
+	std::vector<char> m_Data;
+	uint32_t m_TypeSize = 0;
+	uint32_t m_Count = 0;
+};
+
+//CPU copy of an uploaded RGBA8 texture.
+struct SoftTexture {
+	std::vector<uint8_t> m_Texels;
+	LWVector2i m_Size;
+};
+
+//Maps ndc coordinates into a render target's pixels, y is kept pointing up like ndc.
+struct SoftViewport {
+	LWVector2f m_Scale;
+	LWVector2f m_Offset;
+	LWVector2i m_Size;
+};
+
+//Cpu rasterizer for exporting on machines without a usable gpu.  It consumes the same GFrame as Renderer, and writes each export sprite straight into it's tile of the output layers.
+//Targets are split into TileSize bins which worker threads rasterize independently, every bin processes triangles in submission order so the output doesn't depend on the thread count.
+class SoftRenderer {
+public:
+	static const uint32_t TileSize = 32;
+	static const uint32_t SampleCount = 4; //Coverage samples per pixel, laid out in the standard 4x msaa pattern.
+	static const uint32_t MaxShadowLayers = 4;
+
+	//Interpolated attributes, world position, texcoord, transparency, and the tbn vectors.
+	static const uint32_t AttrWPosition = 0;
+	static const uint32_t AttrTexCoord = 3;
+	static const uint32_t AttrTransparency = 5;
+	static const uint32_t AttrTangent = 6;
+	static const uint32_t AttrBiTangent = 9;
+	static const uint32_t AttrNormal = 12;
+	static const uint32_t AttrCount = 15;
+
+	struct Vertex {
+		LWSVector4f m_Clip;
+		float m_Attr[AttrCount];
+	};
+
+	struct Triangle {
+		static const uint32_t Blend = 0x1;
+		static const uint32_t DepthOut = 0x2;
+
+		float m_EdgeA[3]; //Edge i is the edge opposite of vertex i.
+		float m_EdgeB[3];
+		float m_EdgeC[3];
+		bool m_TopLeft[3];
+		float m_iArea;
+		float m_Depth[3];
+		float m_iW[3];
+		float m_Attr[3][AttrCount]; //Pre-divided by w for perspective correct interpolation.
+		LWVector4i m_Bounds; //Inclusive pixel bounds.
+		uint32_t m_ModelIndex;
+		uint32_t m_Flags;
+	};
+
+	//Keeps a copy of geometry as it's uploaded, a null Data or Count of 0 releases the ID.
+	void PushGeometry(uint32_t ID, const char *Data, uint32_t TypeSize, uint32_t Count);
+
+	//Keeps a copy of an image as it's uploaded, only RGBA8 images are supported and anything else is shaded as if the texture was unbound.
+	void PushTexture(uint32_t ID, const LWImage *Image);
+
+	SoftRenderer &SetShadowSize(const LWVector2i &Size);
+
+	//Renders an export frame into the output layer selected by the frame's RenderOutput, frames with no target bounds are skipped.
+	SoftRenderer &RenderFrame(GFrame &F);
+
+	//Returns tightly packed rgba8 texels for Layer, or null if no export frame has been rendered.
+	const uint8_t *GetOutputLayer(uint32_t Layer) const;
+
+	LWVector2i GetOutputSize(void) const;
+
+	//ThreadCount of 0 uses every hardware thread.
+	SoftRenderer(uint32_t ThreadCount = 0);
+private:
+	Vertex TransformVertex(const char *Vert, bool isSkinned, const GModelData &ModelData, const GAnimData *AnimData, const LWSMatrix4f &ProjView, bool DepthOnly) const;
+
+	void PushModel(GFrame &F, uint32_t ModelIndex, uint32_t PassID, const SoftViewport &Viewport, bool Transparent, bool DepthOnly);
+
+	void ClipTriangle(const Vertex &A, const Vertex &B, const Vertex &C, const SoftViewport &Viewport, uint32_t ModelIndex, uint32_t Flags, bool DepthOnly);
+
+	void SetupTriangle(const Vertex &A, const Vertex &B, const Vertex &C, const SoftViewport &Viewport, uint32_t ModelIndex, uint32_t Flags, bool DepthOnly);
+
+	//Collects and bins every triangle in the pass, returns false if nothing landed in the viewport.
+	bool BuildPass(GFrame &F, uint32_t PassID, const SoftViewport &Viewport, bool DepthOnly);
+
+	void RenderShadowPass(GFrame &F, uint32_t PassID);
+
+	void RenderTile(GFrame &F, uint32_t Tile, uint32_t Worker, uint32_t RType);
+
+	void ResolveOutput(GFrame &F, uint32_t RType);
+
+	//Returns false if the pixel is discarded.
+	bool ShadePixel(GFrame &F, const GFrameModel &Mdl, const float *Attr, uint32_t RType, LWSVector4f &Color, LWSVector4f &Emission) const;
+
+	LWSVector4f SampleIf(const GFrameModel &Mdl, const GMaterial &Mat, uint32_t TexID, const LWVector2f &TexCoord, bool MakeLinear, const LWSVector4f &DefaultValue) const;
+
+	float SampleShadow(uint32_t Layer, const LWVector2f &TexCoord, float Depth, float Bias) const;
+
+	float DirectionShadow(GFrame &F, const LWVector4i &ShadowIdxs, const LWSVector4f &WPosition) const;
+
+	float SpotShadow(GFrame &F, int32_t TargetPass, const LWSVector4f &WPosition) const;
+
+	std::unordered_map<uint32_t, SoftGeometry> m_GeometryMap;
+	std::unordered_map<uint32_t, SoftTexture> m_TextureMap;
+	std::vector<Triangle> m_Triangles;
+	std::vector<std::vector<uint32_t>> m_Bins;
+	std::vector<int32_t> m_VertexCache;
+	std::vector<Vertex> m_Vertices;
+	std::vector<float> m_ShadowMaps[MaxShadowLayers];
+	std::vector<float> m_TileDepth; //Per worker sample buffers.
+	std::vector<LWVector4f> m_TileColor;
+	std::vector<LWVector4f> m_TileEmission;
+	std::vector<LWVector4f> m_Color; //Resolved sprite tile.
+	std::vector<LWVector4f> m_Emission;
+	std::vector<LWVector4f> m_BlurTemp;
+	std::vector<uint8_t> m_Output;
+	SoftViewport m_PassViewport; //Viewport of the last built pass.
+	LWVector2i m_ShadowSize = LWVector2i(2048, 2048);
+	LWVector2i m_OutputSize = LWVector2i();
+	LWVector2i m_BinCount = LWVector2i();
+	uint32_t m_ThreadCount = 0;
+	WorkerPool m_Pool; //Worker ids index the per worker tile buffers, so it's sized to m_ThreadCount.
+	bool m_WarnedIBL = false;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef SPRITEHASH_H
+#define SPRITEHASH_H
+#include <LWCore/LWTypes.h>
+#include <LWCore/LWVector.h>
+#include <LWCore/LWUnicode.h>
+#include <vector>
+
+//64 bit FNV-1a hash, used to fingerprint every input that decides an exported sprite's pixels.
+class SpriteHasher {
+public:
+	static const uint64_t Seed = 0xCBF29CE484222325ull;
+	static const uint64_t Prime = 0x100000001B3ull;
+
+	SpriteHasher &Push(const void *Data, uint32_t Len);
+
+	//Type must not contain padding, otherwise uninitialized bytes would change the hash.
+	template<class Type>
+	SpriteHasher &Push(const Type &Value) {
+		return Push(&Value, sizeof(Type));
+	}
+
+	uint64_t Get(void) const;
+
+	SpriteHasher(uint64_t Hash = Seed);
+private:
+	uint64_t m_Hash;
+};
+
+struct SpriteHashHeader {
+	uint32_t m_Magic;
+	uint32_t m_Version;
+	int32_t m_Width; //Size of the sheet the hashes were written with.
+	int32_t m_Height;
+	uint64_t m_LayoutHash;
+	uint32_t m_SpriteCount;
+	uint32_t m_Reserved;
+};
+
+static_assert(sizeof(SpriteHashHeader) == 32, "SpriteHashHeader must be tightly packed.");
+
+//Per sprite hashes of one exported sheet, saved next to the sheet so the next export can tell which sprites are unchanged.
+//File layout is a SpriteHashHeader followed by m_SpriteCount hashes in export order, sprites that weren't rendered into the sheet have a hash of 0.
+class SpriteHashFile {
+public:
+	static const uint32_t Magic = 0x48534949; //"IISH"
+	static const uint32_t Version = 2; //Bump whenever rendering changes in a way the hashed inputs can't see, so old sheets are never reused.
+	static const char8_t *Extension; //Appended to the sheet's file name.
+
+	bool Save(const LWUTF8Iterator &Path, LWAllocator &Allocator) const;
+
+	//Returns false if the file is missing, or was written by a different version.
+	bool Load(const LWUTF8Iterator &Path, LWAllocator &Allocator);
+
+	LWVector2i m_TexSize = LWVector2i();
+	uint64_t m_LayoutHash = 0;
+	std::vector<uint64_t> m_Hashes;
+};
+
+#endif
\ No newline at end of file
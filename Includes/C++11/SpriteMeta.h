@@ -0,0 +1,151 @@
+#ifndef SPRITEMETA_H
+#define SPRITEMETA_H
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+//Binary sprite meta-data written alongside the json meta-data, laid out so a client can memory map the file and read it in place with no parsing.
+//This header only depends on the standard library so it can be dropped into game clients as is.
+//Every value is little-endian, and the records are read in place, so the reader expects a little-endian host.
+//Layout:
+//	SpriteMetaHeader
+//	SpriteMetaSheet[SheetCount]
+//	float FrameTimes[FrameCount]
+//	SpriteMetaRecord[FrameCount*DirectionCount], sprite for Frame/Direction is at Frame*DirectionCount+Direction(the same order as the json Frames/Sprites arrays).
+//	char StringTable[StringTableSize], null terminated utf-8 strings referenced by offset.
+
+static const uint32_t SpriteMetaMagic = 0x4D505349; //'ISPM'
+static const uint16_t SpriteMetaVersion = 1;
+static const uint32_t SpriteMetaHasOffsets = 0x1; //xOffset/yOffset in each record are valid.
+
+struct SpriteMetaHeader {
+	uint32_t m_Magic;
+	uint16_t m_Version;
+	uint16_t m_HeaderSize;
+	uint32_t m_Flags;
+	uint32_t m_FileSize;
+	uint32_t m_DirectionCount;
+	uint32_t m_FrameCount;
+	float m_TotalTime;
+	float m_TimeOffset;
+	float m_RotationOffset; //In degrees.
+	uint32_t m_SheetCount;
+	uint32_t m_SheetTableOffset;
+	uint32_t m_FrameTableOffset;
+	uint32_t m_SpriteTableOffset;
+	uint32_t m_StringTableOffset;
+	uint32_t m_StringTableSize;
+	uint32_t m_Reserved;
+};
+
+//A render layer sheet, Key is the json name of the layer(Color, Normals, etc), and Path is the sheet's file name relative to the meta-data.
+struct SpriteMetaSheet {
+	uint32_t m_KeyOffset;
+	uint32_t m_PathOffset;
+};
+
+struct SpriteMetaRecord {
+	uint16_t m_X;
+	uint16_t m_Y;
+	uint16_t m_Width;
+	uint16_t m_Height;
+	float m_XOffset;
+	float m_YOffset;
+};
+
+static_assert(sizeof(SpriteMetaHeader) == 64, "SpriteMetaHeader must be tightly packed.");
+static_assert(sizeof(SpriteMetaSheet) == 8, "SpriteMetaSheet must be tightly packed.");
+static_assert(sizeof(SpriteMetaRecord) == 16, "SpriteMetaRecord must be tightly packed.");
+
+//Validates and reads a mapped binary meta-data file, the data must remain valid for as long as the reader is used.
+class SpriteMetaReader {
+public:
+	//Returns false if Data is not a supported meta-data file, or any table lies outside of Size.
+	bool Open(const void *Data, size_t Size) {
+		const uint8_t *Bytes = (const uint8_t*)Data;
+		m_Header = nullptr;
+		if (!Data || Size < sizeof(SpriteMetaHeader) || ((uintptr_t)Data & 3) != 0) return false;
+		const SpriteMetaHeader *H = (const SpriteMetaHeader*)Bytes;
+		if (H->m_Magic != SpriteMetaMagic || H->m_Version != SpriteMetaVersion || H->m_HeaderSize < sizeof(SpriteMetaHeader) || H->m_FileSize > Size) return false;
+		uint64_t SpriteCount = (uint64_t)H->m_DirectionCount * H->m_FrameCount;
+		if (!InRange(H->m_SheetTableOffset, (uint64_t)H->m_SheetCount * sizeof(SpriteMetaSheet), H->m_FileSize)) return false;
+		if (!InRange(H->m_FrameTableOffset, (uint64_t)H->m_FrameCount * sizeof(float), H->m_FileSize)) return false;
+		if (!InRange(H->m_SpriteTableOffset, SpriteCount * sizeof(SpriteMetaRecord), H->m_FileSize)) return false;
+		if (!InRange(H->m_StringTableOffset, H->m_StringTableSize, H->m_FileSize)) return false;
+		if (((H->m_SheetTableOffset | H->m_FrameTableOffset | H->m_SpriteTableOffset) & 3) != 0) return false;
+		//The string table must be null terminated, and every sheet string must start inside of it.
+		if (!H->m_StringTableSize || Bytes[H->m_StringTableOffset + H->m_StringTableSize - 1] != 0) return false;
+		const SpriteMetaSheet *Sheets = (const SpriteMetaSheet*)(Bytes + H->m_SheetTableOffset);
+		for (uint32_t i = 0; i < H->m_SheetCount; i++) {
+			if (Sheets[i].m_KeyOffset >= H->m_StringTableSize || Sheets[i].m_PathOffset >= H->m_StringTableSize) return false;
+		}
+		m_Data = Bytes;
+		m_Header = H;
+		return true;
+	}
+
+	const SpriteMetaHeader *GetHeader(void) const {
+		return m_Header;
+	}
+
+	uint32_t GetSheetCount(void) const {
+		return m_Header->m_SheetCount;
+	}
+
+	const char *GetSheetKey(uint32_t i) const {
+		return GetString(GetSheets()[i].m_KeyOffset);
+	}
+
+	const char *GetSheetPath(uint32_t i) const {
+		return GetString(GetSheets()[i].m_PathOffset);
+	}
+
+	//Returns the sheet path for Key, or null if the layer wasn't exported.
+	const char *FindSheetPath(const char *Key) const {
+		for (uint32_t i = 0; i < m_Header->m_SheetCount; i++) {
+			if (!strcmp(GetSheetKey(i), Key)) return GetSheetPath(i);
+		}
+		return nullptr;
+	}
+
+	uint32_t GetFrameCount(void) const {
+		return m_Header->m_FrameCount;
+	}
+
+	uint32_t GetDirectionCount(void) const {
+		return m_Header->m_DirectionCount;
+	}
+
+	bool HasOffsets(void) const {
+		return (m_Header->m_Flags & SpriteMetaHasOffsets) != 0;
+	}
+
+	const float *GetFrameTimes(void) const {
+		return (const float*)(m_Data + m_Header->m_FrameTableOffset);
+	}
+
+	const SpriteMetaRecord *GetSprites(void) const {
+		return (const SpriteMetaRecord*)(m_Data + m_Header->m_SpriteTableOffset);
+	}
+
+	const SpriteMetaRecord &GetSprite(uint32_t Frame, uint32_t Direction) const {
+		return GetSprites()[Frame * m_Header->m_DirectionCount + Direction];
+	}
+private:
+	static bool InRange(uint64_t Offset, uint64_t Length, uint64_t FileSize) {
+		return Offset + Length <= FileSize;
+	}
+
+	const SpriteMetaSheet *GetSheets(void) const {
+		return (const SpriteMetaSheet*)(m_Data + m_Header->m_SheetTableOffset);
+	}
+
+	const char *GetString(uint32_t Offset) const {
+		return (const char*)(m_Data + m_Header->m_StringTableOffset + Offset);
+	}
+
+	const uint8_t *m_Data = nullptr;
+	const SpriteMetaHeader *m_Header = nullptr;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef SPRITEMETAWRITER_H
+#define SPRITEMETAWRITER_H
+#include <LWCore/LWTypes.h>
+#include <LWCore/LWUnicode.h>
+#include <LWPlatform/LWFileStream.h>
+#include <vector>
+#include <string>
+#include "SpriteMeta.h"
+
+//Builds the binary sprite meta-data described in SpriteMeta.h, the tables are small(16 bytes per sprite) so they're gathered in memory and written in a single pass by Save.
+class SpriteMetaWriter {
+public:
+	//Sizes the frame and sprite tables, clearing any previous contents.
+	SpriteMetaWriter &SetLayout(uint32_t DirectionCount, uint32_t FrameCount, uint32_t Flags);
+
+	SpriteMetaWriter &SetTimes(float TotalTime, float TimeOffset, float RotationOffset);
+
+	SpriteMetaWriter &PushSheet(const LWUTF8Iterator &Key, const LWUTF8Iterator &Path);
+
+	//Replaces the path of the sheet named Key, returns false if no sheet uses Key.
+	bool SetSheetPath(const LWUTF8Iterator &Key, const LWUTF8Iterator &Path);
+
+	SpriteMetaWriter &SetFrameTime(uint32_t Frame, float Time);
+
+	SpriteMetaWriter &SetSprite(uint32_t Frame, uint32_t Direction, const SpriteMetaRecord &Record);
+
+	bool Save(const LWUTF8Iterator &Path, LWAllocator &Allocator);
+
+	//Reads a previously saved file back in so it can be modified and saved again.
+	bool Load(const LWUTF8Iterator &Path, LWAllocator &Allocator);
+private:
+	SpriteMetaHeader m_Header = SpriteMetaHeader();
+	std::vector<std::string> m_SheetKeys;
+	std::vector<std::string> m_SheetPaths;
+	std::vector<float> m_FrameTimes;
+	std::vector<SpriteMetaRecord> m_Sprites;
+};
+
+#endif
\ No newline at end of file
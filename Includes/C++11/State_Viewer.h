@@ -3,12 +3,38 @@
 #include "State.h"
 #include "Scene.h"
 #include "UIViewer.h"
+#include "SheetWriter.h"
+#include "ExportShard.h"
+#include "SpriteHash.h"
+#include <string>
+
+//A scene kept loaded between server exports, the scene is reloaded if it's file changes.
+struct CachedScene {
+	Scene *m_Scene = nullptr;
+	char8_t m_Path[256];
+	uint64_t m_ModifiedTime = 0;
+	uint64_t m_LastUsed = 0;
+};
+
+//Incremental export state for a render layer, sprites whose hash matches the previous export's are copied from the previous sheet instead of being rendered.
+struct ExportLayerHashes {
+	SpriteHashFile m_Hashes; //Hashes of this export's sprites.
+	SpriteHashFile m_PrevHashes;
+	uint32_t m_RenderFirst = 0; //Range of the export's render list that's rendered into this layer.
+	uint32_t m_RenderCount = 0;
+	bool m_Reuse = false; //The previous sheet has the same layout, and can be read back.
+};
 
 class State_Viewer : public State {
 public:
+	static const uint32_t MaxCachedScenes = 8;
 	//PathNames appended to exports.
 	static const char8_t *RenderPathNames[];
+	//Meta-data names for each render layer's sheet.
+	static const char8_t *RenderImageNames[];
 	static const char8_t *SettingPath;
+	//Block encoding for each render layer when exporting to a compressed format.
+	static const SheetEncoding RenderEncodings[];
 
 	void Update(float dTime, App *A, uint64_t lCurrentTime);
 
@@ -29,15 +55,45 @@ public:
 
 	bool LoadScene(const LWUTF8Iterator &Path, App *A);
 
+	//Same as LoadScene, but reuses the scene from an earlier call for Path if the file hasn't been modified since, Cached is set if it was reused.
+	//The least recently used scene is dropped once MaxCachedScenes are loaded.
+	bool LoadCachedScene(const LWUTF8Iterator &Path, App *A, bool &Cached);
+
 	bool LoadSettings(const LWUTF8Iterator &Path, App *A);
 
 	bool SaveSettings(const LWUTF8Iterator &Path, App *A);
 
+	//Reads back and writes each export layer once it's finished rendering, then writes the meta data once every layer is written.
 	bool FinalizeExport(Renderer *R, App *A);
 
+	bool WriteExportLayer(uint32_t Layer, Renderer *R, App *A);
+
+	//Copies every sprite that didn't need rendering from the previous sheet into the staging buffer.
+	bool ReuseExportSprites(uint32_t Layer, const LWUTF8Iterator &SheetPath, const LWVector2i &TexSize, App *A);
+
+	void EndExport(void);
+
 	bool ExportMetaData(const LWUTF8Iterator &ExportPathNoExt, App *A);
 
-	bool Export(const LWUTF8Iterator &ExportPath);
+	//Writes the same meta-data as ExportMetaData in the binary layout from SpriteMeta.h to ExportPathNoExt.ismeta.
+	bool ExportBinaryMetaData(const LWUTF8Iterator &ExportPathNoExt, App *A);
+
+	//Reads ExportPathNoExt.ismeta back with SpriteMetaReader, and checks every value in it against the json meta-data written beside it.
+	bool VerifyMetaData(const LWUTF8Iterator &ExportPathNoExt, App *A);
+
+	//Converts every QOI sheet referenced by the meta-data at MetaPath to the selected export format, and updates the meta-data to reference the new sheets.
+	bool ConvertExport(const LWUTF8Iterator &MetaPath, App *A);
+
+	//Shard restricts the export to a range of directions, see ExportShard.
+	bool Export(const LWUTF8Iterator &ExportPath, App *A, const ExportShard &Shard = ExportShard());
+
+	bool isExporting(void) const;
+
+	//Unsharded exports write the binary meta-data even if it isn't toggled, and fail unless it reads back the same as the json.
+	State_Viewer &SetVerifyMeta(bool VerifyMeta);
+
+	//Returns true if the last export finished writing every layer and the meta-data.
+	bool GetExportResult(void) const;
 
 	void SetModelTheta(float Theta);
 
@@ -53,17 +109,43 @@ public:
 
 	~State_Viewer();
 private:
+	bool isSceneCached(Scene *S) const;
+
+	//Writes the export path with it's extension stripped to Buffer, shards get their own suffix.
+	void MakeExportPathNoExt(char8_t *Buffer, uint32_t BufferLen) const;
+
+	//Writes the meta-data parsed into J back to MetaPath with each layer's sheet replaced by SheetNames(indexed by render layer), every other value is copied as parsed.
+	bool RewriteMetaData(const LWUTF8Iterator &MetaPath, LWEJson &J, const std::string *SheetNames, App *A);
+
+	//Returns the format sheets are written in, shards always write QOI for Merge to read back.
+	uint32_t GetExportSheetFormat(void);
+
+	//Hashes the inputs of every sprite being exported, and builds the list of sprites that have to be rendered.
+	//Only QOI sheets can be read back losslessly, so other formats always render every sprite.
+	void BuildExportRenderList(const LWVector2f &WndSize, Renderer *R, App *A);
+
 	char8_t m_ExportPath[256];
 	UIViewer m_UIViewer;
 	Scene *m_ViewScene = nullptr;
 	Scene *m_OldScene = nullptr;
 	bool m_Exporting = false;
+	bool m_ExportResult = false;
+	bool m_VerifyMeta = false;
 	float m_ModelTheta = 0.0f;
 	std::vector<Sprite> m_ExportList;
+	ExportShard m_ExportShard;
+	uint32_t m_ExportSpriteFirst = 0; //Range of m_ExportList rendered by this export.
+	uint32_t m_ExportSpriteCount = 0;
+	std::vector<uint32_t> m_ExportRenderList; //Indices into m_ExportList to render, layer after layer.
+	ExportLayerHashes m_ExportLayers[RenderCount];
 	LWVector2i m_ExportTexSize = LWVector2i();
 	uint32_t m_ExportFirstFrame = -1;
 	uint32_t m_ExportFinalFrame = -1;
+	uint32_t m_ExportLayer = 0; //Next export layer waiting to be written.
+	uint8_t *m_ExportStaging = nullptr;
 	float m_Time = 0.0f;
+	CachedScene m_SceneCache[MaxCachedScenes];
+	uint64_t m_SceneCacheTick = 0;
 };
 
 #endif
\ No newline at end of file
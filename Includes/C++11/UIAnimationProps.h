@@ -13,7 +13,7 @@ struct UIAnimationProps : public UIItem {
 
 	void ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *Window, App *A);
 
-	void SerializeSettings(LWEJson &JSon, LWEJObject *Parent, App *A);
+	void SerializeSettings(JsonWriter &JSon, App *A);
 
 	void DeserializeSettings(LWEJson &JSon, LWEJObject *Parent, App *A);
 
@@ -12,7 +12,7 @@ struct UIPerspectiveControls : public UIItem {
 
 	void ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *Window, App *A);
 
-	void SerializeSettings(LWEJson &JSon, LWEJObject *Parent, App *A);
+	void SerializeSettings(JsonWriter &JSon, App *A);
 
 	void DeserializeSettings(LWEJson &JSon, LWEJObject *Parent, App *A);
 
@@ -31,7 +31,7 @@ struct UIOrthoControls : public UIItem {
 
 	void ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *Window, App *A);
 
-	void SerializeSettings(LWEJson &JSon, LWEJObject *Parent, App *A);
+	void SerializeSettings(JsonWriter &JSon, App *A);
 
 	void DeserializeSettings(LWEJson &JSon, LWEJObject *Parent, App *A);
 
@@ -54,7 +54,7 @@ struct UICameraControls : public UIItem {
 
 	void ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *Window, App *A);
 
-	void SerializeSettings(LWEJson &JSon, LWEJObject *Parent, App *A);
+	void SerializeSettings(JsonWriter &JSon, App *A);
 
 	void DeserializeSettings(LWEJson &JSon, LWEJObject *Parent, App *A);
 
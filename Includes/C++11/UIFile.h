@@ -38,7 +38,7 @@ struct UIFile : public UIItem {
 
 	void ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *Window, App *A);
 
-	void SerializeSettings(LWEJson &J, LWEJObject *Parent, App *A);
+	void SerializeSettings(JsonWriter &J, App *A);
 
 	void DeserializeSettings(LWEJson &J, LWEJObject *Parent, App *A);
 
@@ -46,6 +46,8 @@ struct UIFile : public UIItem {
 
 	void ExportFileBtnReleased(LWEUI *UI, uint32_t EventCode, void *UserData);
 
+	void ConvertFileBtnReleased(LWEUI *UI, uint32_t EventCode, void *UserData);
+
 	//Calculates for tight packing.
 	LWVector2i CalculateTightSpriteLocations(const LWVector2f &WndSize, Scene *S, Camera &Cam, UIIsometricProps &IsoProps, UIAnimationProps &AnimProps, App *A, std::vector<Sprite> &SpriteArray);
 
@@ -62,21 +64,34 @@ struct UIFile : public UIItem {
 	//Returns the render setting for the specified idx of the enabled idx's.
 	uint32_t GetExportRenderSetting(uint32_t Idx);
 
+	//Returns the SheetWriter format selected for export.
+	uint32_t GetExportFormat(void);
+
+	//Returns the BlockCompress quality preset selected for compressed exports.
+	uint32_t GetExportQuality(void);
+
 	void ExportsTglChanged(UIToggleGroup &TglGroup, uint32_t ToggleID, UIToggle &Toggle, bool Toggled, void *UserData);
 
 	void PackingTglChanged(UIToggleGroup &TglGroup, uint32_t ToggleID, UIToggle &Toggle, bool Toggled, void *UserData);
 
 	void MetaDataTglChanged(UIToggleGroup &TglGroup, uint32_t ToggleID, UIToggle &Toggle, bool Toggled, void *UserData);
 
+	void FormatTglChanged(UIToggleGroup &TglGroup, uint32_t ToggleID, UIToggle &Toggle, bool Toggled, void *UserData);
+
+	void QualityTglChanged(UIToggleGroup &TglGroup, uint32_t ToggleID, UIToggle &Toggle, bool Toggled, void *UserData);
+
 	UIFile(const LWUTF8Iterator &Name, LWEUIManager *UIMan, UIViewer *Viewer, App *A);
 
 	UIFile() = default;
 
 	UILabelBtn m_SelectFileBtn;
 	UILabelBtn m_ExportFileBtn;
+	UILabelBtn m_ConvertFileBtn;
 	UIToggleGroup m_ExportTgls;
 	UIToggleGroup m_PackingTgls;
 	UIToggleGroup m_MetaDataTgls;
+	UIToggleGroup m_FormatTgls;
+	UIToggleGroup m_QualityTgls;
 	std::vector<Sprite> m_SpriteList;
 	LWEUILabel *m_TextureSizeLbl = nullptr;
 	UIViewer *m_Viewer = nullptr;
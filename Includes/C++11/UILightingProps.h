@@ -13,7 +13,7 @@ struct UILightSunProps : public UIItem {
 
 	void ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *Window, App *A);
 
-	void SerializeSettings(LWEJson &J, LWEJObject *Parent, App *A);
+	void SerializeSettings(JsonWriter &J, App *A);
 
 	void DeserializeSettings(LWEJson &J, LWEJObject *Parent, App *A);
 
@@ -43,7 +43,7 @@ struct UILightIBLProps : public UIItem {
 
 	void ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *Window, App *A);
 
-	void SerializeSettings(LWEJson &J, LWEJObject *Parent, App *A);
+	void SerializeSettings(JsonWriter &J, App *A);
 
 	void DeserializeSettings(LWEJson &J, LWEJObject *Parent, App *A);
 
@@ -83,7 +83,7 @@ struct UILightingProps : public UIItem {
 
 	void ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *Window, App *A);
 
-	void SerializeSettings(LWEJson &J, LWEJObject *Parent, App *A);
+	void SerializeSettings(JsonWriter &J, App *A);
 
 	void DeserializeSettings(LWEJson &J, LWEJObject *Parent, App *A);
 
@@ -7,6 +7,7 @@
 #include <LWEUI/LWEUIListBox.h>
 #include <LWEUI/LWEUITextInput.h>
 #include <LWEUI/LWEUIRect.h>
+#include "JsonWriter.h"
 
 struct UIToggle;
 
@@ -13,7 +13,7 @@ struct UIViewer : public UIItem {
 
 	void ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *Window, App *A);
 
-	void SerializeSettings(LWEJson &J, LWEJObject *Parent, App *A);
+	void SerializeSettings(JsonWriter &J, App *A);
 
 	void DeserializeSettings(LWEJson &J, LWEJObject *Parent, App *A);
 
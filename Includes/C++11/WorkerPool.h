@@ -0,0 +1,45 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+#include <LWCore/LWTypes.h>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+
+//Threads kept alive between parallel loops, so work handed out in many small batches(sheet bands, per frame pass sorts) doesn't create and join threads for every batch.
+class WorkerPool {
+public:
+	typedef std::function<void(uint32_t Job, uint32_t Worker)> JobFunc;
+
+	//Runs Fn for every job in [0, JobCount), each worker claims the next job until none are left.  The calling thread works as worker 0, and Run returns once every job is done.
+	//Calls from different threads are run one after another.
+	void Run(uint32_t JobCount, const JobFunc &Fn);
+
+	//Includes the calling thread.
+	uint32_t GetThreadCount(void) const;
+
+	//ThreadCount includes the calling thread, 0 uses every hardware thread.
+	WorkerPool(uint32_t ThreadCount = 0);
+
+	~WorkerPool();
+private:
+	void WorkerThread(uint32_t WorkerID);
+
+	void Work(uint32_t WorkerID);
+
+	std::vector<std::thread> m_Threads;
+	std::mutex m_RunLock;
+	std::mutex m_Lock;
+	std::condition_variable m_WakeCondition;
+	std::condition_variable m_DoneCondition;
+	const JobFunc *m_Fn = nullptr;
+	std::atomic<uint32_t> m_NextJob{ 0 };
+	uint32_t m_JobCount = 0;
+	uint32_t m_Generation = 0; //Bumped by each Run to wake the workers.
+	uint32_t m_BusyWorkers = 0;
+	bool m_Quit = false;
+};
+
+#endif
\ No newline at end of file
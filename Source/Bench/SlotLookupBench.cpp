@@ -0,0 +1,80 @@
+#include "SlotTable.h"
+#include <unordered_map>
+#include <random>
+#include <chrono>
+#include <cstdio>
+
+//Compares the renderer's per draw geometry/texture lookup through a GSlotTable against the unordered_map it replaced.
+//Ids churn before measuring so the table holds reused slots with bumped generations, like a viewer that has loaded and released scenes.
+
+//Same size as GGeometry, without pulling in the renderer.
+struct BenchValue {
+	void *m_Buffer = nullptr;
+	uint32_t m_Arena = -1;
+	uint32_t m_Offset = 0;
+	uint32_t m_Count = 0;
+	uint32_t m_VerticeID = 0;
+};
+
+static const uint32_t LiveIDs = 4000;
+static const uint32_t ReleasedIDs = 1000;
+static const uint32_t LookupCount = 4000000;
+static const uint32_t Runs = 5;
+
+template<class Func>
+static double MeasureNS(Func &&Fn) {
+	double Best = 0.0;
+	for (uint32_t i = 0; i < Runs; i++) {
+		auto Start = std::chrono::steady_clock::now();
+		Fn();
+		double NS = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count() / LookupCount;
+		if (!i || NS < Best) Best = NS;
+	}
+	return Best;
+}
+
+int main(int argc, char **argv) {
+	GSlotAllocator Allocator;
+	GSlotTable<BenchValue> Table;
+	std::unordered_map<uint32_t, BenchValue> Map;
+	std::vector<uint32_t> IDs;
+	std::mt19937 Rand(1234);
+	for (uint32_t i = 0; i < LiveIDs; i++) IDs.push_back(Allocator.Allocate());
+	for (uint32_t i = 0; i < ReleasedIDs; i++) {
+		std::swap(IDs[Rand() % IDs.size()], IDs.back());
+		Allocator.Free(IDs.back());
+		IDs.pop_back();
+	}
+	//Reuses the released slots with their generations bumped.
+	for (uint32_t i = 0; i < ReleasedIDs; i++) IDs.push_back(Allocator.Allocate());
+	for (auto &&ID : IDs) {
+		BenchValue V;
+		V.m_Count = ID & 0xFF;
+		Table.Insert(ID) = V;
+		Map[ID] = V;
+	}
+	std::vector<uint32_t> Lookups(LookupCount);
+	for (auto &&L : Lookups) L = IDs[Rand() % IDs.size()];
+
+	volatile uint64_t Sink = 0;
+	double MapNS = MeasureNS([&]() {
+		uint64_t Sum = 0;
+		for (auto &&L : Lookups) {
+			auto Iter = Map.find(L);
+			if (Iter != Map.end()) Sum += Iter->second.m_Count;
+		}
+		Sink = Sink + Sum;
+	});
+	double TableNS = MeasureNS([&]() {
+		uint64_t Sum = 0;
+		for (auto &&L : Lookups) {
+			const BenchValue *V = Table.Find(L);
+			if (V) Sum += V->m_Count;
+		}
+		Sink = Sink + Sum;
+	});
+	printf("%u live ids, %u lookups, best of %u runs:\n", LiveIDs, LookupCount, Runs);
+	printf("unordered_map: %.2fns per lookup\n", MapNS);
+	printf("GSlotTable:    %.2fns per lookup\n", TableNS);
+	return 0;
+}
\ No newline at end of file
@@ -12,6 +12,90 @@
 #include "Logger.h"
 #include "Scene.h"
 #include "Camera.h"
+#include "ExportServer.h"
+#include <cstring>
+#include <cstdlib>
+
+//BatchExport
+uint32_t BatchExport::ParseArguments(int32_t argc, LWUTF8Iterator *argv, BatchExport &Batch) {
+	char8_t Flag[32];
+	uint32_t Result = NoBatch;
+	for (int32_t i = 0; i < argc; i++) {
+		argv[i].Copy(Flag, sizeof(Flag));
+		if (!strcmp((const char*)Flag, "--software")) {
+			Batch.m_Software = true;
+			continue;
+		}
+		if (!strcmp((const char*)Flag, "--texture-arrays")) {
+			Batch.m_TextureArrays = true;
+			continue;
+		}
+		if (!strcmp((const char*)Flag, "--verify-meta")) {
+			Batch.m_VerifyMeta = true;
+			continue;
+		}
+		if (!strcmp((const char*)Flag, "--server")) {
+			Batch.m_Server = true;
+			Result = Valid;
+			//The port is optional.
+			if (i + 1 < argc) {
+				argv[i + 1].Copy(Flag, sizeof(Flag));
+				int32_t Port = atoi((const char*)Flag);
+				if (Port > 0 && Port <= 0xFFFF) {
+					Batch.m_ServerPort = (uint16_t)Port;
+					i++;
+				}
+			}
+			continue;
+		}
+		if (!strcmp((const char*)Flag, "--shard")) {
+			if (i + 2 >= argc) {
+				LogCritical("Error: --shard requires <Index> <Count>.");
+				return Invalid;
+			}
+			argv[i + 1].Copy(Flag, sizeof(Flag));
+			int32_t Index = atoi((const char*)Flag);
+			argv[i + 2].Copy(Flag, sizeof(Flag));
+			int32_t Count = atoi((const char*)Flag);
+			if (Count < 1 || Count > (int32_t)ExportShard::MaxShards || Index < 0 || Index >= Count) {
+				LogCritical(LWUTF8I::Fmt<128>("Error: --shard index must be less than the count, and the count between 1 and {}.", ExportShard::MaxShards));
+				return Invalid;
+			}
+			Batch.m_Shard = ExportShard((uint32_t)Index, (uint32_t)Count);
+			i += 2;
+			continue;
+		}
+		if (!strcmp((const char*)Flag, "--merge")) {
+			if (i + 1 >= argc) {
+				LogCritical("Error: --merge requires the <Output> path the shards were exported to.");
+				return Invalid;
+			}
+			argv[i + 1].Copy(Batch.m_OutputPath, sizeof(Batch.m_OutputPath));
+			Batch.m_Merge = true;
+			Result = Valid;
+			i++;
+			continue;
+		}
+		if (strcmp((const char*)Flag, "--export")) continue;
+		if (i + 3 >= argc) {
+			LogCritical("Error: --export requires <Model> <Settings> <Output> paths.");
+			return Invalid;
+		}
+		argv[i + 1].Copy(Batch.m_ModelPath, sizeof(Batch.m_ModelPath));
+		argv[i + 2].Copy(Batch.m_SettingsPath, sizeof(Batch.m_SettingsPath));
+		argv[i + 3].Copy(Batch.m_OutputPath, sizeof(Batch.m_OutputPath));
+		Result = Valid;
+		i += 3;
+	}
+	//Shards don't write binary meta-data, it's only written once they're merged.
+	if (Batch.m_VerifyMeta && (Batch.m_Shard.isSharded() || Batch.m_Merge)) {
+		LogCritical("Error: --verify-meta can't be used with --shard or --merge.");
+		return Invalid;
+	}
+	return Result;
+}
+
+//App
 
 void App::UpdateJob(LWEJob &J, LWEJobThread &Th, LWEJobQueue &Q, uint64_t lCurrentTime) {
 	if (m_LastUpdateTime > lCurrentTime) m_LastUpdateTime = lCurrentTime;
@@ -24,7 +108,7 @@ void App::UpdateJob(LWEJob &J, LWEJobThread &Th, LWEJobQueue &Q, uint64_t lCurre
 	if (!F) return;
 	m_States[m_ActiveState]->Draw(*F, m_Renderer, m_Window, this);
 
-	m_UIManager->Draw(F->m_UIFrame, lCurrentTime);
+	if (!m_BatchMode) m_UIManager->Draw(F->m_UIFrame, lCurrentTime);
 	m_Renderer->EndFrame();
 	return;
 }
@@ -48,13 +132,61 @@ void App::RenderJob(LWEJob &J, LWEJobThread &Th, LWEJobQueue &Q, uint64_t lCurre
 	return;
 }
 
-void App::Run(void) {
+void App::BatchJob(LWEJob &J, LWEJobThread &Th, LWEJobQueue &Q, uint64_t lCurrentTime) {
+	if (m_LastInputTime > lCurrentTime) m_LastInputTime = lCurrentTime;
+	float dTime = LWTimer::ToSecond(lCurrentTime - m_LastInputTime);
+	m_LastInputTime = lCurrentTime;
+	State_Viewer *SV = GetState<State_Viewer>(State::Viewer);
+
+	m_Window->Update(lCurrentTime);
+	if (SV->isExporting()) {
+		SV->ProcessInput(dTime, m_Window, this, lCurrentTime);
+		return;
+	}
+	m_ExitCode = SV->GetExportResult() ? 0 : 1;
+	m_JobQueue.SetFinished(true);
+	return;
+}
+
+void App::ServeJob(LWEJob &J, LWEJobThread &Th, LWEJobQueue &Q, uint64_t lCurrentTime) {
+	if (m_LastInputTime > lCurrentTime) m_LastInputTime = lCurrentTime;
+	float dTime = LWTimer::ToSecond(lCurrentTime - m_LastInputTime);
+	m_LastInputTime = lCurrentTime;
+	State_Viewer *SV = GetState<State_Viewer>(State::Viewer);
+
+	m_Window->Update(lCurrentTime);
+	if (SV->isExporting()) {
+		SV->ProcessInput(dTime, m_Window, this, lCurrentTime);
+		return;
+	}
+	if (m_ActiveJob) {
+		m_Server->FinishJob(m_ActiveJob, SV->GetExportResult());
+		m_ActiveJob = nullptr;
+	}
+	if (m_Server->isFinished()) {
+		m_JobQueue.SetFinished(true);
+		return;
+	}
+	ServerJob *Job = m_Server->PopJob();
+	if (!Job) return;
+	Job->m_StartTime = LWTimer::GetCurrent();
+	bool Loaded = SV->LoadSettings(Job->m_SettingsPath, this) && SV->LoadCachedScene(Job->m_ModelPath, this, Job->m_SceneCached);
+	Job->m_LoadedTime = LWTimer::GetCurrent();
+	if (!Loaded || !SV->Export(Job->m_OutputPath, this)) {
+		m_Server->FinishJob(Job, false);
+		return;
+	}
+	m_ActiveJob = Job;
+	return;
+}
+
+int32_t App::Run(void) {
 	m_JobQueue.Start();
 	m_JobQueue.RunThread(&m_JobQueue.GetMainThread(), &m_JobQueue);
 	m_JobQueue.WaitForAllJoined();
 	//m_JobQueue.OutputJobTimings();
 	//m_JobQueue.OutputThreadTimings();
-	return;
+	return m_ExitCode;
 }
 
 void App::SetMessage(const LWUTF8Iterator &Message) {
@@ -90,7 +222,9 @@ bool App::LoadAssets(const LWUTF8Iterator &FilePath, const LWVideoMode &CurrMode
 	LWAllocator::Destroy(oUIManager);
 
 	m_Renderer->LoadAssets(m_AssetManager);
-	m_Renderer->ApplySettings(RenderSettings());
+	RenderSettings Settings;
+	Settings.m_TextureArrays = m_TextureArrays;
+	m_Renderer->ApplySettings(Settings);
 	return true;
 }
 
@@ -121,7 +255,11 @@ LWAllocator &App::GetAllocator(void) {
 	return m_Allocator;
 }
 
-App::App(LWAllocator &Allocator) : m_Allocator(Allocator) {
+bool App::isBatchMode(void) const {
+	return m_BatchMode;
+}
+
+App::App(LWAllocator &Allocator, const BatchExport *Batch) : m_Allocator(Allocator), m_BatchMode(Batch != nullptr), m_TextureArrays(Batch && Batch->m_TextureArrays) {
 	const char *DriverNames[] = LWVIDEODRIVER_NAMES;
 	const char *PlatformNames[] = LWPLATFORM_NAMES;
 	const char *ArchNames[] = LWARCH_NAMES;
@@ -129,33 +267,70 @@ App::App(LWAllocator &Allocator) : m_Allocator(Allocator) {
 	LWVideoMode CurrMode = LWVideoMode::GetActiveMode();
 	LWVector2i TargetSize = LWVector2i(1280, 720);
 
-	m_Window = m_Allocator.Create<LWWindow>("IsoSpriteGenerator", "ISG", m_Allocator, LWWindow::WindowedMode | LWWindow::KeyboardDevice | LWWindow::MouseDevice, CurrMode.GetSize() / 2 - TargetSize / 2, TargetSize);
+	//Batch exports use a window that's never shown, it only exists to own the video driver's context and sets the size sprites are laid out at.
+	uint32_t WindowFlags = m_BatchMode ? 0 : LWWindow::WindowedMode;
+	m_Window = m_Allocator.Create<LWWindow>("IsoSpriteGenerator", "ISG", m_Allocator, WindowFlags | LWWindow::KeyboardDevice | LWWindow::MouseDevice, CurrMode.GetSize() / 2 - TargetSize / 2, TargetSize);
 
 	uint32_t TargetDriver = LWVideoDriver::OpenGL4_5 | LWVideoDriver::DirectX11_1;
 	//TargetDriver |= LWVideoDriver::DebugLayer;
 	m_Driver = LWVideoDriver::MakeVideoDriver(m_Window, TargetDriver);
 	if (!m_Driver) {
 		LogCritical("Error: Could not create video driver.");
+		m_ExitCode = 1;
 		m_JobQueue.SetFinished(true);
 		return;
 	}
-	m_Window->SetTitle(LWUTF8I::Fmt<256>("IsoSpriteGenerator | {} | {} | {}", DriverNames[m_Driver->GetDriverID()], PlatformNames[LWPLATFORM_ID], ArchNames[LWARCH_ID]));
+	if (!m_BatchMode) m_Window->SetTitle(LWUTF8I::Fmt<256>("IsoSpriteGenerator | {} | {} | {}", DriverNames[m_Driver->GetDriverID()], PlatformNames[LWPLATFORM_ID], ArchNames[LWARCH_ID]));
 
 	m_Renderer = m_Allocator.Create<Renderer>(m_Driver, m_Allocator);
+	m_Renderer->SetOffscreen(m_BatchMode);
+	//Has to be set before anything is loaded so the software renderer sees every upload.
+	if (m_BatchMode && Batch->m_Software) m_Renderer->SetSoftware(true);
 
 	m_States[State::Viewer] = m_Allocator.Create<State_Viewer>(this, m_Allocator);
+	if (m_BatchMode) GetState<State_Viewer>(State::Viewer)->SetVerifyMeta(Batch->m_VerifyMeta);
 
 	if (!LoadAssets("App:UIData.xml", CurrMode)) {
+		m_ExitCode = 1;
 		m_JobQueue.SetFinished(true);
 		return;
 	}
 
+	if (m_BatchMode && Batch->m_Server) {
+		m_Server = m_Allocator.Create<ExportServer>(m_Allocator);
+		if (!m_Server->Start(Batch->m_ServerPort ? Batch->m_ServerPort : ExportServer::DefaultPort)) {
+			m_ExitCode = 1;
+			m_JobQueue.SetFinished(true);
+			return;
+		}
+		m_JobQueue.PushJob(LWEJob::MakeMethod(&App::UpdateJob, this, nullptr, 0, 0, 0, 0, 0, 0, ~0x1));
+		m_JobQueue.PushJob(LWEJob::MakeMethod(&App::ServeJob, this, nullptr, 0, 0, 0, 0, 0, 0, 0x1));
+		m_JobQueue.PushJob(LWEJob::MakeMethod(&App::RenderJob, this, nullptr, 0, 0, 0, 0, 0, 0, 0x1));
+		return;
+	}
+
+	if (m_BatchMode) {
+		//The ui is never drawn or given input, it only holds the settings loaded for the export.
+		State_Viewer *SV = GetState<State_Viewer>(State::Viewer);
+		if (!SV->LoadSettings(Batch->m_SettingsPath, this) || !SV->LoadScene(Batch->m_ModelPath, this) || !SV->Export(Batch->m_OutputPath, this, Batch->m_Shard)) {
+			m_ExitCode = 1;
+			m_JobQueue.SetFinished(true);
+			return;
+		}
+		m_JobQueue.PushJob(LWEJob::MakeMethod(&App::UpdateJob, this, nullptr, 0, 0, 0, 0, 0, 0, ~0x1));
+		m_JobQueue.PushJob(LWEJob::MakeMethod(&App::BatchJob, this, nullptr, 0, 0, 0, 0, 0, 0, 0x1));
+		m_JobQueue.PushJob(LWEJob::MakeMethod(&App::RenderJob, this, nullptr, 0, 0, 0, 0, 0, 0, 0x1));
+		return;
+	}
+
 	m_JobQueue.PushJob(LWEJob::MakeMethod(&App::UpdateJob, this, nullptr, 0, 0, 0, 0, 0, 0, ~0x1));
 	m_JobQueue.PushJob(LWEJob::MakeMethod(&App::InputJob, this, nullptr, 0, 0, 0, 0, 0, 0, 0x1));
 	m_JobQueue.PushJob(LWEJob::MakeMethod(&App::RenderJob, this, nullptr, 0, 0, 0, 0, 0, 0, 0x1));
 }
 
 App::~App() {
+	if (m_ActiveJob) m_Server->FinishJob(m_ActiveJob, false);
+	LWAllocator::Destroy(m_Server);
 	LWAllocator::Destroy((State_Viewer*)m_States[State::Viewer]);
 	LWAllocator::Destroy(m_UIManager);
 	LWAllocator::Destroy(m_AssetManager);
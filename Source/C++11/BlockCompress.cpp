@@ -0,0 +1,306 @@
+#include "BlockCompress.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+const char8_t *BlockCompress::FormatNames[BlockCompress::FormatCount] = { "BC4", "BC5", "BC7" };
+
+//BC4 helpers.
+static void BC4Palette(uint8_t R0, uint8_t R1, uint8_t *Palette) {
+	Palette[0] = R0;
+	Palette[1] = R1;
+	if (R0 > R1) {
+		for (uint32_t i = 2; i < 8; i++) Palette[i] = (uint8_t)(((8 - i) * R0 + (i - 1) * R1 + 3) / 7);
+	} else {
+		for (uint32_t i = 2; i < 6; i++) Palette[i] = (uint8_t)(((6 - i) * R0 + (i - 1) * R1 + 2) / 5);
+		Palette[6] = 0;
+		Palette[7] = 255;
+	}
+	return;
+}
+
+static uint32_t BC4Fit(const uint8_t *Values, uint8_t R0, uint8_t R1, uint8_t *Indices) {
+	uint8_t Palette[8];
+	uint32_t Error = 0;
+	BC4Palette(R0, R1, Palette);
+	for (uint32_t i = 0; i < 16; i++) {
+		uint32_t BestErr = 0xFFFFFFFF;
+		for (uint32_t p = 0; p < 8; p++) {
+			int32_t d = (int32_t)Values[i] - (int32_t)Palette[p];
+			uint32_t Err = (uint32_t)(d * d);
+			if (Err >= BestErr) continue;
+			BestErr = Err;
+			Indices[i] = (uint8_t)p;
+		}
+		Error += BestErr;
+	}
+	return Error;
+}
+
+static void BC4Write(uint8_t R0, uint8_t R1, const uint8_t *Indices, uint8_t *Out) {
+	uint64_t Bits = 0;
+	for (uint32_t i = 0; i < 16; i++) Bits |= (uint64_t)Indices[i] << (3 * i);
+	Out[0] = R0;
+	Out[1] = R1;
+	for (uint32_t i = 0; i < 6; i++) Out[2 + i] = (uint8_t)(Bits >> (8 * i));
+	return;
+}
+
+//BC7 helpers.
+static const int32_t BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct BC7Endpoints {
+	int32_t m_Values[2][4]; //7 bit endpoint components.
+	uint32_t m_PBits[2];
+};
+
+static uint32_t BC7Fit(const uint8_t *Texels, const BC7Endpoints &EP, uint8_t *Indices) {
+	int32_t Palette[16][4];
+	uint32_t Error = 0;
+	for (uint32_t c = 0; c < 4; c++) {
+		int32_t C0 = (EP.m_Values[0][c] << 1) | (int32_t)EP.m_PBits[0];
+		int32_t C1 = (EP.m_Values[1][c] << 1) | (int32_t)EP.m_PBits[1];
+		for (uint32_t i = 0; i < 16; i++) Palette[i][c] = ((64 - BC7Weights[i]) * C0 + BC7Weights[i] * C1 + 32) >> 6;
+	}
+	for (uint32_t i = 0; i < 16; i++) {
+		const uint8_t *T = Texels + i * 4;
+		uint32_t BestErr = 0xFFFFFFFF;
+		for (uint32_t p = 0; p < 16; p++) {
+			int32_t r = T[0] - Palette[p][0];
+			int32_t g = T[1] - Palette[p][1];
+			int32_t b = T[2] - Palette[p][2];
+			int32_t a = T[3] - Palette[p][3];
+			uint32_t Err = (uint32_t)(r * r + g * g + b * b + a * a);
+			if (Err >= BestErr) continue;
+			BestErr = Err;
+			Indices[i] = (uint8_t)p;
+		}
+		Error += BestErr;
+	}
+	return Error;
+}
+
+//Quantizes the floating point endpoints to 7 bits with each p-bit combination, keeping the combination with the lowest error.
+static void BC7Quantize(const float *Lo, const float *Hi, const uint8_t *Texels, BC7Endpoints &Best, uint8_t *BestIndices, uint32_t &BestErr) {
+	BC7Endpoints EP;
+	uint8_t Indices[16];
+	for (uint32_t p = 0; p < 4; p++) {
+		EP.m_PBits[0] = p & 1;
+		EP.m_PBits[1] = p >> 1;
+		for (uint32_t c = 0; c < 4; c++) {
+			EP.m_Values[0][c] = std::min<int32_t>(std::max<int32_t>((int32_t)floorf((Lo[c] - (float)EP.m_PBits[0]) * 0.5f + 0.5f), 0), 127);
+			EP.m_Values[1][c] = std::min<int32_t>(std::max<int32_t>((int32_t)floorf((Hi[c] - (float)EP.m_PBits[1]) * 0.5f + 0.5f), 0), 127);
+		}
+		uint32_t Err = BC7Fit(Texels, EP, Indices);
+		if (Err >= BestErr) continue;
+		BestErr = Err;
+		Best = EP;
+		std::memcpy(BestIndices, Indices, 16);
+	}
+	return;
+}
+
+static void BC7Write(BC7Endpoints EP, uint8_t *Indices, uint8_t *Out) {
+	uint64_t Bits[2] = { 0, 0 };
+	uint32_t Pos = 0;
+	auto Put = [&Bits, &Pos](uint32_t Value, uint32_t Count) {
+		for (uint32_t i = 0; i < Count; i++, Pos++) {
+			if ((Value >> i) & 1) Bits[Pos >> 6] |= 1ull << (Pos & 63);
+		}
+	};
+	//The anchor index is stored with it's high bit implied as 0, so flip the endpoints if it's set.
+	if (Indices[0] & 0x8) {
+		std::swap(EP.m_Values[0], EP.m_Values[1]);
+		std::swap(EP.m_PBits[0], EP.m_PBits[1]);
+		for (uint32_t i = 0; i < 16; i++) Indices[i] = 15 - Indices[i];
+	}
+	Put(1 << 6, 7);
+	for (uint32_t c = 0; c < 4; c++) {
+		Put((uint32_t)EP.m_Values[0][c], 7);
+		Put((uint32_t)EP.m_Values[1][c], 7);
+	}
+	Put(EP.m_PBits[0], 1);
+	Put(EP.m_PBits[1], 1);
+	Put(Indices[0], 3);
+	for (uint32_t i = 1; i < 16; i++) Put(Indices[i], 4);
+	for (uint32_t i = 0; i < 8; i++) {
+		Out[i] = (uint8_t)(Bits[0] >> (8 * i));
+		Out[i + 8] = (uint8_t)(Bits[1] >> (8 * i));
+	}
+	return;
+}
+
+//BlockCompress
+uint32_t BlockCompress::GetBlockSize(uint32_t Format) {
+	return Format == BC4 ? 8 : 16;
+}
+
+void BlockCompress::EncodeBC4Block(const uint8_t *Values, uint8_t *Out, uint32_t Quality) {
+	uint8_t Min = 255, Max = 0;
+	uint8_t InnerMin = 255, InnerMax = 0;
+	for (uint32_t i = 0; i < 16; i++) {
+		Min = std::min<uint8_t>(Min, Values[i]);
+		Max = std::max<uint8_t>(Max, Values[i]);
+		if (Values[i] == 0 || Values[i] == 255) continue;
+		InnerMin = std::min<uint8_t>(InnerMin, Values[i]);
+		InnerMax = std::max<uint8_t>(InnerMax, Values[i]);
+	}
+	uint8_t Indices[16], TestIndices[16];
+	uint8_t R0 = Max, R1 = Min;
+	uint32_t Error = BC4Fit(Values, R0, R1, Indices);
+	auto Test = [&](uint8_t T0, uint8_t T1) {
+		uint32_t Err = BC4Fit(Values, T0, T1, TestIndices);
+		if (Err >= Error) return;
+		Error = Err;
+		R0 = T0;
+		R1 = T1;
+		std::memcpy(Indices, TestIndices, sizeof(Indices));
+	};
+	if (Error && Quality != QualityFast) {
+		//6 value mode keeps explicit 0 and 255 entries, for blocks that mix the extremes with mid values.
+		if (InnerMin <= InnerMax) Test(InnerMin, InnerMax);
+		if (Quality == QualityBest) {
+			//Pull the 8 value endpoints inward so outliers don't waste the interpolated entries.
+			for (int32_t a = 0; a < 4 && Error; a++) {
+				for (int32_t b = 0; b < 4 && Error; b++) {
+					int32_t T0 = (int32_t)Max - a, T1 = (int32_t)Min + b;
+					if (T0 > T1) Test((uint8_t)T0, (uint8_t)T1);
+				}
+			}
+		}
+	}
+	BC4Write(R0, R1, Indices, Out);
+	return;
+}
+
+void BlockCompress::EncodeBC5Block(const uint8_t *Texels, uint32_t ChannelA, uint32_t ChannelB, uint8_t *Out, uint32_t Quality) {
+	uint8_t ValuesA[16], ValuesB[16];
+	for (uint32_t i = 0; i < 16; i++) {
+		ValuesA[i] = Texels[i * 4 + ChannelA];
+		ValuesB[i] = Texels[i * 4 + ChannelB];
+	}
+	EncodeBC4Block(ValuesA, Out, Quality);
+	EncodeBC4Block(ValuesB, Out + 8, Quality);
+	return;
+}
+
+void BlockCompress::EncodeBC7Block(const uint8_t *Texels, uint8_t *Out, uint32_t Quality) {
+	const uint32_t PowerIterations = 8;
+	const uint32_t RefineIterations = 2;
+	float Lo[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+	float Hi[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (uint32_t i = 0; i < 16; i++) {
+		for (uint32_t c = 0; c < 4; c++) {
+			Lo[c] = std::min<float>(Lo[c], Texels[i * 4 + c]);
+			Hi[c] = std::max<float>(Hi[c], Texels[i * 4 + c]);
+		}
+	}
+	bool isConstant = Lo[0] == Hi[0] && Lo[1] == Hi[1] && Lo[2] == Hi[2] && Lo[3] == Hi[3];
+	if (!isConstant && Quality != QualityFast) {
+		//Fit endpoints along the principal axis of the block instead of the bounding box diagonal.
+		float Mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float Cov[4][4] = {};
+		for (uint32_t i = 0; i < 16; i++) {
+			for (uint32_t c = 0; c < 4; c++) Mean[c] += Texels[i * 4 + c] * (1.0f / 16.0f);
+		}
+		for (uint32_t i = 0; i < 16; i++) {
+			float d[4];
+			for (uint32_t c = 0; c < 4; c++) d[c] = Texels[i * 4 + c] - Mean[c];
+			for (uint32_t a = 0; a < 4; a++) {
+				for (uint32_t b = 0; b < 4; b++) Cov[a][b] += d[a] * d[b];
+			}
+		}
+		float Axis[4] = { Hi[0] - Lo[0], Hi[1] - Lo[1], Hi[2] - Lo[2], Hi[3] - Lo[3] };
+		for (uint32_t n = 0; n < PowerIterations; n++) {
+			float Next[4];
+			float Largest = 0.0f;
+			for (uint32_t a = 0; a < 4; a++) {
+				Next[a] = Cov[a][0] * Axis[0] + Cov[a][1] * Axis[1] + Cov[a][2] * Axis[2] + Cov[a][3] * Axis[3];
+				Largest = std::max<float>(Largest, fabsf(Next[a]));
+			}
+			if (Largest <= 0.0f) break;
+			for (uint32_t a = 0; a < 4; a++) Axis[a] = Next[a] / Largest;
+		}
+		float AxisLenSq = Axis[0] * Axis[0] + Axis[1] * Axis[1] + Axis[2] * Axis[2] + Axis[3] * Axis[3];
+		if (AxisLenSq > 0.0f) {
+			float MinT = 0.0f, MaxT = 0.0f;
+			for (uint32_t i = 0; i < 16; i++) {
+				float t = 0.0f;
+				for (uint32_t c = 0; c < 4; c++) t += (Texels[i * 4 + c] - Mean[c]) * Axis[c];
+				t /= AxisLenSq;
+				MinT = std::min<float>(MinT, t);
+				MaxT = std::max<float>(MaxT, t);
+			}
+			for (uint32_t c = 0; c < 4; c++) {
+				Lo[c] = std::min<float>(std::max<float>(Mean[c] + Axis[c] * MinT, 0.0f), 255.0f);
+				Hi[c] = std::min<float>(std::max<float>(Mean[c] + Axis[c] * MaxT, 0.0f), 255.0f);
+			}
+		}
+	}
+	BC7Endpoints EP;
+	uint8_t Indices[16];
+	uint32_t Error = 0xFFFFFFFF;
+	BC7Quantize(Lo, Hi, Texels, EP, Indices, Error);
+	if (!isConstant && Quality == QualityBest) {
+		//Solve for the endpoints that best reproduce the texels with the current index selection.
+		for (uint32_t n = 0; n < RefineIterations && Error; n++) {
+			float AA = 0.0f, AB = 0.0f, BB = 0.0f;
+			float AX[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			float BX[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (uint32_t i = 0; i < 16; i++) {
+				float w = (float)BC7Weights[Indices[i]] / 64.0f;
+				float a = 1.0f - w;
+				AA += a * a;
+				AB += a * w;
+				BB += w * w;
+				for (uint32_t c = 0; c < 4; c++) {
+					AX[c] += a * Texels[i * 4 + c];
+					BX[c] += w * Texels[i * 4 + c];
+				}
+			}
+			float Det = AA * BB - AB * AB;
+			if (fabsf(Det) < 1e-6f) break;
+			float iDet = 1.0f / Det;
+			for (uint32_t c = 0; c < 4; c++) {
+				Lo[c] = std::min<float>(std::max<float>((BB * AX[c] - AB * BX[c]) * iDet, 0.0f), 255.0f);
+				Hi[c] = std::min<float>(std::max<float>((AA * BX[c] - AB * AX[c]) * iDet, 0.0f), 255.0f);
+			}
+			uint32_t PrevError = Error;
+			BC7Quantize(Lo, Hi, Texels, EP, Indices, Error);
+			if (Error >= PrevError) break;
+		}
+	}
+	BC7Write(EP, Indices, Out);
+	return;
+}
+
+void BlockCompress::CompressRows(const uint8_t *Rows, uint32_t Width, uint32_t Height, uint32_t Format, uint32_t ChannelA, uint32_t ChannelB, uint32_t Quality, uint8_t *Out, uint32_t ThreadCount) {
+	uint32_t BlocksX = Width / 4;
+	uint32_t BlocksY = Height / 4;
+	uint32_t BlockSize = GetBlockSize(Format);
+	//Sheets hand over one band at a time, so the threads are kept alive between calls.
+	static WorkerPool Pool;
+	if (!ThreadCount) ThreadCount = Pool.GetThreadCount();
+	uint32_t SpanCount = std::max<uint32_t>(std::min<uint32_t>(std::min<uint32_t>(ThreadCount, Pool.GetThreadCount()), BlocksY), 1);
+	//Each job encodes one contiguous span of block rows.
+	auto Span = [&](uint32_t Job, uint32_t) {
+		uint8_t Texels[64];
+		uint8_t Values[16];
+		uint32_t ByEnd = (uint32_t)((uint64_t)BlocksY * (Job + 1) / SpanCount);
+		for (uint32_t by = (uint32_t)((uint64_t)BlocksY * Job / SpanCount); by < ByEnd; by++) {
+			uint8_t *BlockOut = Out + (size_t)by * BlocksX * BlockSize;
+			for (uint32_t bx = 0; bx < BlocksX; bx++, BlockOut += BlockSize) {
+				for (uint32_t y = 0; y < 4; y++) std::memcpy(Texels + y * 16, Rows + ((size_t)(by * 4 + y) * Width + bx * 4) * 4, 16);
+				if (Format == BC7) EncodeBC7Block(Texels, BlockOut, Quality);
+				else if (Format == BC5) EncodeBC5Block(Texels, ChannelA, ChannelB, BlockOut, Quality);
+				else {
+					for (uint32_t i = 0; i < 16; i++) Values[i] = Texels[i * 4 + ChannelA];
+					EncodeBC4Block(Values, BlockOut, Quality);
+				}
+			}
+		}
+	};
+	Pool.Run(SpanCount, Span);
+	return;
+}
\ No newline at end of file
@@ -176,7 +176,21 @@ uint32_t Camera::GetPassesForConeInCamerasf(uint32_t CameraCnt, const LWSVector4
 	return GetPassesForConeInCameras(CamList, CameraCnt, Position, Direction, Length, Theta);
 }
 
-uint32_t Camera::MakeCascadeCameraViews(const LWSVector4f &LightDir, const LWSVector4f &ViewPosition, const LWSVector4f *ViewFrustumPoints, const LWSMatrix4f &ProjViewMatrix, Camera *CamBuffer, uint32_t CascadeCnt, const LWSVector4f &SceneAABBMin, const LWSVector4f &SceneAABBMax) {
+uint32_t Camera::MakeCascadeCameraViews(const LWSVector4f &LightDir, const LWSVector4f &ViewPosition, const LWSVector4f *ViewFrustumPoints, Camera *CamBuffer, uint32_t CascadeCnt, const LWSVector4f &SceneAABBMin, const LWSVector4f &SceneAABBMax, uint32_t ShadowMapSize) {
+	const float SplitLambda = 0.5f; //Blend between logarithmic(1) and uniform(0) cascade splits.
+	const float SnapSteps = 8.0f; //Extents are rounded up to 1/8th of the power of two below them.
+	//Rounds the extent up to a step, and moves it onto a grid of it's own texels, so small changes to the bounds between frames leave the texels where they were.
+	auto SnapExtent = [ShadowMapSize, SnapSteps](float &Min, float &Max) {
+		float Size = Max - Min;
+		if (!ShadowMapSize || Size <= std::numeric_limits<float>::epsilon()) return;
+		float Step = exp2f(floorf(log2f(Size))) / SnapSteps;
+		//The extra step covers what's lost by moving Min down onto the grid.
+		float Extent = ceilf(Size / Step) * Step + Step;
+		float Texel = Extent / (float)ShadowMapSize;
+		Min = floorf(Min / Texel) * Texel;
+		Max = Min + Extent;
+		return;
+	};
 	LWSVector4f U = LWSVector4f(0.0f, 1.0f, 0.0f, 0.0f);
 	if (fabs(U.Dot3(LightDir)) >= 1.0f - std::numeric_limits<float>::epsilon()) U = LWSVector4f(0.0f, 0.0f, 1.0f, 0.0f);
 	LWSVector4f R = LightDir.Cross3(U).Normalize3();
@@ -205,12 +219,7 @@ uint32_t Camera::MakeCascadeCameraViews(const LWSVector4f &LightDir, const LWSVe
 
 	//Max of 4 cascades.
 	CascadeCnt = std::min<uint32_t>(CascadeCnt, 4);
-	float Far = ViewFrustumPoints[1].w;
-	float MinDistance = std::min<float>(200.0f * 3.0f, Far * 0.6f);
-	//Manually adjusted cascaded distances, depending on CasecadeCnt, and minimum distance
-	float SDistances[5] = { 0.0f, (MinDistance * 0.33f) / Far, MinDistance / Far, 0.6f, 1.0f };
-	SDistances[CascadeCnt] = 1.0f;
-	
+
 	LWSVector4f AABBPnts[8] = { SceneAABBMin,
 								SceneAABBMin.BAAA(SceneAABBMax),
 								SceneAABBMin.AABA(SceneAABBMax),
@@ -219,7 +228,43 @@ uint32_t Camera::MakeCascadeCameraViews(const LWSVector4f &LightDir, const LWSVe
 								SceneAABBMin.BBAA(SceneAABBMax),
 								SceneAABBMin.ABBA(SceneAABBMax),
 								SceneAABBMax };
-	for (uint32_t i = 0; i < 8; i++) AABBPnts[i] = AABBPnts[i] * ProjViewMatrix;
+
+	//Only the part of the view frustum that contains the scene is split, measured along the view's forward axis.
+	LWSVector4f Fwrd = NX.Cross3(NY).Normalize3();
+	if (Fwrd.Dot3(TL) < 0.0f) Fwrd = -Fwrd;
+	float NearDepth = Fwrd.Dot3(NTL);
+	float FarDepth = Fwrd.Dot3(FTL);
+	float SceneNear = FarDepth;
+	float SceneFar = NearDepth;
+	//Scene bounds in light space, every caster and receiver is inside them so they bound each cascade.
+	LWSVector4f SceneMin = LWSVector4f(std::numeric_limits<float>::max());
+	LWSVector4f SceneMax = LWSVector4f(-std::numeric_limits<float>::max());
+	for (uint32_t i = 0; i < 8; i++) {
+		float d = Fwrd.Dot3(AABBPnts[i] - ViewPosition);
+		SceneNear = std::min<float>(SceneNear, d);
+		SceneFar = std::max<float>(SceneFar, d);
+		LWSVector4f Pnt = LWSVector4f(R.Dot3(AABBPnts[i]), U.Dot3(AABBPnts[i]), LightDir.Dot3(AABBPnts[i]), 1.0f);
+		SceneMin = SceneMin.Min(Pnt);
+		SceneMax = SceneMax.Max(Pnt);
+	}
+	LWSVector4f Pad = (SceneMax - SceneMin) * 0.01f + LWSVector4f(0.001f);
+	SceneMin = SceneMin - Pad;
+	SceneMax = SceneMax + Pad;
+	float DepthRange = FarDepth - NearDepth;
+	SceneNear = std::max<float>(SceneNear, NearDepth);
+	SceneFar = std::min<float>(SceneFar, FarDepth);
+	if (SceneFar <= SceneNear || DepthRange <= std::numeric_limits<float>::epsilon()) {
+		SceneNear = NearDepth;
+		SceneFar = FarDepth;
+	}
+	float SDistances[5];
+	for (uint32_t i = 0; i <= CascadeCnt; i++) {
+		float f = (float)i / (float)CascadeCnt;
+		float d = SceneNear + (SceneFar - SceneNear) * f;
+		if (SceneNear > 0.0f) d = SplitLambda * SceneNear * powf(SceneFar / SceneNear, f) + (1.0f - SplitLambda) * d;
+		SDistances[i] = DepthRange > std::numeric_limits<float>::epsilon() ? (d - NearDepth) / DepthRange : f;
+	}
+
 	for (uint32_t i = 0; i < CascadeCnt; i++) {
 		float iL = SDistances[i];
 		float nL = SDistances[i + 1];
@@ -234,22 +279,27 @@ uint32_t Camera::MakeCascadeCameraViews(const LWSVector4f &LightDir, const LWSVe
 		P[6] = NBL + nL * BL;
 		P[7] = NBR + nL * BR;
 
-		LWSVector4f Min = LWSVector4f();
-		LWSVector4f Max = LWSVector4f();
-		for (uint32_t n = 1; n < 8; n++) {
-			LWSVector4f C = P[n] - P[0];
+		LWSVector4f Min = LWSVector4f(std::numeric_limits<float>::max());
+		LWSVector4f Max = LWSVector4f(-std::numeric_limits<float>::max());
+		for (uint32_t n = 0; n < 8; n++) {
+			LWSVector4f C = P[n] + ViewPosition;
 			LWSVector4f Pnt = LWSVector4f(R.Dot3(C), U.Dot3(C), LightDir.Dot3(C), 1.0f);
 			Min = Min.Min(Pnt);
 			Max = Max.Max(Pnt);
 		}
-		for (uint32_t i = 0; i < 8; i++) {
-			LWSVector4f z = LWSVector4f(LightDir.Dot3(AABBPnts[i]));
-			Min = Min.Min(Min.AABA(z));
+		//Clip the slice to the scene, and cover the scene's full depth so casters between the slice and the light aren't clipped.
+		LWVector4f vMin = Min.Max(SceneMin).AsVec4();
+		LWVector4f vMax = Max.Min(SceneMax).AsVec4();
+		LWVector4f sMin = SceneMin.AsVec4();
+		LWVector4f sMax = SceneMax.AsVec4();
+		if (vMin.x >= vMax.x || vMin.y >= vMax.y) {
+			vMin = sMin;
+			vMax = sMax;
 		}
-		LWVector4f vMin = Min.AsVec4();
-		LWVector4f vMax = Max.AsVec4();
-		P[0] += ViewPosition + LightDir * vMin.z;
-		CamBuffer[i] = Camera(P[0].AAAB(LWSVector4f(1.0f)), LightDir, U, vMin.x, vMax.x, vMin.y, vMax.y, 0.0f, (vMax.z - vMin.z), ShadowCaster);
+		SnapExtent(vMin.x, vMax.x);
+		SnapExtent(vMin.y, vMax.y);
+		LWSVector4f Pos = LightDir * sMin.z;
+		CamBuffer[i] = Camera(Pos.AAAB(LWSVector4f(1.0f)), LightDir, U, vMin.x, vMax.x, vMin.y, vMax.y, 0.0f, (sMax.z - sMin.z), ShadowCaster);
 		CamBuffer[i].BuildFrustrum();
 	}
 	return CascadeCnt;
@@ -0,0 +1,176 @@
+#include "ExportServer.h"
+#include <LWCore/LWAllocator.h>
+#include <LWCore/LWUnicode.h>
+#include <LWCore/LWTimer.h>
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+//Splits Line in place at each tab, returns the number of fields written to Fields.
+static uint32_t SplitFields(char *Line, char **Fields, uint32_t MaxFields) {
+	uint32_t Count = 0;
+	for (char *C = Line; Count < MaxFields; C++) {
+		Fields[Count++] = C;
+		C = strchr(C, '\t');
+		if (!C) break;
+		*C = '\0';
+	}
+	return Count;
+}
+
+//ExportServer
+bool ExportServer::Start(uint16_t Port) {
+	if (LWSocket::CreateSocket(m_Listener, Port, LWSocket::Tcp | LWSocket::Listen | LWSocket::ReuseAddr, 0)) {
+		LogCritical(LWUTF8I::Fmt<128>("Error: Could not listen for export jobs on port {}.", Port));
+		return false;
+	}
+	m_Thread = std::thread(&ExportServer::ListenThread, this);
+	LogEvent(LWUTF8I::Fmt<128>("Export server listening on port {}.", Port));
+	return true;
+}
+
+ServerJob *ExportServer::PopJob(void) {
+	std::lock_guard<std::mutex> Lock(m_QueueLock);
+	if (m_Queue.empty()) return nullptr;
+	ServerJob *Job = m_Queue.front();
+	m_Queue.pop_front();
+	return Job;
+}
+
+void ExportServer::FinishJob(ServerJob *Job, bool Result) {
+	char Buffer[256];
+	uint64_t Current = LWTimer::GetCurrent();
+	uint64_t StartTime = Job->m_StartTime ? Job->m_StartTime : Current;
+	uint64_t LoadedTime = Job->m_LoadedTime ? Job->m_LoadedTime : Current;
+	uint64_t QueueMS = LWTimer::ToMilliSecond(StartTime - Job->m_QueuedTime);
+	uint64_t LoadMS = LWTimer::ToMilliSecond(LoadedTime - StartTime);
+	uint64_t ExportMS = LWTimer::ToMilliSecond(Current - LoadedTime);
+	uint64_t TotalMS = LWTimer::ToMilliSecond(Current - Job->m_QueuedTime);
+	snprintf(Buffer, sizeof(Buffer), "done %u %s queue=%llu load=%llu export=%llu total=%llu cached=%d\n", Job->m_ID, Result ? "ok" : "failed", (unsigned long long)QueueMS, (unsigned long long)LoadMS, (unsigned long long)ExportMS, (unsigned long long)TotalMS, Job->m_SceneCached ? 1 : 0);
+	LogEvent(LWUTF8I::Fmt<512>("Job {} '{}': {}", Job->m_ID, Job->m_OutputPath, Buffer));
+	Reply(Job->m_Client, Buffer);
+	Job->m_Client.Close();
+	LWAllocator::Destroy(Job);
+	return;
+}
+
+bool ExportServer::isFinished(void) {
+	if (!m_Quit) return false;
+	std::lock_guard<std::mutex> Lock(m_QueueLock);
+	return m_Queue.empty();
+}
+
+void ExportServer::ListenThread(void) {
+	while (!m_Quit) {
+		ServerJob *Job = m_Allocator.Create<ServerJob>();
+		if (m_Listener.Accept(Job->m_Client, 0)) {
+			LWAllocator::Destroy(Job);
+			//The listener is closed when the server is destroyed.
+			if (m_Quit) break;
+			continue;
+		}
+		//Jobs write to arbitrary paths, so nothing outside of this machine may submit them.
+		if ((Job->m_Client.GetRemoteIP() >> 24) != 127) {
+			Job->m_Client.Close();
+			LWAllocator::Destroy(Job);
+			continue;
+		}
+		std::lock_guard<std::mutex> Lock(m_QueueLock);
+		if (m_Quit || m_ReaderCount >= MaxReadingClients) {
+			if (!m_Quit) Reply(Job->m_Client, "error busy\n");
+			Job->m_Client.Close();
+			LWAllocator::Destroy(Job);
+			continue;
+		}
+		//Requests are read off this thread, so a client that never finishes it's line only stalls it's own reader.
+		m_Reading.push_back(Job);
+		m_ReaderCount++;
+		std::thread(&ExportServer::ReadThread, this, Job).detach();
+	}
+	return;
+}
+
+void ExportServer::ReadThread(ServerJob *Job) {
+	char Line[MaxLineLength];
+	char *Fields[4];
+	const char *Response = nullptr;
+	bool isQuit = false;
+	uint32_t FieldCount = ReadLine(Job->m_Client, Line, sizeof(Line)) ? SplitFields(Line, Fields, 4) : 0;
+	if (!FieldCount) Response = "error malformed request\n";
+	else if (FieldCount == 1 && !strcmp(Fields[0], "quit")) {
+		isQuit = true;
+		Response = "ok quit\n";
+	} else if (FieldCount != 4 || strcmp(Fields[0], "export")) Response = "error expected export<tab><Model><tab><Settings><tab><Output>\n";
+	else {
+		LWUTF8Iterator(Fields[1]).Copy(Job->m_ModelPath, sizeof(Job->m_ModelPath));
+		LWUTF8Iterator(Fields[2]).Copy(Job->m_SettingsPath, sizeof(Job->m_SettingsPath));
+		LWUTF8Iterator(Fields[3]).Copy(Job->m_OutputPath, sizeof(Job->m_OutputPath));
+		Job->m_QueuedTime = LWTimer::GetCurrent();
+	}
+	{
+		std::lock_guard<std::mutex> Lock(m_QueueLock);
+		m_Reading.erase(std::find(m_Reading.begin(), m_Reading.end(), Job));
+		if (isQuit) {
+			m_Quit = true;
+			//Wakes the listen thread so no further connections are accepted.
+			m_Listener.Close();
+		} else if (!Response) {
+			if (m_Quit) Response = "error server is quitting\n";
+			else {
+				Job->m_ID = m_NextJobID++;
+				m_Queue.push_back(Job);
+			}
+		}
+	}
+	if (Response) {
+		Reply(Job->m_Client, Response);
+		Job->m_Client.Close();
+		LWAllocator::Destroy(Job);
+	}
+	std::unique_lock<std::mutex> Lock(m_QueueLock);
+	m_ReaderCount--;
+	//Notified once this thread is fully gone, so the destructor can't release the server while a reader is still unwinding.
+	std::notify_all_at_thread_exit(m_ReadersDone, std::move(Lock));
+	return;
+}
+
+bool ExportServer::ReadLine(LWSocket &Client, char *Buffer, uint32_t BufferLen) {
+	uint32_t Len = 0;
+	while (Len + 1 < BufferLen) {
+		int32_t Res = Client.Receive(Buffer + Len, BufferLen - 1 - Len);
+		if (Res <= 0) return false;
+		char *End = (char*)memchr(Buffer + Len, '\n', (uint32_t)Res);
+		Len += (uint32_t)Res;
+		if (!End) continue;
+		if (End > Buffer && *(End - 1) == '\r') End--;
+		*End = '\0';
+		return true;
+	}
+	return false;
+}
+
+void ExportServer::Reply(LWSocket &Client, const char *Text) {
+	Client.Send(Text, (uint32_t)strlen(Text));
+	return;
+}
+
+ExportServer::ExportServer(LWAllocator &Allocator) : m_Allocator(Allocator) {}
+
+ExportServer::~ExportServer() {
+	m_Quit = true;
+	{
+		std::lock_guard<std::mutex> Lock(m_QueueLock);
+		m_Listener.Close();
+		for (auto &&Job : m_Reading) Job->m_Client.Close();
+	}
+	if (m_Thread.joinable()) m_Thread.join();
+	{
+		std::unique_lock<std::mutex> Lock(m_QueueLock);
+		m_ReadersDone.wait(Lock, [this]() { return !m_ReaderCount; });
+	}
+	for (auto &&Job : m_Queue) {
+		Job->m_Client.Close();
+		LWAllocator::Destroy(Job);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,326 @@
+#include "ExportShard.h"
+#include <LWCore/LWAllocator.h>
+#include <LWCore/LWVector.h>
+#include <LWPlatform/LWFileStream.h>
+#include <LWEJson.h>
+#include "State_Viewer.h"
+#include "Renderer.h"
+#include "SheetWriter.h"
+#include "SpriteMetaWriter.h"
+#include "JsonWriter.h"
+#include "Logger.h"
+#include <algorithm>
+#include <vector>
+#include <cstring>
+
+struct ShardSprite {
+	LWVector4i m_Rect; //x, y, width, height.
+	LWVector2f m_Offset;
+};
+
+//Meta-data written by a shard, the layout is for the full export and is the same for every shard.
+struct ShardMeta {
+	std::vector<ShardSprite> m_Sprites; //Frame major, the same order as the meta-data.
+	std::vector<float> m_FrameTimes;
+	float m_TotalTime = 0.0f;
+	float m_TimeOffset = 0.0f;
+	float m_RotationOffset = 0.0f;
+	uint32_t m_Index = 0;
+	uint32_t m_Count = 0;
+	uint32_t m_DirectionCnt = 0;
+	uint32_t m_Format = SheetWriter::FormatPNG;
+	uint32_t m_Quality = BlockCompress::QualityNormal;
+	uint32_t m_LayerMask = 0; //Bit for each render layer that was exported.
+	bool m_HasOffsets = false;
+	bool m_BinaryMeta = false;
+};
+
+static bool LoadShardMeta(const LWUTF8Iterator &Path, ShardMeta &Meta, LWAllocator &Allocator) {
+	LWEJson J = LWEJson(Allocator);
+	if (!LWEJson::LoadFile(J, Path, Allocator, nullptr)) {
+		LogCritical(LWUTF8I::Fmt<256>("Error: Could not load shard meta-data '{}'", Path));
+		return false;
+	}
+	LWEJObject *JShard = J.Find("Shard");
+	LWEJObject *JFrames = J.Find("Frames");
+	LWEJObject *JTotalTime = J.Find("TotalTime");
+	LWEJObject *JTimeOffset = J.Find("TimeOffset");
+	LWEJObject *JRotationOffset = J.Find("RotationOffset");
+	if (!JShard || !JFrames || !JTotalTime || !JTimeOffset || !JRotationOffset) {
+		LogCritical(LWUTF8I::Fmt<256>("Error: '{}' is not shard meta-data.", Path));
+		return false;
+	}
+	LWEJObject *JIndex = JShard->FindChild("Index", J);
+	LWEJObject *JCount = JShard->FindChild("Count", J);
+	LWEJObject *JDirections = JShard->FindChild("Directions", J);
+	LWEJObject *JFormat = JShard->FindChild("Format", J);
+	LWEJObject *JQuality = JShard->FindChild("Quality", J);
+	LWEJObject *JOffsets = JShard->FindChild("Offsets", J);
+	LWEJObject *JBinaryMeta = JShard->FindChild("BinaryMeta", J);
+	if (!JIndex || !JCount || !JDirections || !JFormat || !JQuality || !JOffsets || !JBinaryMeta) {
+		LogCritical(LWUTF8I::Fmt<256>("Error: '{}' is missing shard settings.", Path));
+		return false;
+	}
+	Meta.m_Index = (uint32_t)JIndex->AsInt();
+	Meta.m_Count = (uint32_t)JCount->AsInt();
+	Meta.m_DirectionCnt = (uint32_t)JDirections->AsInt();
+	Meta.m_Format = std::min<uint32_t>((uint32_t)JFormat->AsInt(), SheetWriter::FormatCount - 1);
+	Meta.m_Quality = std::min<uint32_t>((uint32_t)JQuality->AsInt(), BlockCompress::QualityCount - 1);
+	Meta.m_HasOffsets = JOffsets->AsBoolean();
+	Meta.m_BinaryMeta = JBinaryMeta->AsBoolean();
+	Meta.m_TotalTime = JTotalTime->AsFloat();
+	Meta.m_TimeOffset = JTimeOffset->AsFloat();
+	Meta.m_RotationOffset = JRotationOffset->AsFloat();
+	Meta.m_LayerMask = 0;
+	for (uint32_t i = 0; i < RenderCount; i++) {
+		if (J.Find(State_Viewer::RenderImageNames[i])) Meta.m_LayerMask |= (1 << i);
+	}
+	Meta.m_FrameTimes.clear();
+	Meta.m_Sprites.clear();
+	for (uint32_t i = 0; i < JFrames->m_Length; i++) {
+		LWEJObject *JFrame = JFrames->GetChild(i, J);
+		LWEJObject *JTime = JFrame->FindChild("Time", J);
+		LWEJObject *JSprites = JFrame->FindChild("Sprites", J);
+		if (!JTime || !JSprites || JSprites->m_Length != Meta.m_DirectionCnt) {
+			LogCritical(LWUTF8I::Fmt<256>("Error: Frame {} of '{}' is malformed.", i, Path));
+			return false;
+		}
+		Meta.m_FrameTimes.push_back(JTime->AsFloat());
+		for (uint32_t n = 0; n < JSprites->m_Length; n++) {
+			LWEJObject *JSprite = JSprites->GetChild(n, J);
+			LWEJObject *JX = JSprite->FindChild("x", J);
+			LWEJObject *JY = JSprite->FindChild("y", J);
+			LWEJObject *JWidth = JSprite->FindChild("width", J);
+			LWEJObject *JHeight = JSprite->FindChild("height", J);
+			LWEJObject *JXOffset = JSprite->FindChild("xOffset", J);
+			LWEJObject *JYOffset = JSprite->FindChild("yOffset", J);
+			if (!JX || !JY || !JWidth || !JHeight || (Meta.m_HasOffsets && (!JXOffset || !JYOffset))) {
+				LogCritical(LWUTF8I::Fmt<256>("Error: Sprite {} of frame {} in '{}' is malformed.", n, i, Path));
+				return false;
+			}
+			ShardSprite S;
+			S.m_Rect = LWVector4i(JX->AsInt(), JY->AsInt(), JWidth->AsInt(), JHeight->AsInt());
+			S.m_Offset = Meta.m_HasOffsets ? LWVector2f(JXOffset->AsFloat(), JYOffset->AsFloat()) : LWVector2f();
+			Meta.m_Sprites.push_back(S);
+		}
+	}
+	return true;
+}
+
+//Returns true if both shards were exported with the same layout and settings.
+static bool isSameLayout(const ShardMeta &A, const ShardMeta &B) {
+	if (A.m_Count != B.m_Count || A.m_DirectionCnt != B.m_DirectionCnt || A.m_Format != B.m_Format || A.m_Quality != B.m_Quality) return false;
+	if (A.m_LayerMask != B.m_LayerMask || A.m_HasOffsets != B.m_HasOffsets || A.m_BinaryMeta != B.m_BinaryMeta) return false;
+	if (A.m_TotalTime != B.m_TotalTime || A.m_TimeOffset != B.m_TimeOffset || A.m_RotationOffset != B.m_RotationOffset) return false;
+	if (A.m_FrameTimes != B.m_FrameTimes || A.m_Sprites.size() != B.m_Sprites.size()) return false;
+	for (uint32_t i = 0; i < (uint32_t)A.m_Sprites.size(); i++) {
+		const ShardSprite &SA = A.m_Sprites[i];
+		const ShardSprite &SB = B.m_Sprites[i];
+		if (SA.m_Rect != SB.m_Rect || SA.m_Offset != SB.m_Offset) return false;
+	}
+	return true;
+}
+
+//Copies the rows of Shard's sprites that fall within the band of RowCount rows starting at row y.
+static void CopyShardSprites(const ExportShard &Shard, const ShardMeta &Layout, const uint8_t *Src, uint8_t *Dst, uint32_t y, uint32_t RowCount, const LWVector2i &Size) {
+	uint32_t DirectionCnt = Layout.m_DirectionCnt;
+	uint32_t FrameCnt = (uint32_t)Layout.m_FrameTimes.size();
+	uint32_t FirstDirection = Shard.GetFirstDirection(DirectionCnt);
+	uint32_t LastDirection = FirstDirection + Shard.GetDirectionCount(DirectionCnt);
+	uint32_t RowLen = (uint32_t)Size.x * 4;
+	for (uint32_t i = 0; i < FrameCnt; i++) {
+		for (uint32_t n = FirstDirection; n < LastDirection; n++) {
+			const LWVector4i &Rect = Layout.m_Sprites[i * DirectionCnt + n].m_Rect;
+			int32_t Left = std::max<int32_t>(Rect.x, 0);
+			int32_t Right = std::min<int32_t>(Rect.x + Rect.z, Size.x);
+			int32_t Top = std::max<int32_t>(Rect.y, (int32_t)y);
+			int32_t Bottom = std::min<int32_t>(Rect.y + Rect.w, (int32_t)(y + RowCount));
+			if (Left >= Right) continue;
+			for (int32_t r = Top; r < Bottom; r++) {
+				uint32_t Offset = RowLen * (r - y) + Left * 4;
+				std::memcpy(Dst + Offset, Src + Offset, (Right - Left) * 4);
+			}
+		}
+	}
+	return;
+}
+
+//Streams every shard's sheet for Layer through in bands, and writes the combined sheet in the final format.
+static bool MergeLayer(const LWUTF8Iterator &OutputPath, uint32_t Layer, const ShardMeta &Layout, LWAllocator &Allocator) {
+	uint32_t Count = Layout.m_Count;
+	char8_t ShardNoExt[256];
+	std::vector<SheetReaderQOI> Readers(Count);
+	for (uint32_t i = 0; i < Count; i++) {
+		ExportShard(i, Count).MakePathNoExt(OutputPath, ShardNoExt, sizeof(ShardNoExt));
+		auto ShardPath = LWUTF8I::Fmt<256>("{}{}.{}", ShardNoExt, State_Viewer::RenderPathNames[Layer], SheetWriter::GetExtension(SheetWriter::FormatQOI));
+		if (!Readers[i].Open(ShardPath, Allocator)) {
+			LogCritical(LWUTF8I::Fmt<256>("Error: Could not open shard sheet '{}'", ShardPath));
+			return false;
+		}
+		if (Readers[i].GetSize() != Readers[0].GetSize()) {
+			LogCritical(LWUTF8I::Fmt<256>("Error: Shard sheet '{}' is a different size than shard 0's.", ShardPath));
+			return false;
+		}
+	}
+	LWVector2i Size = Readers[0].GetSize();
+	uint32_t RowLen = (uint32_t)Size.x * 4;
+	SheetEncoding Encoding = State_Viewer::RenderEncodings[Layer];
+	Encoding.m_Quality = Layout.m_Quality;
+
+	LWUTF8Iterator Dir, Name, Ext;
+	LWFileStream::SplitPath(OutputPath, Dir, Name, Ext);
+	LWUTF8Iterator NameNoExt = LWUTF8Iterator(Dir, Ext);
+	auto Path = LWUTF8I::Fmt<256>("{}{}.{}", NameNoExt, State_Viewer::RenderPathNames[Layer], SheetWriter::GetExtension(Layout.m_Format));
+	uint8_t *Band = Allocator.Allocate<uint8_t>(RowLen * SheetWriter::BandRows);
+	uint8_t *ShardBand = Allocator.Allocate<uint8_t>(RowLen * SheetWriter::BandRows);
+	SheetWriter *Writer = SheetWriter::Make(Layout.m_Format, Allocator);
+	bool Result = Writer->Begin(Path, Size, Encoding, Allocator);
+	for (uint32_t y = 0; y < (uint32_t)Size.y && Result; y += SheetWriter::BandRows) {
+		uint32_t RowCount = std::min<uint32_t>(SheetWriter::BandRows, (uint32_t)Size.y - y);
+		//Shard 0's sheet supplies the cleared space around every sprite, so only the other shard's own sprites have to be copied over it.
+		Result = Readers[0].ReadRows(Band, RowCount);
+		for (uint32_t i = 1; i < Count && Result; i++) {
+			Result = Readers[i].ReadRows(ShardBand, RowCount);
+			if (Result) CopyShardSprites(ExportShard(i, Count), Layout, ShardBand, Band, y, RowCount, Size);
+		}
+		Result = Result && Writer->WriteRows(Band, RowCount);
+	}
+	Result = Result && Writer->Finish();
+	LWAllocator::Destroy(Writer);
+	LWAllocator::Destroy(Band);
+	LWAllocator::Destroy(ShardBand);
+	if (!Result) LogCritical(LWUTF8I::Fmt<256>("Error occurred merging sheet '{}'", Path));
+	return Result;
+}
+
+//Writes the same json as State_Viewer::ExportMetaData, in the same order.
+static bool WriteMergedMetaData(const LWUTF8Iterator &OutputNoExt, const ShardMeta &Layout, LWAllocator &Allocator) {
+	uint32_t DirectionCnt = Layout.m_DirectionCnt;
+	uint32_t FrameCnt = (uint32_t)Layout.m_FrameTimes.size();
+	JsonWriter J;
+	if (!J.Open(LWUTF8I::Fmt<256>("{}.json", OutputNoExt), Allocator)) {
+		LogCritical(LWUTF8I::Fmt<256>("Error occurred while opening file '{}.json'", OutputNoExt));
+		return false;
+	}
+	LWUTF8Iterator Dir, Name;
+	LWFileStream::SplitPath(OutputNoExt, Dir, Name);
+	for (uint32_t i = 0; i < RenderCount; i++) {
+		if (!(Layout.m_LayerMask & (1 << i))) continue;
+		J.String(State_Viewer::RenderImageNames[i], LWUTF8I::Fmt<256>("{}{}.{}", Name, State_Viewer::RenderPathNames[i], SheetWriter::GetExtension(Layout.m_Format)));
+	}
+	J.Value("TotalTime", Layout.m_TotalTime);
+	J.Value("TimeOffset", Layout.m_TimeOffset);
+	J.Value("RotationOffset", Layout.m_RotationOffset);
+	J.BeginArray("Frames");
+	for (uint32_t i = 0; i < FrameCnt; i++) {
+		J.BeginObject();
+		J.Value("Time", Layout.m_FrameTimes[i]);
+		J.BeginArray("Sprites");
+		for (uint32_t n = 0; n < DirectionCnt; n++) {
+			const ShardSprite &S = Layout.m_Sprites[i * DirectionCnt + n];
+			J.BeginObject();
+			J.Value("x", S.m_Rect.x);
+			J.Value("y", S.m_Rect.y);
+			J.Value("width", S.m_Rect.z);
+			J.Value("height", S.m_Rect.w);
+			if (Layout.m_HasOffsets) {
+				J.Value("xOffset", S.m_Offset.x);
+				J.Value("yOffset", S.m_Offset.y);
+			}
+			J.EndObject();
+		}
+		J.EndArray();
+		J.EndObject();
+	}
+	J.EndArray();
+	if (!J.Finish()) {
+		LogCritical(LWUTF8I::Fmt<256>("Error occurred while writing file '{}.json'", OutputNoExt));
+		return false;
+	}
+	return true;
+}
+
+//Writes the same binary meta-data as State_Viewer::ExportBinaryMetaData.
+static bool WriteMergedBinaryMetaData(const LWUTF8Iterator &OutputNoExt, const ShardMeta &Layout, LWAllocator &Allocator) {
+	uint32_t DirectionCnt = Layout.m_DirectionCnt;
+	uint32_t FrameCnt = (uint32_t)Layout.m_FrameTimes.size();
+	SpriteMetaWriter W;
+	W.SetLayout(DirectionCnt, FrameCnt, Layout.m_HasOffsets ? SpriteMetaHasOffsets : 0);
+	W.SetTimes(Layout.m_TotalTime, Layout.m_TimeOffset, Layout.m_RotationOffset);
+	LWUTF8Iterator Dir, Name;
+	LWFileStream::SplitPath(OutputNoExt, Dir, Name);
+	for (uint32_t i = 0; i < RenderCount; i++) {
+		if (!(Layout.m_LayerMask & (1 << i))) continue;
+		W.PushSheet(State_Viewer::RenderImageNames[i], LWUTF8I::Fmt<256>("{}{}.{}", Name, State_Viewer::RenderPathNames[i], SheetWriter::GetExtension(Layout.m_Format)));
+	}
+	for (uint32_t i = 0; i < FrameCnt; i++) {
+		W.SetFrameTime(i, Layout.m_FrameTimes[i]);
+		for (uint32_t n = 0; n < DirectionCnt; n++) {
+			const ShardSprite &S = Layout.m_Sprites[i * DirectionCnt + n];
+			SpriteMetaRecord Record = { (uint16_t)S.m_Rect.x, (uint16_t)S.m_Rect.y, (uint16_t)S.m_Rect.z, (uint16_t)S.m_Rect.w, S.m_Offset.x, S.m_Offset.y };
+			W.SetSprite(i, n, Record);
+		}
+	}
+	if (!W.Save(LWUTF8I::Fmt<256>("{}.ismeta", OutputNoExt), Allocator)) {
+		LogCritical(LWUTF8I::Fmt<256>("Error occurred while writing file '{}.ismeta'", OutputNoExt));
+		return false;
+	}
+	return true;
+}
+
+//ExportShard
+bool ExportShard::Merge(const LWUTF8Iterator &OutputPath, LWAllocator &Allocator) {
+	char8_t ShardNoExt[256];
+	ShardMeta Layout;
+	ExportShard(0, 1).MakePathNoExt(OutputPath, ShardNoExt, sizeof(ShardNoExt));
+	if (!LoadShardMeta(LWUTF8I::Fmt<256>("{}.json", ShardNoExt), Layout, Allocator)) return false;
+	if (Layout.m_Index != 0 || !Layout.m_Count || Layout.m_Count > MaxShards || Layout.m_Sprites.empty()) {
+		LogCritical(LWUTF8I::Fmt<256>("Error: '{}.json' is not the first shard of an export.", ShardNoExt));
+		return false;
+	}
+	//Every shard has to agree on the layout, otherwise sprites would be copied from the wrong places.
+	for (uint32_t i = 1; i < Layout.m_Count; i++) {
+		ShardMeta Meta;
+		ExportShard(i, Layout.m_Count).MakePathNoExt(OutputPath, ShardNoExt, sizeof(ShardNoExt));
+		if (!LoadShardMeta(LWUTF8I::Fmt<256>("{}.json", ShardNoExt), Meta, Allocator)) return false;
+		if (Meta.m_Index != i || !isSameLayout(Layout, Meta)) {
+			LogCritical(LWUTF8I::Fmt<256>("Error: Shard {} was not exported with the same model and settings as shard 0.", i));
+			return false;
+		}
+	}
+	for (uint32_t i = 0; i < RenderCount; i++) {
+		if (!(Layout.m_LayerMask & (1 << i))) continue;
+		if (!MergeLayer(OutputPath, i, Layout, Allocator)) return false;
+	}
+	LWUTF8Iterator Dir, Name, Ext;
+	LWFileStream::SplitPath(OutputPath, Dir, Name, Ext);
+	LWUTF8Iterator NameNoExt = LWUTF8Iterator(Dir, Ext);
+	if (!WriteMergedMetaData(NameNoExt, Layout, Allocator)) return false;
+	if (Layout.m_BinaryMeta && !WriteMergedBinaryMetaData(NameNoExt, Layout, Allocator)) return false;
+	LogEvent(LWUTF8I::Fmt<256>("Merged {} shards into '{}'", Layout.m_Count, OutputPath));
+	return true;
+}
+
+uint32_t ExportShard::GetFirstDirection(uint32_t DirectionCnt) const {
+	if (!isSharded()) return 0;
+	return (uint32_t)(((uint64_t)DirectionCnt * m_Index) / m_Count);
+}
+
+uint32_t ExportShard::GetDirectionCount(uint32_t DirectionCnt) const {
+	if (!isSharded()) return DirectionCnt;
+	return (uint32_t)(((uint64_t)DirectionCnt * (m_Index + 1)) / m_Count) - GetFirstDirection(DirectionCnt);
+}
+
+void ExportShard::MakePathNoExt(const LWUTF8Iterator &OutputPath, char8_t *Buffer, uint32_t BufferLen) const {
+	LWUTF8Iterator Dir, Name, Ext;
+	LWFileStream::SplitPath(OutputPath, Dir, Name, Ext);
+	LWUTF8Iterator NameNoExt = LWUTF8Iterator(Dir, Ext);
+	LWUTF8Iterator(LWUTF8I::Fmt<256>("{}.shard{}", NameNoExt, m_Index)).Copy(Buffer, BufferLen);
+	return;
+}
+
+bool ExportShard::isSharded(void) const {
+	return m_Count > 1;
+}
+
+ExportShard::ExportShard(uint32_t Index, uint32_t Count) : m_Index(Index), m_Count(Count) {}
\ No newline at end of file
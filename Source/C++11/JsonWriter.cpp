@@ -0,0 +1,168 @@
+#include "JsonWriter.h"
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+static const char *JsonTabs = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"; //MaxDepth tabs for indenting.
+
+bool JsonWriter::Open(const LWUTF8Iterator &Path, LWAllocator &Allocator) {
+	m_BufferLen = 0;
+	m_Depth = 0;
+	m_Error = false;
+	m_Open = LWFileStream::OpenStream(m_Stream, Path, LWFileStream::WriteMode | LWFileStream::BinaryMode, Allocator, nullptr);
+	if (!m_Open) return false;
+	Write("{", 1);
+	m_HasElements[0] = false;
+	return true;
+}
+
+JsonWriter &JsonWriter::BeginObject(const char8_t *Name) {
+	return BeginScope(Name, '{');
+}
+
+JsonWriter &JsonWriter::EndObject(void) {
+	return EndScope('}');
+}
+
+JsonWriter &JsonWriter::BeginArray(const char8_t *Name) {
+	return BeginScope(Name, '[');
+}
+
+JsonWriter &JsonWriter::EndArray(void) {
+	return EndScope(']');
+}
+
+JsonWriter &JsonWriter::Value(const char8_t *Name, float Value) {
+	char Buffer[32];
+	uint32_t Len = 0;
+	if (!std::isfinite(Value)) Value = 0.0f;
+	//Use the shortest precision that reads back to the same float.
+	for (int32_t Precision = 6; Precision <= 9; Precision++) {
+		Len = (uint32_t)snprintf(Buffer, sizeof(Buffer), "%.*g", Precision, Value);
+		if (strtof(Buffer, nullptr) == Value) break;
+	}
+	WriteKey(Name);
+	Write(Buffer, Len);
+	return *this;
+}
+
+JsonWriter &JsonWriter::Value(const char8_t *Name, double Value) {
+	char Buffer[32];
+	if (!std::isfinite(Value)) Value = 0.0;
+	WriteKey(Name);
+	Write(Buffer, (uint32_t)snprintf(Buffer, sizeof(Buffer), "%.17g", Value));
+	return *this;
+}
+
+JsonWriter &JsonWriter::Value(const char8_t *Name, int32_t Value) {
+	char Buffer[16];
+	WriteKey(Name);
+	Write(Buffer, (uint32_t)snprintf(Buffer, sizeof(Buffer), "%d", Value));
+	return *this;
+}
+
+JsonWriter &JsonWriter::Value(const char8_t *Name, uint32_t Value) {
+	char Buffer[16];
+	WriteKey(Name);
+	Write(Buffer, (uint32_t)snprintf(Buffer, sizeof(Buffer), "%u", Value));
+	return *this;
+}
+
+JsonWriter &JsonWriter::Value(const char8_t *Name, bool Value) {
+	WriteKey(Name);
+	if (Value) Write("true", 4);
+	else Write("false", 5);
+	return *this;
+}
+
+JsonWriter &JsonWriter::String(const char8_t *Name, const LWUTF8Iterator &Value) {
+	const char *Hex = "0123456789abcdef";
+	char8_t Buffer[MaxStringLength];
+	Value.Copy(Buffer, sizeof(Buffer));
+	WriteKey(Name);
+	Write("\"", 1);
+	for (const char *C = (const char*)Buffer; *C; C++) {
+		uint8_t Ch = (uint8_t)*C;
+		if (Ch == '"' || Ch == '\\') {
+			char Escaped[2] = { '\\', (char)Ch };
+			Write(Escaped, 2);
+		} else if (Ch < 0x20) {
+			char Escaped[6] = { '\\', 'u', '0', '0', Hex[Ch >> 4], Hex[Ch & 0xF] };
+			Write(Escaped, 6);
+		} else Write(C, 1);
+	}
+	Write("\"", 1);
+	return *this;
+}
+
+bool JsonWriter::Finish(void) {
+	if (!m_Open) return false;
+	if (m_Depth) m_Error = true;
+	if (m_HasElements[0]) Write("\n", 1);
+	Write("}\n", 2);
+	Flush();
+	m_Open = false;
+	return !m_Error;
+}
+
+bool JsonWriter::isOpen(void) const {
+	return m_Open;
+}
+
+JsonWriter &JsonWriter::BeginScope(const char8_t *Name, char Open) {
+	if (m_Depth + 1 >= MaxDepth) {
+		m_Error = true;
+		return *this;
+	}
+	WriteKey(Name);
+	Write(&Open, 1);
+	m_HasElements[++m_Depth] = false;
+	return *this;
+}
+
+JsonWriter &JsonWriter::EndScope(char Close) {
+	if (!m_Depth) {
+		m_Error = true;
+		return *this;
+	}
+	bool HasElements = m_HasElements[m_Depth--];
+	if (HasElements) {
+		Write("\n", 1);
+		Write(JsonTabs, m_Depth + 1);
+	}
+	Write(&Close, 1);
+	return *this;
+}
+
+void JsonWriter::WriteKey(const char8_t *Name) {
+	if (m_HasElements[m_Depth]) Write(",", 1);
+	m_HasElements[m_Depth] = true;
+	Write("\n", 1);
+	Write(JsonTabs, m_Depth + 1);
+	if (!Name) return;
+	Write("\"", 1);
+	Write((const char*)Name, (uint32_t)strlen((const char*)Name));
+	Write("\": ", 3);
+	return;
+}
+
+void JsonWriter::Write(const char *Text, uint32_t Len) {
+	if (!m_Open) return;
+	while (Len) {
+		if (m_BufferLen == BufferSize) Flush();
+		uint32_t n = std::min<uint32_t>(Len, BufferSize - m_BufferLen);
+		std::memcpy(m_Buffer + m_BufferLen, Text, n);
+		m_BufferLen += n;
+		Text += n;
+		Len -= n;
+	}
+	return;
+}
+
+void JsonWriter::Flush(void) {
+	if (m_BufferLen && m_Stream.Write(m_Buffer, m_BufferLen) != m_BufferLen) m_Error = true;
+	m_BufferLen = 0;
+	return;
+}
\ No newline at end of file
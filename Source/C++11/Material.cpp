@@ -144,6 +144,7 @@ Material &Material::MakeGLTFMaterial(LWEGLTFParser &P, LWEGLTFMaterial *Mat) {
 	LWEGLTFMatMetallicRoughness &MR = Mat->m_MetallicRoughness;
 	LWEGLTFMatSpecularGlossyness &SG = Mat->m_SpecularGlossy;
 	m_NameHash = Mat->GetName().Hash();
+	m_ConstantsCached = false;
 	ApplyTexture(Mat->m_NormalMapTexture, NormalTexID);
 	ApplyTexture(Mat->m_OcclussionTexture, OcclussionTexID);
 	ApplyTexture(Mat->m_EmissiveTexture, EmissiveTexID);
@@ -203,17 +204,20 @@ void Material::Release(DataManager *DM, uint64_t lCurrentTime) {
 Material &Material::MakeFlatColor(uint32_t ColorID, const LWVector4f &Color) {
 	m_ColorTweens[ColorID] = LWETween<LWVector4f>(m_ColorTweens[ColorID].GetInterpolation());
 	m_ColorTweens[ColorID].Push(Color, 0);
+	m_ConstantsCached = false;
 	return *this;
 }
 
 Material &Material::MakeFlatTexture(uint32_t TextureID, const LWVector4f &SubTexture) {
 	m_TextureTweens[TextureID] = LWETween<LWVector4f>(m_TextureTweens[TextureID].GetInterpolation());
 	m_TextureTweens[TextureID].Push(SubTexture, 0);
+	m_ConstantsCached = false;
 	return *this;
 }
 
 Material &Material::SetTransparency(float Transparency) {
 	m_Transparency = Transparency;
+	m_ConstantsCached = false;
 	return *this;
 }
 
@@ -238,9 +242,20 @@ Material &Material::UpdatedTweens(void) {
 	for (uint32_t i = 0; i < ClrCnt; i++) Time = std::max<float>(Time, m_ColorTweens[i].GetTotalTime());
 	for (uint32_t i = 0; i < TexCnt; i++) Time = std::max<float>(Time, m_TextureTweens[i].GetTotalTime());
 	m_TotalTime = Time;
+	m_ConstantsCached = false;
 	return *this;
 }
 
+Material &Material::CacheConstants(const GMaterial &Constants) {
+	m_Constants = Constants;
+	m_ConstantsCached = true;
+	return *this;
+}
+
+const GMaterial *Material::GetCachedConstants(void) const {
+	return m_ConstantsCached ? &m_Constants : nullptr;
+}
+
 uint32_t Material::GetTextureCount(void) const {
 	return PipelineTextureCount(m_PipelineID);
 }
@@ -258,10 +273,13 @@ const LWETween<LWVector4f> &Material::GetTextureTween(uint32_t i) const{
 }
 
 LWETween<LWVector4f> &Material::GetColorTween(uint32_t i) {
+	//The caller may change the tween.
+	m_ConstantsCached = false;
 	return m_ColorTweens[i];
 }
 
 LWETween<LWVector4f> &Material::GetTextureTween(uint32_t i) {
+	m_ConstantsCached = false;
 	return m_TextureTweens[i];
 }
 
@@ -305,4 +323,17 @@ bool Material::isPlaying(void) const {
 	return (m_Flag&Paused) == 0;
 }
 
+bool Material::isAnimated(void) const {
+	if (m_PipelineID == Cloud) return true;
+	uint32_t ClrCnt = GetColorCount();
+	uint32_t TexCnt = GetTextureCount();
+	for (uint32_t i = 0; i < ClrCnt; i++) {
+		if (m_ColorTweens[i].GetFrameCount() > 1) return true;
+	}
+	for (uint32_t i = 0; i < TexCnt; i++) {
+		if (m_TextureTweens[i].GetFrameCount() > 1) return true;
+	}
+	return false;
+}
+
 Material::Material(uint32_t PipelineID, uint32_t NameHash) : m_PipelineID(PipelineID), m_NameHash(NameHash) {}
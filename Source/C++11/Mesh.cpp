@@ -25,9 +25,9 @@ Bone::Bone(const LWUTF8Iterator &Name, const LWSMatrix4f &InvBindMatrix, const L
 
 //MeshGeometry
 
-bool MeshGeometry::UploadData(Renderer *R, LWAllocator &Allocator, bool CopyOut) {
+bool MeshGeometry::UploadData(Renderer *R, LWAllocator &Allocator, bool CopyOut, uint32_t VerticeID) {
 	if (!m_Count) return true;
-	uint32_t r = R->PushPendingGeometry(m_ID, m_BufferType, m_Data, m_Count, m_TypeSize, Allocator, CopyOut);
+	uint32_t r = R->PushPendingGeometry(m_ID, m_BufferType, m_Data, m_Count, m_TypeSize, Allocator, CopyOut, VerticeID);
 	if (!r) return false;
 	m_ID = r;
 	if (!CopyOut) m_Data = nullptr;
@@ -7,8 +7,11 @@
 #include <LWVideo/LWFrameBuffer.h>
 #include <LWESGeometry3D.h>
 #include "Camera.h"
+#include "SpriteHash.h"
 #include "Logger.h"
 #include "Mesh.h"
+#include <vector>
+#include <cstring>
 
 //PendingGeometry
 LWVideoBuffer *PendingGeometry::MakeBuffer(LWVideoDriver *Driver, LWAllocator &Allocator) {
@@ -22,7 +25,383 @@ void PendingGeometry::Finished(void) {
 	return;
 }
 
-PendingGeometry::PendingGeometry(char *Data, uint32_t ID, uint32_t BufferType, uint32_t DataTypeSize, uint32_t Count) : m_Data(Data), m_ID(ID), m_BufferType(BufferType), m_TypeSize(DataTypeSize), m_Count(Count) {}
+PendingGeometry::PendingGeometry(char *Data, uint32_t ID, uint32_t BufferType, uint32_t DataTypeSize, uint32_t Count, uint32_t VerticeID) : m_Data(Data), m_ID(ID), m_BufferType(BufferType), m_TypeSize(DataTypeSize), m_Count(Count), m_VerticeID(VerticeID) {}
+
+//GeometryArena
+uint32_t GeometryArena::Allocate(uint32_t Count, LWAllocator &Allocator) {
+	for (auto Iter = m_FreeList.begin(); Iter != m_FreeList.end(); ++Iter) {
+		if (Iter->m_Count < Count) continue;
+		uint32_t Offset = Iter->m_Offset;
+		Iter->m_Offset += Count;
+		Iter->m_Count -= Count;
+		if (!Iter->m_Count) m_FreeList.erase(Iter);
+		m_Used += Count;
+		MarkDirty(Offset, Count);
+		return Offset;
+	}
+	if (m_End + Count > m_Capacity) {
+		uint32_t Capacity = m_Capacity ? m_Capacity : InitialCapacity;
+		while (Capacity < m_End + Count) Capacity *= 2;
+		char *Data = Allocator.Allocate<char>(Capacity * m_TypeSize);
+		if (!Data) return -1;
+		if (m_Data) {
+			std::copy(m_Data, m_Data + m_End * m_TypeSize, Data);
+			LWAllocator::Destroy(m_Data);
+		}
+		m_Data = Data;
+		m_Capacity = Capacity;
+	}
+	uint32_t Offset = m_End;
+	m_End += Count;
+	m_Used += Count;
+	MarkDirty(Offset, Count);
+	return Offset;
+}
+
+void GeometryArena::Free(uint32_t Offset, uint32_t Count) {
+	m_Used -= Count;
+	auto Iter = std::lower_bound(m_FreeList.begin(), m_FreeList.end(), Offset, [](const Range &R, uint32_t O) { return R.m_Offset < O; });
+	Iter = m_FreeList.insert(Iter, { Offset, Count });
+	auto Next = Iter + 1;
+	if (Next != m_FreeList.end() && Iter->m_Offset + Iter->m_Count == Next->m_Offset) {
+		Iter->m_Count += Next->m_Count;
+		Iter = m_FreeList.erase(Next) - 1;
+	}
+	if (Iter != m_FreeList.begin()) {
+		auto Prev = Iter - 1;
+		if (Prev->m_Offset + Prev->m_Count == Iter->m_Offset) {
+			Prev->m_Count += Iter->m_Count;
+			Iter = m_FreeList.erase(Iter) - 1;
+		}
+	}
+	//Free space at the end goes back to the end of the arena.
+	if (Iter->m_Offset + Iter->m_Count == m_End) {
+		m_End = Iter->m_Offset;
+		m_FreeList.erase(Iter);
+	}
+	return;
+}
+
+void GeometryArena::Move(uint32_t Offset, uint32_t NewOffset, uint32_t Count) {
+	std::memmove(m_Data + NewOffset * m_TypeSize, m_Data + Offset * m_TypeSize, Count * m_TypeSize);
+	MarkDirty(NewOffset, Count);
+	return;
+}
+
+void GeometryArena::Rebase(uint32_t Offset, uint32_t Count, uint32_t Delta) {
+	uint32_t *Indices = (uint32_t*)GetData(Offset);
+	for (uint32_t i = 0; i < Count; i++) Indices[i] -= Delta;
+	MarkDirty(Offset, Count);
+	return;
+}
+
+void GeometryArena::ResetFreeList(uint32_t End) {
+	m_FreeList.clear();
+	m_End = m_Used = End;
+	return;
+}
+
+bool GeometryArena::Update(LWVideoDriver *Driver, LWAllocator &Allocator) {
+	if (m_BufferCapacity < m_End) {
+		//Elements past m_End are never drawn, so the whole cpu copy is uploaded without caring what's in them.
+		LWVideoBuffer *Buf = Driver->CreateVideoBuffer(m_BufferType, LWVideoBuffer::Static, m_TypeSize, m_Capacity, Allocator, (uint8_t*)m_Data);
+		if (!Buf) {
+			LogCritical(LWUTF8I::Fmt<128>("Error could not create geometry arena of {} elements.", m_Capacity));
+			return false;
+		}
+		if (m_Buffer) Driver->DestroyVideoBuffer(m_Buffer);
+		m_Buffer = Buf;
+		m_BufferCapacity = m_Capacity;
+	} else if (m_DirtyBegin < m_DirtyEnd) Driver->UpdateVideoBuffer(m_Buffer, (const uint8_t*)GetData(m_DirtyBegin), (m_DirtyEnd - m_DirtyBegin) * m_TypeSize, m_DirtyBegin * m_TypeSize);
+	m_DirtyBegin = -1;
+	m_DirtyEnd = 0;
+	return true;
+}
+
+void GeometryArena::MarkDirty(uint32_t Offset, uint32_t Count) {
+	m_DirtyBegin = std::min<uint32_t>(m_DirtyBegin, Offset);
+	m_DirtyEnd = std::max<uint32_t>(m_DirtyEnd, Offset + Count);
+	return;
+}
+
+void GeometryArena::Destroy(LWVideoDriver *Driver) {
+	if (m_Buffer) Driver->DestroyVideoBuffer(m_Buffer);
+	m_Buffer = nullptr;
+	m_Data = LWAllocator::Destroy(m_Data);
+	m_FreeList.clear();
+	m_Capacity = m_End = m_Used = m_BufferCapacity = 0;
+	m_DirtyBegin = -1;
+	m_DirtyEnd = 0;
+	return;
+}
+
+bool GeometryArena::NeedsCompaction(void) const {
+	return m_Used * 2 < m_End;
+}
+
+bool GeometryArena::isFormat(uint32_t BufferType, uint32_t TypeSize) const {
+	return m_BufferType == BufferType && m_TypeSize == TypeSize;
+}
+
+char *GeometryArena::GetData(uint32_t Offset) {
+	return m_Data + Offset * m_TypeSize;
+}
+
+LWVideoBuffer *GeometryArena::GetBuffer(void) const {
+	return m_Buffer;
+}
+
+uint32_t GeometryArena::GetUsed(void) const {
+	return m_Used;
+}
+
+uint32_t GeometryArena::GetEnd(void) const {
+	return m_End;
+}
+
+uint32_t GeometryArena::GetTypeSize(void) const {
+	return m_TypeSize;
+}
+
+GeometryArena::GeometryArena(uint32_t BufferType, uint32_t TypeSize) : m_BufferType(BufferType), m_TypeSize(TypeSize) {}
+
+//GRingFence
+void GRingFence::Signal(LWVideoDriver *Driver, uint32_t Frame, LWAllocator &Allocator) {
+	uint32_t Region = Frame % RingFrames;
+	if (!m_FrameBuffer) m_FrameBuffer = Driver->CreateFrameBuffer(LWVector2i(1), Allocator);
+	if (!m_Targets[Region]) m_Targets[Region] = Driver->CreateTexture2D(LWTexture::RenderTarget, LWImage::RGBA8, LWVector2i(1), nullptr, 0, Allocator);
+	if (!m_FrameBuffer || !m_Targets[Region]) {
+		LogCritical("Error could not create uniform ring fence targets.");
+		return;
+	}
+	//Every byte of a tag is the same, so it reads back the same whatever order the driver packs channels in.
+	m_NextTag = m_NextTag % 255 + 1;
+	m_Tags[Region] = m_NextTag * 0x01010101;
+	m_FrameBuffer->SetAttachment(LWFrameBuffer::Color0, m_Targets[Region]);
+	Driver->SetFrameBuffer(m_FrameBuffer, true);
+	Driver->ClearColor(m_Tags[Region]);
+	return;
+}
+
+void GRingFence::Wait(LWVideoDriver *Driver, uint32_t Frame) {
+	uint32_t Region = Frame % RingFrames;
+	if (!m_Tags[Region]) return;
+	uint32_t Texel = 0;
+	//The clear was queued behind the last draw reading the region, so the readback can't return until that frame is done.
+	if (!Driver->DownloadTexture2D(m_Targets[Region], 0, &Texel) || Texel != m_Tags[Region]) LogWarn(LWUTF8I::Fmt<128>("Uniform ring fence {} read back {:#x} instead of {:#x}.", Region, Texel, m_Tags[Region]));
+	m_Tags[Region] = 0;
+	return;
+}
+
+void GRingFence::Destroy(LWVideoDriver *Driver) {
+	if (m_FrameBuffer) Driver->DestroyFrameBuffer(m_FrameBuffer);
+	for (auto &&T : m_Targets) {
+		if (T) Driver->DestroyTexture(T);
+		T = nullptr;
+	}
+	m_FrameBuffer = nullptr;
+	return;
+}
+
+//GUniformRing
+template<class Type>
+uint32_t GUniformRing<Type>::Write(LWVideoDriver *Driver, uint32_t Frame, const char *Data, uint32_t Count, LWAllocator &Allocator) {
+	if (Count > m_RegionCapacity) {
+		uint32_t Capacity = std::max<uint32_t>(m_RegionCapacity, m_InitialCount);
+		while (Capacity < Count) Capacity *= 2;
+		Grow(Driver, std::min<uint32_t>(Capacity, m_MaxCount), Allocator);
+		Count = std::min<uint32_t>(Count, m_RegionCapacity);
+	}
+	uint32_t First = (Frame % RingFrames) * m_RegionCapacity;
+	if (Count) Driver->UpdateVideoBuffer(m_Buffer, (const uint8_t*)Data, Driver->GetUniformPaddedLength<Type>(Count), Driver->GetUniformPaddedLength<Type>(First));
+	return First;
+}
+
+template<class Type>
+bool GUniformRing<Type>::Grow(LWVideoDriver *Driver, uint32_t Capacity, LWAllocator &Allocator) {
+	LWVideoBuffer *Buffer = Driver->CreatePaddedVideoBuffer<Type>(LWVideoBuffer::Uniform, LWVideoBuffer::WriteNoOverlap, Capacity * RingFrames, Allocator, nullptr);
+	if (!Buffer) {
+		LogCritical(LWUTF8I::Fmt<128>("Error could not grow uniform ring to {} elements.", Capacity * RingFrames));
+		return false;
+	}
+	//Nothing in the old buffer is needed, every region is rewritten before it's next drawn from.
+	if (m_Buffer) Driver->DestroyVideoBuffer(m_Buffer);
+	m_Buffer = Buffer;
+	m_RegionCapacity = Capacity;
+	return true;
+}
+
+template<class Type>
+void GUniformRing<Type>::Destroy(LWVideoDriver *Driver) {
+	if (m_Buffer) Driver->DestroyVideoBuffer(m_Buffer);
+	m_Buffer = nullptr;
+	m_RegionCapacity = 0;
+	return;
+}
+
+template<class Type>
+LWVideoBuffer *GUniformRing<Type>::GetBuffer(void) const {
+	return m_Buffer;
+}
+
+template<class Type>
+uint32_t GUniformRing<Type>::GetRegionCapacity(void) const {
+	return m_RegionCapacity;
+}
+
+template<class Type>
+GUniformRing<Type>::GUniformRing(uint32_t InitialCount, uint32_t MaxCount) : m_InitialCount(InitialCount), m_MaxCount(MaxCount) {}
+
+//GStorageRing
+template<class Type>
+uint32_t GStorageRing<Type>::Write(LWVideoDriver *Driver, uint32_t Frame, const Type *Data, uint32_t Count, LWAllocator &Allocator) {
+	if (Count > m_RegionCapacity) {
+		uint32_t Capacity = std::max<uint32_t>(m_RegionCapacity, m_InitialCount);
+		while (Capacity < Count) Capacity *= 2;
+		Grow(Driver, std::min<uint32_t>(Capacity, m_MaxCount), Allocator);
+		Count = std::min<uint32_t>(Count, m_RegionCapacity);
+	}
+	uint32_t First = (Frame % RingFrames) * m_RegionCapacity;
+	if (Count) Driver->UpdateVideoBuffer(m_Buffer, (const uint8_t*)Data, sizeof(Type) * Count, sizeof(Type) * First);
+	return First;
+}
+
+template<class Type>
+bool GStorageRing<Type>::Grow(LWVideoDriver *Driver, uint32_t Capacity, LWAllocator &Allocator) {
+	LWVideoBuffer *Buffer = Driver->CreateVideoBuffer<Type>(LWVideoBuffer::ImageBuffer, LWVideoBuffer::WriteNoOverlap, Capacity * RingFrames, Allocator, nullptr);
+	if (!Buffer) {
+		LogCritical(LWUTF8I::Fmt<128>("Error could not grow storage ring to {} elements.", Capacity * RingFrames));
+		return false;
+	}
+	if (m_Buffer) Driver->DestroyVideoBuffer(m_Buffer);
+	m_Buffer = Buffer;
+	m_RegionCapacity = Capacity;
+	return true;
+}
+
+template<class Type>
+void GStorageRing<Type>::Destroy(LWVideoDriver *Driver) {
+	if (m_Buffer) Driver->DestroyVideoBuffer(m_Buffer);
+	m_Buffer = nullptr;
+	m_RegionCapacity = 0;
+	return;
+}
+
+template<class Type>
+LWVideoBuffer *GStorageRing<Type>::GetBuffer(void) const {
+	return m_Buffer;
+}
+
+template<class Type>
+uint32_t GStorageRing<Type>::GetRegionCapacity(void) const {
+	return m_RegionCapacity;
+}
+
+template<class Type>
+GStorageRing<Type>::GStorageRing(uint32_t InitialCount, uint32_t MaxCount) : m_InitialCount(InitialCount), m_MaxCount(MaxCount) {}
+
+//GGeometry
+bool GGeometry::isLoaded(void) const {
+	return m_Buffer || m_Arena != -1;
+}
+
+GGeometry::GGeometry(LWVideoBuffer *Buffer) : m_Buffer(Buffer), m_Count(Buffer ? Buffer->GetLength() : 0) {}
+
+GGeometry::GGeometry(uint32_t Arena, uint32_t Offset, uint32_t Count, uint32_t VerticeID) : m_Arena(Arena), m_Offset(Offset), m_Count(Count), m_VerticeID(VerticeID) {}
+
+//GTextureArray
+uint32_t GTextureArray::Insert(uint32_t ID, LWImage *Image) {
+	uint32_t Layer = (uint32_t)m_IDs.size();
+	if (!m_FreeLayers.empty()) {
+		Layer = m_FreeLayers.back();
+		m_FreeLayers.pop_back();
+	} else if (Layer >= MaxLayers) return -1;
+	else {
+		m_Pending.push_back(nullptr);
+		m_IDs.push_back(0);
+	}
+	m_Pending[Layer] = Image;
+	m_IDs[Layer] = ID;
+	m_Dirty = true;
+	return Layer;
+}
+
+void GTextureArray::Remove(uint32_t Layer) {
+	//The layer's texels stay in the array until it's reused, nothing draws from them.
+	m_Pending[Layer] = LWAllocator::Destroy(m_Pending[Layer]);
+	m_IDs[Layer] = 0;
+	m_FreeLayers.push_back(Layer);
+	return;
+}
+
+bool GTextureArray::Update(LWVideoDriver *Driver, LWAllocator &Allocator) {
+	if (!m_Dirty) return false;
+	uint32_t LayerCount = (uint32_t)m_IDs.size();
+	if (LayerCount > m_Capacity) {
+		uint32_t Capacity = std::max(m_Capacity, InitialLayers);
+		while (Capacity < LayerCount) Capacity *= 2;
+		Capacity = std::min(Capacity, MaxLayers);
+		LWTexture *Tex = Driver->CreateTexture2DArray(0, m_PackType, m_Size, Capacity, nullptr, m_MipmapCount, Allocator);
+		if (!Tex) {
+			LogCritical(LWUTF8I::Fmt<128>("Error could not create texture array of {} layers.", Capacity));
+			return false;
+		}
+		if (m_Texture) {
+			//Uploaded layers are copied through a read back, growing is rare as the capacity doubles each time.
+			std::vector<uint8_t> Texels(LWImage::GetLength2D(m_Size, m_PackType));
+			for (uint32_t l = 0; l < m_Capacity; l++) {
+				if (!m_IDs[l] || m_Pending[l]) continue;
+				for (uint32_t m = 0; m <= m_MipmapCount; m++) {
+					if (!Driver->DownloadTexture2DArray(m_Texture, m, l, Texels.data())) continue;
+					Driver->UpdateTexture2DArray(Tex, m, l, Texels.data(), LWVector2i(), LWImage::MipmapSize2D(m_Size, m));
+				}
+			}
+			Driver->DestroyTexture(m_Texture);
+		}
+		m_Texture = Tex;
+		m_Capacity = Capacity;
+	}
+	m_Dirty = false;
+	for (uint32_t l = 0; l < LayerCount; l++) {
+		LWImage *Img = m_Pending[l];
+		if (!Img) continue;
+		for (uint32_t m = 0; m <= m_MipmapCount; m++) Driver->UpdateTexture2DArray(m_Texture, m, l, Img->GetTexels(m), LWVector2i(), LWImage::MipmapSize2D(m_Size, m));
+		m_Pending[l] = LWAllocator::Destroy(Img);
+	}
+	return true;
+}
+
+void GTextureArray::Destroy(LWVideoDriver *Driver) {
+	if (m_Texture) Driver->DestroyTexture(m_Texture);
+	m_Texture = nullptr;
+	for (auto &&Img : m_Pending) LWAllocator::Destroy(Img);
+	m_Pending.clear();
+	m_IDs.clear();
+	m_FreeLayers.clear();
+	m_Capacity = 0;
+	m_Dirty = false;
+	return;
+}
+
+bool GTextureArray::isFormat(const LWImage &Image) const {
+	return Image.GetSize2D() == m_Size && Image.GetPackType() == m_PackType && Image.GetMipmapCount() == m_MipmapCount;
+}
+
+bool GTextureArray::isFull(void) const {
+	return m_FreeLayers.empty() && m_IDs.size() >= MaxLayers;
+}
+
+LWTexture *GTextureArray::GetTexture(void) const {
+	return m_Texture;
+}
+
+const std::vector<uint32_t> &GTextureArray::GetLayerIDs(void) const {
+	return m_IDs;
+}
+
+GTextureArray::GTextureArray(const LWImage &Image) : m_Size(Image.GetSize2D()), m_PackType(Image.GetPackType()), m_MipmapCount(Image.GetMipmapCount()) {}
+
+GTextureLayer::GTextureLayer(uint32_t Array, uint32_t Layer) : m_Array(Array), m_Layer(Layer) {}
 
 GModelTexture::GModelTexture(uint32_t TextureID, uint32_t TextureState) : m_TextureID(TextureID), m_TextureState(TextureState) {}
 
@@ -41,6 +420,122 @@ uint32_t GFrameModel::GetAnimBufferID(void) const {
 
 GFrameModel::GFrameModel(uint32_t PipelineID, uint32_t VerticeID, uint32_t IndiceID, uint32_t Flags, uint32_t Offset, uint32_t Count) : m_VerticeID(VerticeID), m_IndiceID(IndiceID), m_PipelineID(PipelineID), m_Offset(Offset), m_Count(Count), m_Flags(Flags) {}
 
+//RenderStats
+RenderStats &RenderStats::operator += (const RenderStats &O) {
+	m_DrawCalls += O.m_DrawCalls;
+	m_InstancedModels += O.m_InstancedModels;
+	m_PipelineSwitches += O.m_PipelineSwitches;
+	m_ResourceBinds += O.m_ResourceBinds;
+	m_RedundantSkipped += O.m_RedundantSkipped;
+	m_UploadBytes += O.m_UploadBytes;
+	m_Materials += O.m_Materials;
+	m_ShadowPassesRendered += O.m_ShadowPassesRendered;
+	m_ShadowPassesSkipped += O.m_ShadowPassesSkipped;
+	return *this;
+}
+
+//GPUMemoryReport
+const char8_t *GPUMemoryReport::ResourceNames[GPUMemoryReport::ResourceCount] = { "Screen targets", "Highlight targets", "Blur targets", "Light array", "Shadow array", "Shadow cube array", "Reflection targets", "Output array", "Pooled targets" };
+
+uint64_t GPUMemoryReport::TextureBytes(const LWVector2i &Size, uint32_t Layers, uint32_t Samples, bool Mipmapped) {
+	uint64_t Bytes = (uint64_t)Size.x * (uint64_t)Size.y * 4 * Layers * Samples;
+	return Mipmapped ? Bytes + Bytes / 3 : Bytes;
+}
+
+GPUMemoryReport &GPUMemoryReport::Set(uint32_t Resource, uint64_t Bytes) {
+	m_Bytes[Resource] = Bytes;
+	m_PeakBytes[Resource] = std::max<uint64_t>(m_PeakBytes[Resource], Bytes);
+	return *this;
+}
+
+uint64_t GPUMemoryReport::GetTotal(void) const {
+	uint64_t Total = 0;
+	for (uint32_t i = 0; i < ResourceCount; i++) Total += m_Bytes[i];
+	return Total;
+}
+
+//GRenderTargetPool
+LWTexture *GRenderTargetPool::Acquire(LWVideoDriver *Driver, uint32_t Flags, uint32_t PackType, const LWVector2i &Size, uint32_t Samples, LWAllocator &Allocator) {
+	GPooledTarget *Best = nullptr;
+	for (auto &&T : m_Targets) {
+		if (T.m_InUse || T.m_Size != Size || T.m_Flags != Flags || T.m_PackType != PackType || T.m_Samples != Samples) continue;
+		if (m_Frame - T.m_ReleasedFrame < ReuseFrames) continue;
+		//Prefer the most recently released target, so older ones age out.
+		if (!Best || T.m_ReleasedFrame > Best->m_ReleasedFrame) Best = &T;
+	}
+	if (Best) {
+		Best->m_InUse = true;
+		m_Reused++;
+		return Best->m_Texture;
+	}
+	LWTexture *Tex = Samples ? Driver->CreateTexture2DMS(Flags, PackType, Size, Samples, Allocator) : Driver->CreateTexture2D(Flags, PackType, Size, nullptr, 0, Allocator);
+	if (!Tex) return nullptr;
+	GPooledTarget T;
+	T.m_Texture = Tex;
+	T.m_Size = Size;
+	T.m_Flags = Flags;
+	T.m_PackType = PackType;
+	T.m_Samples = Samples;
+	m_Targets.push_back(T);
+	m_Created++;
+	return Tex;
+}
+
+void GRenderTargetPool::Release(LWTexture *Tex) {
+	if (!Tex) return;
+	for (auto &&T : m_Targets) {
+		if (T.m_Texture != Tex || !T.m_InUse) continue;
+		T.m_InUse = false;
+		T.m_ReleasedFrame = m_Frame;
+		break;
+	}
+	return;
+}
+
+void GRenderTargetPool::NextFrame(LWVideoDriver *Driver) {
+	m_Frame++;
+	auto Expired = [this](const GPooledTarget &T)->bool { return !T.m_InUse && m_Frame - T.m_ReleasedFrame >= TrimFrames; };
+	uint32_t FreeCount = 0;
+	for (auto &&T : m_Targets) {
+		if (T.m_InUse) continue;
+		if (Expired(T)) Driver->DestroyTexture(T.m_Texture);
+		else FreeCount++;
+	}
+	m_Targets.erase(std::remove_if(m_Targets.begin(), m_Targets.end(), Expired), m_Targets.end());
+	while (FreeCount > MaxFreeTargets) {
+		auto Oldest = m_Targets.end();
+		for (auto Iter = m_Targets.begin(); Iter != m_Targets.end(); ++Iter) {
+			if (!Iter->m_InUse && (Oldest == m_Targets.end() || Iter->m_ReleasedFrame < Oldest->m_ReleasedFrame)) Oldest = Iter;
+		}
+		Driver->DestroyTexture(Oldest->m_Texture);
+		m_Targets.erase(Oldest);
+		FreeCount--;
+	}
+	return;
+}
+
+void GRenderTargetPool::Destroy(LWVideoDriver *Driver) {
+	for (auto &&T : m_Targets) Driver->DestroyTexture(T.m_Texture);
+	m_Targets.clear();
+	return;
+}
+
+uint64_t GRenderTargetPool::GetFreeBytes(void) const {
+	uint64_t Bytes = 0;
+	for (auto &&T : m_Targets) {
+		if (!T.m_InUse) Bytes += GPUMemoryReport::TextureBytes(T.m_Size, 1, std::max<uint32_t>(T.m_Samples, 1));
+	}
+	return Bytes;
+}
+
+uint32_t GRenderTargetPool::GetReusedCount(void) const {
+	return m_Reused;
+}
+
+uint32_t GRenderTargetPool::GetCreatedCount(void) const {
+	return m_Created;
+}
+
 //GGaussianKernel
 void GGaussianKernel::MakeKernel(LWVideoDriver *Driver, uint32_t Offset, float Radi, const LWVector2i &FBSize, char *KernelBuffer) {
 	const LWVector4f GFactor = LWVector4f(0.06136f, 0.24477f, 0.38774f, 0.0f);
@@ -63,40 +558,90 @@ bool GElement::operator > (const GElement &E) const {
 
 GElement::GElement(uint32_t Index, float DistanceSq) : m_Index(Index), m_DistanceSq(DistanceSq) {}
 
-//GFramePass
-bool GFramePass::PushElement(uint32_t ID, uint32_t Flag, const LWSVector4f &Position, bool Transparent) {
-	const float Inf = 1000000.0f;
-	const float Near = 0.0f;
-	float DisSq = Position.DistanceSquared3(m_Position);
-	if ((Flag & GFrameModel::ForceDrawFirst) != 0) DisSq = Near;
-	if ((Flag & GFrameModel::ForceDrawLast) != 0) DisSq = Inf;
+//GPassElement
+uint64_t GPassElement::MakeStateKey(const GFrameModel &Mdl) {
+	uint32_t TextureSet = 0x811C9DC5;
+	for (uint32_t i = 0; i < MaxTextures; i++) {
+		TextureSet = (TextureSet ^ Mdl.m_TextureList[i].m_TextureID) * 0x01000193;
+		TextureSet = (TextureSet ^ Mdl.m_TextureList[i].m_TextureState) * 0x01000193;
+	}
+	TextureSet = (TextureSet ^ (TextureSet >> 16)) & 0xFFFF;
+	return ((uint64_t)(Mdl.m_PipelineID & 0xFF) << 29) | ((uint64_t)(Mdl.m_VerticeID & 0x1FFF) << 16) | TextureSet;
+}
 
-	if (Transparent) {
-		uint32_t i = m_TransparentCount.fetch_add(1);
-		if (i >= MaxPassElements) {
-			LogWarn("Transparent list elements has been exhausted.");
-			return false;
-		}
-		m_TransparentElements[i] = GElement(ID, DisSq);
-	} else {
-		uint32_t i = m_OpaqueCount.fetch_add(1);
-		if (i >= MaxPassElements) {
-			LogWarn("Opaque list elements has been exhausted.");
-			return false;
+uint64_t GPassElement::MakeSortKey(uint64_t StateKey, uint32_t Flags, float DistanceSq, bool Transparent) {
+	const uint32_t DepthMask = (1 << DepthBits) - 1;
+	uint64_t Order = (Flags & GFrameModel::ForceDrawFirst) != 0 ? 0 : ((Flags & GFrameModel::ForceDrawLast) != 0 ? 2 : 1);
+	//Positive floats order the same as their bits, the top 24 bits keep the exponent and 16 bits of mantissa.
+	uint32_t DistanceBits;
+	std::memcpy(&DistanceBits, &DistanceSq, sizeof(float));
+	uint64_t Depth = (DistanceBits >> 7) & DepthMask;
+	if (!Transparent) return (Order << OrderBitsOffset) | (StateKey << DepthBits) | Depth;
+	return TransparentBit | (Order << OrderBitsOffset) | ((DepthMask - Depth) << StateBits) | StateKey;
+}
+
+bool GPassElement::isTransparent(void) const {
+	return (m_SortKey & TransparentBit) != 0;
+}
+
+GPassElement::GPassElement(uint32_t Index, uint64_t SortKey) : m_SortKey(SortKey), m_Index(Index) {}
+
+//GPassBatch
+GPassBatch::GPassBatch(uint32_t First, uint32_t Count, uint32_t InstanceID) : m_First(First), m_Count(Count), m_InstanceID(InstanceID) {}
+
+static bool SortKeyLess(const GPassElement &A, const GPassElement &B) {
+	return A.m_SortKey < B.m_SortKey;
+}
+
+//Sorts Elements by their keys with a least significant digit radix sort one byte at a time, Scratch must hold Count elements.
+//Bytes that are the same in every key are skipped, which is most of them for small scenes.
+static void RadixSort(GPassElement *Elements, GPassElement *Scratch, uint32_t Count) {
+	const uint32_t SmallCount = 64;
+	if (Count < SmallCount) {
+		std::sort(Elements, Elements + Count, SortKeyLess);
+		return;
+	}
+	uint32_t Histograms[8][256] = {};
+	for (uint32_t i = 0; i < Count; i++) {
+		uint64_t Key = Elements[i].m_SortKey;
+		for (uint32_t d = 0; d < 8; d++) Histograms[d][(Key >> (d * 8)) & 0xFF]++;
+	}
+	GPassElement *Src = Elements;
+	GPassElement *Dst = Scratch;
+	for (uint32_t d = 0; d < 8; d++) {
+		uint32_t *Histogram = Histograms[d];
+		uint32_t Shift = d * 8;
+		if (Histogram[(Src[0].m_SortKey >> Shift) & 0xFF] == Count) continue;
+		uint32_t Offset = 0;
+		for (uint32_t b = 0; b < 256; b++) {
+			uint32_t BucketCount = Histogram[b];
+			Histogram[b] = Offset;
+			Offset += BucketCount;
 		}
-		m_OpaqueElements[i] = GElement(ID, DisSq);
+		for (uint32_t i = 0; i < Count; i++) Dst[Histogram[(Src[i].m_SortKey >> Shift) & 0xFF]++] = Src[i];
+		std::swap(Src, Dst);
+	}
+	if (Src != Elements) std::copy(Src, Src + Count, Elements);
+	return;
+}
+
+//GFramePass
+bool GFramePass::PushElement(uint32_t ID, uint32_t Flag, uint64_t StateKey, const LWSVector4f &Position, bool Transparent) {
+	float DisSq = Position.DistanceSquared3(m_Position);
+	if (m_ElementCount >= m_Elements.GetCapacity() && !m_Elements.Grow(MaxPassElements, *m_Allocator)) {
+		LogWarn("Pass list elements has been exhausted.");
+		return false;
 	}
+	m_Elements[m_ElementCount++] = GPassElement(ID, GPassElement::MakeSortKey(StateKey, Flag, DisSq, Transparent));
 	return true;
 }
 
 void GFramePass::FinalizePass(uint32_t FrameID) {
 	if (!isInitialized(FrameID)) return;
-	uint32_t TransCnt = std::min<uint32_t>(m_TransparentCount.load(), MaxPassElements);
-	uint32_t OpaqCnt = std::min<uint32_t>(m_OpaqueCount.load(), MaxPassElements);
-	std::sort(m_TransparentElements.begin(), m_TransparentElements.begin() + TransCnt, std::greater<>());
-	std::sort(m_OpaqueElements.begin(), m_OpaqueElements.begin() + OpaqCnt);
-	m_TransparentCount = TransCnt;
-	m_OpaqueCount = OpaqCnt;
+	while (m_SortScratch.GetCapacity() < m_ElementCount && m_SortScratch.Grow(MaxPassElements, *m_Allocator));
+	//The radix sort needs scratch for every element, if it couldn't grow that far the pass is sorted in place instead.
+	if (m_SortScratch.GetCapacity() < m_ElementCount) std::sort(m_Elements.begin(), m_Elements.begin() + m_ElementCount, SortKeyLess);
+	else RadixSort(m_Elements.begin(), m_SortScratch.begin(), m_ElementCount);
 	return;
 }
 
@@ -126,8 +671,8 @@ void GFramePass::Initialize(Camera &Cam, GGlobalData &GlobalBlock, GPassData *Pa
 	//uint32_t Face = OGLFaceMap[TargetFace];
 
 	m_Position = Cam.GetPosition();
-	m_TransparentCount.store(0);
-	m_OpaqueCount.store(0);
+	m_ElementCount = 0;
+	m_BatchCount = 0;
 	m_Flag = (Cam.IsShadowCaster() ? Shadowed : 0) | (Cam.IsPointCamera() ? Point : 0) | (Cam.IsReflection() ? Reflection : 0);
 	if (Cam.IsPointCamera()) {
 		Camera FaceCam = Camera(m_Position, FaceDirs[Face], FaceUps[Face], 1.0f, LW_PI_2, 0.1f, Cam.GetPointPropertys().m_Radius, false);
@@ -180,10 +725,36 @@ bool GFramePass::LightInFrustrum(const Light &L) {
 	return false;
 }
 
+//Reallocates a padded uniform staging buffer to hold Capacity elements, keeping the Count elements already written.
+template<class Type>
+static void GrowPaddedBuffer(LWVideoDriver *Driver, char *&Buffer, uint32_t Count, uint32_t Capacity, LWAllocator &Allocator) {
+	char *Data = Driver->AllocatePadded<Type>(Capacity, Allocator);
+	if (Buffer) {
+		std::copy(Buffer, Buffer + Driver->GetUniformPaddedLength<Type>(Count), Data);
+		LWAllocator::Destroy(Buffer);
+	}
+	Buffer = Data;
+	return;
+}
+
+//Reallocates a packed staging buffer to hold Capacity elements, keeping the Count elements already written.
+template<class Type>
+static void GrowBuffer(Type *&Buffer, uint32_t Count, uint32_t Capacity, LWAllocator &Allocator) {
+	Type *Data = Allocator.Allocate<Type>(Capacity);
+	if (Buffer) {
+		std::copy(Buffer, Buffer + Count, Data);
+		LWAllocator::Destroy(Buffer);
+	}
+	Buffer = Data;
+	return;
+}
+
 //GFrame
 GFrame &GFrame::InitializeFrame(uint32_t FrameID) {
 	m_UIFrame.m_TextureCount = 0;
 	m_ModelCount = 0;
+	m_MaterialCount = 0;
+	m_InstanceCount = 0;
 	m_AnimCount = 0;
 	m_LightCount = 0;
 	m_ParticleCount = 0;
@@ -191,29 +762,86 @@ GFrame &GFrame::InitializeFrame(uint32_t FrameID) {
 	m_RawPassCount = 0;
 	m_ReflectionBits = 0;
 	m_TargetTextureSize = LWVector2i(0);
+	m_TargetLayers = 0;
 	m_ViewBounds = LWVector4f(0.0f);
 	m_TargetViewBounds = LWVector4i(0);
 	m_FrameID = FrameID;
 	return *this;
 }
 
-GFrame &GFrame::FinalizeFrame(void) {
+GFrame &GFrame::FinalizeFrame(WorkerPool &Pool) {
 	m_UIFrame.m_Mesh->Finished();
 	m_GlobalData.LightCount = m_LightCount;
-	for (uint32_t i = 0; i < MaxRawPasses; i++) m_PassList[i].FinalizePass(m_FrameID);
+	//Each worker claims the next pass to sort until none are left, small frames sort on this thread only.
+	uint32_t ElementCount = 0;
+	for (auto &&P : m_PassList) ElementCount += P.isInitialized(m_FrameID) ? P.m_ElementCount : 0;
+	if (ElementCount >= ParallelSortElements) Pool.Run(MaxRawPasses, [this](uint32_t Pass, uint32_t) { m_PassList[Pass].FinalizePass(m_FrameID); });
+	else {
+		for (auto &&P : m_PassList) P.FinalizePass(m_FrameID);
+	}
+	BuildPassBatches();
 	return *this;
 }
 
+void GFrame::BuildPassBatches(void) {
+	m_InstanceCount = 0;
+	for (auto &&P : m_PassList) {
+		if (!P.isInitialized(m_FrameID)) continue;
+		P.m_BatchCount = 0;
+		//Elements with the same state are next to each other once sorted, so each batch is a run of elements that can be instanced together.
+		for (uint32_t i = 0; i < P.m_ElementCount;) {
+			const GPassElement &First = P.m_Elements[i];
+			uint32_t n = i + 1;
+			for (; n < P.m_ElementCount && n - i < MaxInstances; n++) {
+				const GPassElement &E = P.m_Elements[n];
+				if (E.isTransparent() != First.isTransparent() || !CanInstance(First.m_Index, E.m_Index)) break;
+			}
+			uint32_t InstanceID = -1;
+			if (n - i > 1 && (m_InstanceCount < m_InstanceCapacity || m_InstanceCapacity < MaxInstanceBlocks)) {
+				if (m_InstanceCount >= m_InstanceCapacity) {
+					uint32_t Capacity = std::min<uint32_t>(std::max<uint32_t>(m_InstanceCapacity * 2, InitialInstanceBlocks), MaxInstanceBlocks);
+					GrowPaddedBuffer<GInstanceData>(m_Driver, m_InstanceDataBuffer, m_InstanceCount, Capacity, *m_Allocator);
+					m_InstanceCapacity = Capacity;
+				}
+				InstanceID = m_InstanceCount++;
+				GInstanceData *I = GetInstanceDataAt(InstanceID);
+				for (uint32_t k = i; k < n; k++) I->InstanceTransforms[k - i] = GetModelDataAt(P.m_Elements[k].m_Index)->TransformMatrix;
+			}
+			if (P.m_BatchCount >= P.m_Batches.GetCapacity() && !P.m_Batches.Grow(MaxPassElements, *m_Allocator)) break;
+			P.m_Batches[P.m_BatchCount++] = GPassBatch(i, n - i, InstanceID);
+			i = n;
+		}
+	}
+	return;
+}
+
+bool GFrame::CanInstance(uint32_t ModelA, uint32_t ModelB) {
+	const GFrameModel &A = m_ModelList[ModelA];
+	const GFrameModel &B = m_ModelList[ModelB];
+	if (A.m_VerticeID != B.m_VerticeID || A.m_IndiceID != B.m_IndiceID || A.m_PipelineID != B.m_PipelineID) return false;
+	if (A.m_Offset != B.m_Offset || A.m_Count != B.m_Count || A.m_Flags != B.m_Flags) return false;
+	//Materials are shared with their textures, so models with the same material index also have the same textures.
+	return GetModelDataAt(ModelA)->MaterialIndex == GetModelDataAt(ModelB)->MaterialIndex;
+}
+
 GPassData *GFrame::GetPassDataAt(uint32_t i) {
 	return m_Driver->GetUniformPaddedAt<GPassData>(i, m_PassDataBuffer);
 }
 
 GModelData *GFrame::GetModelDataAt(uint32_t i) {
-	return m_Driver->GetUniformPaddedAt<GModelData>(i, m_ModelDataBuffer);
+	return m_ModelDataBuffer + i;
 }
 
 GAnimData *GFrame::GetAnimDataAt(uint32_t i) {
-	return m_Driver->GetUniformPaddedAt<GAnimData>(i, m_AnimDataBuffer);
+	return m_AnimDataBuffer + i;
+}
+
+GMaterial *GFrame::GetMaterialAt(uint32_t i) {
+	return m_MaterialBuffer + i;
+}
+
+GInstanceData *GFrame::GetInstanceDataAt(uint32_t i) {
+	return m_Driver->GetUniformPaddedAt<GInstanceData>(i, m_InstanceDataBuffer);
 }
 
 GFrame &GFrame::InitializeShadowPosition(const LWSVector4f &ShadowPos) {
@@ -256,7 +884,7 @@ GFrame &GFrame::InitializeRTPasses(const LWSVector4f &SceneAABBMin, const LWSVec
 		Camera CascadeList[CascadeCount];
 		if (ArrayCount >= MaxShadowRTs) return 0;
 		uint32_t Cnt = std::min<uint32_t>(CascadeCount, std::min<uint32_t>(MaxPasses - POffset, MaxArrayElements - ArrayCount));
-		Camera::MakeCascadeCameraViews(GL.m_Direction, MV.m_Position, MVP->FrustrumPoints, m_GlobalData.ProjViewMatrixs[MainViewPass], CascadeList, Cnt, SceneAABBMin, SceneAABBMax);
+		Camera::MakeCascadeCameraViews(GL.m_Direction, MV.m_Position, MVP->FrustrumPoints, CascadeList, Cnt, SceneAABBMin, SceneAABBMax, m_ShadowMapSize);
 		uint32_t Bits = 0;
 		for (uint32_t i = 0; i < Cnt; i++) Bits |= InitializePass(POffset + i, ArrayCount++, 0, LightIndex, CascadeList[i]);
 		GL.m_ShadowIdxs.x = POffset++;
@@ -301,19 +929,25 @@ GFrame &GFrame::InitializeRTPasses(const LWSVector4f &SceneAABBMin, const LWSVec
 	return *this;
 }
 
-uint32_t GFrame::NextAnimation(void) {
-	if(m_AnimCount>=MaxAnimations){
+bool GFrame::ReserveAnimation(void) {
+	if (m_AnimCount < m_AnimCapacity) return true;
+	if (m_AnimCapacity >= MaxAnimations) {
 		LogWarn("GAnimData has been exhausted.");
-		return -1;
+		return false;
 	}
+	uint32_t Capacity = std::min<uint32_t>(std::max<uint32_t>(m_AnimCapacity * 2, InitialAnimations), MaxAnimations);
+	GrowBuffer(m_AnimDataBuffer, m_AnimCount, Capacity, *m_Allocator);
+	m_AnimCapacity = Capacity;
+	return true;
+}
+
+uint32_t GFrame::NextAnimation(void) {
+	if (!ReserveAnimation()) return -1;
 	return m_AnimCount++;
 }
 
 uint32_t GFrame::PushAnimation(LWSMatrix4f *BoneMatrixs, uint32_t BoneCount) {
-	if(m_AnimCount>=MaxAnimations){
-		LogWarn("GAnimData has been exhausted.");
-		return -1;
-	}
+	if (!ReserveAnimation()) return -1;
 	GAnimData *A = GetAnimDataAt(m_AnimCount);
 	std::copy(BoneMatrixs, BoneMatrixs + BoneCount, A->BoneMatrixs);
 	return m_AnimCount++;
@@ -340,24 +974,69 @@ uint32_t GFrame::PassBitsInAABB(const LWSVector4f &AAMin, const LWSVector4f &AAM
 }
 
 uint32_t GFrame::PushModel(GFrameModel &Mdl, uint32_t PassBits, uint32_t AnimID, const LWSMatrix4f &Transform, const GMaterial &Material, bool Transparent) {
-	if(m_ModelCount>=MaxModels){
-		LogWarn("GFrameModel has been exhausted.");
-		return -1;
+	if (m_ModelCount >= m_ModelList.GetCapacity()) {
+		if (!m_ModelList.Grow(MaxModels, *m_Allocator)) {
+			LogWarn("GFrameModel has been exhausted.");
+			return -1;
+		}
+		GrowBuffer(m_ModelDataBuffer, m_ModelCount, m_ModelList.GetCapacity(), *m_Allocator);
+		GrowBuffer(m_MaterialBuffer, m_MaterialCount, m_ModelList.GetCapacity(), *m_Allocator);
+		GrowBuffer(m_MaterialModels, m_MaterialCount, m_ModelList.GetCapacity(), *m_Allocator);
+		GrowMaterialTable();
 	}
-	GModelData *M = GetModelDataAt(m_ModelCount);
-	M->TransformMatrix = Transform;
-	M->Material = Material;
 	m_ModelList[m_ModelCount] = Mdl;
 	m_ModelList[m_ModelCount].SetBufferIDs(m_ModelCount, AnimID);
+	GModelData *M = GetModelDataAt(m_ModelCount);
+	M->TransformMatrix = Transform;
+	M->MaterialIndex = PushMaterial(Material, m_ModelCount);
+	M->AnimID = AnimID;
 	LWSVector4f Pos = Transform[3];
+	uint64_t StateKey = GPassElement::MakeStateKey(Mdl);
 	for(uint32_t i=0;i<MaxRawPasses;i++){
 		if (((1<<i)&PassBits)==0) continue;
 		if(!m_PassList[i].isInitialized(m_FrameID)) continue;
-		m_PassList[i].PushElement(m_ModelCount, Mdl.m_Flags, Pos, Transparent);
+		m_PassList[i].PushElement(m_ModelCount, Mdl.m_Flags, StateKey, Pos, Transparent);
 	}
 	return m_ModelCount++;
 }
 
+uint32_t GFrame::PushMaterial(const GMaterial &Material, uint32_t ModelID) {
+	//The material is written to the next free element, and only kept if the lookup doesn't find it.
+	GMaterial *Mat = GetMaterialAt(m_MaterialCount);
+	*Mat = Material;
+	std::fill(Mat->TextureLayers, Mat->TextureLayers + 3, 0); //Layers follow from the textures, and are written once the frame is applied.
+	const GFrameModel &Mdl = m_ModelList[ModelID];
+	uint64_t Hash = SpriteHasher().Push(*Mat).Push(Mdl.m_TextureList).Get();
+	uint32_t Mask = m_ModelList.GetCapacity() * 2 - 1;
+	for (uint32_t i = (uint32_t)Hash & Mask;; i = (i + 1) & Mask) {
+		GMaterialSlot &S = m_MaterialTable[i];
+		if (S.m_FrameID != m_FrameID) {
+			S = { Hash, m_FrameID, m_MaterialCount };
+			m_MaterialModels[m_MaterialCount] = ModelID;
+			return m_MaterialCount++;
+		}
+		if (S.m_Hash != Hash) continue;
+		if (std::memcmp(GetMaterialAt(S.m_Index), Mat, sizeof(GMaterial))) continue;
+		if (std::memcmp(m_ModelList[m_MaterialModels[S.m_Index]].m_TextureList, Mdl.m_TextureList, sizeof(Mdl.m_TextureList))) continue;
+		return S.m_Index;
+	}
+}
+
+void GFrame::GrowMaterialTable(void) {
+	uint32_t Count = m_ModelList.GetCapacity() * 2;
+	if (m_MaterialTable) LWAllocator::Destroy(m_MaterialTable);
+	m_MaterialTable = m_Allocator->Allocate<GMaterialSlot>(Count);
+	std::fill(m_MaterialTable, m_MaterialTable + Count, GMaterialSlot());
+	uint32_t Mask = Count - 1;
+	for (uint32_t m = 0; m < m_MaterialCount; m++) {
+		uint64_t Hash = SpriteHasher().Push(*GetMaterialAt(m)).Push(m_ModelList[m_MaterialModels[m]].m_TextureList).Get();
+		uint32_t i = (uint32_t)Hash & Mask;
+		while (m_MaterialTable[i].m_FrameID == m_FrameID) i = (i + 1) & Mask;
+		m_MaterialTable[i] = { Hash, m_FrameID, m };
+	}
+	return;
+}
+
 uint32_t GFrame::PushLight(const Light &L) {
 	if(m_LightCount>=MaxLights){
 		LogWarn("Lights has been exhausted.");
@@ -392,12 +1071,21 @@ uint32_t GFrame::WriteParticles(uint32_t Count) {
 	return P;
 }
 
-GFrame::GFrame(LWVideoDriver *Driver, LWAllocator &Allocator) : m_Driver(Driver) {
+uint32_t GFrame::GetStorageSize(void) const {
+	uint32_t Size = m_ModelList.GetStorageSize() + sizeof(ParticleVert) * MaxParticleVertices + sizeof(GLight) * MaxLights;
+	Size += m_Driver->GetUniformPaddedLength<GPassData>(MaxRawPasses) + sizeof(GModelData) * m_ModelList.GetCapacity() + sizeof(GAnimData) * m_AnimCapacity;
+	Size += (sizeof(GMaterial) + sizeof(uint32_t) + sizeof(GMaterialSlot) * 2) * m_ModelList.GetCapacity();
+	Size += m_Driver->GetUniformPaddedLength<GInstanceData>(m_InstanceCapacity);
+	for (auto &&P : m_PassList) Size += P.m_Elements.GetStorageSize() + P.m_SortScratch.GetStorageSize() + P.m_Batches.GetStorageSize();
+	return Size;
+}
+
+GFrame::GFrame(LWVideoDriver *Driver, LWAllocator &Allocator) : m_Driver(Driver), m_Allocator(&Allocator) {
 	LWVideoBuffer *UIVerts = m_Driver->CreateVideoBuffer<LWVertexUI>(LWVideoBuffer::Vertex, LWVideoBuffer::WriteDiscardable | LWVideoBuffer::LocalCopy, MaxUIElements * 6, Allocator, nullptr);
 	m_UIFrame.m_Mesh = LWVertexUI::MakeMesh(Allocator, UIVerts, 0);
+	//Model and animation data are allocated as they're written, and grow with the draw lists.
 	m_PassDataBuffer = m_Driver->AllocatePadded<GPassData>(MaxRawPasses, Allocator);
-	m_ModelDataBuffer = m_Driver->AllocatePadded<GModelData>(MaxModels, Allocator);
-	m_AnimDataBuffer = m_Driver->AllocatePadded<GAnimData>(MaxAnimations, Allocator);
+	for (auto &&P : m_PassList) P.m_Allocator = &Allocator;
 	m_ParticleVertices = Allocator.Allocate<ParticleVert>(MaxParticleVertices);
 	m_LightsBuffer = Allocator.Allocate<GLight>(MaxLights);
 }
@@ -405,8 +1093,12 @@ GFrame::GFrame(LWVideoDriver *Driver, LWAllocator &Allocator) : m_Driver(Driver)
 GFrame::~GFrame() {
 	m_UIFrame.m_Mesh->Destroy(m_Driver);
 	LWAllocator::Destroy(m_PassDataBuffer);
-	LWAllocator::Destroy(m_ModelDataBuffer);
-	LWAllocator::Destroy(m_AnimDataBuffer);
+	if (m_ModelDataBuffer) LWAllocator::Destroy(m_ModelDataBuffer);
+	if (m_AnimDataBuffer) LWAllocator::Destroy(m_AnimDataBuffer);
+	if (m_MaterialBuffer) LWAllocator::Destroy(m_MaterialBuffer);
+	if (m_MaterialModels) LWAllocator::Destroy(m_MaterialModels);
+	if (m_MaterialTable) LWAllocator::Destroy(m_MaterialTable);
+	if (m_InstanceDataBuffer) LWAllocator::Destroy(m_InstanceDataBuffer);
 	LWAllocator::Destroy(m_ParticleVertices);
 	LWAllocator::Destroy(m_LightsBuffer);
 }
@@ -418,69 +1110,98 @@ Renderer &Renderer::SizeUpdated(LWWindow *Window) {
 	LWMatrix4f UIOrtho = LWMatrix4f::Ortho(0.0f, WndSize.x, 0.0f, WndSize.y, 0.0f, 1.0f);
 	m_Driver->UpdateVideoBuffer(m_UIUniform, (const uint8_t*)&UIOrtho, sizeof(LWMatrix4f));
 
+	//Settings changes also land here, targets are only rebuilt if the size or sample count they depend on changed.
+	LWVector2i TargetSize = Window->GetSize();
+	uint32_t Samples = std::max<uint32_t>(m_Settings.m_SampleCount, 1);
+	if (m_ScreenFB && m_ScreenFB->GetSize() == TargetSize && Samples == m_TargetSamples) {
+		m_SizeChanged = false;
+		return *this;
+	}
+	//While the window is dragged the old targets are stretched over it, they're only rebuilt once it's size holds for ResizeSettleFrames. Offscreen renders copy sprites out of them, so they never wait.
+	if (m_ScreenFB && m_ScreenFB->GetSize() != TargetSize && !m_Offscreen) {
+		if (TargetSize != m_SettlingSize) {
+			m_SettlingSize = TargetSize;
+			m_SettlingFrames = 0;
+		}
+		if (++m_SettlingFrames < ResizeSettleFrames) return *this;
+	}
+	m_TargetSamples = Samples;
+
 	LWVector2i TileSize = LWVector2i(32, 32);
 	LWVector2i LocalThreads = LWVector2i(32, 32);
-	LWVector2i TexSize = (Window->GetSize() + (TileSize - 1)) / TileSize;
+	LWVector2i TexSize = (TargetSize + (TileSize - 1)) / TileSize;
 	LWVector2i TotalThreads = (TexSize + (LocalThreads - 1)) / LocalThreads;
 
 	for (uint32_t i = 0; i < MaxFrames; i++) {
-		m_Frames[i].m_GlobalData.ScreenSize = WndSize;
+		m_Frames[i].m_GlobalData.ScreenSize = TargetSize.CastTo<float>();
 		m_Frames[i].m_GlobalData.ThreadDimensions = TotalThreads;
 		m_Frames[i].m_GlobalData.TileSize = TileSize;
 	}
-	LWVideoBuffer *oLightArray = m_LightArrayBuffer;
-	m_LightArrayBuffer = m_Driver->CreateVideoBuffer<uint32_t>(LWVideoBuffer::ImageBuffer, LWVideoBuffer::GPUResource, MaxLightsPerTile * (TotalThreads.x * TotalThreads.y * LocalThreads.x * LocalThreads.y), m_Allocator, nullptr);
-	m_LightCullPipeline->SetResource("LightArray", m_LightArrayBuffer);
-	m_MetallicRoughnessPipeline->SetResource("LightArray", m_LightArrayBuffer);
-	m_SpecularGlossinessPipeline->SetResource("LightArray", m_LightArrayBuffer);
-
-	if (oLightArray) m_Driver->DestroyVideoBuffer(oLightArray);
+	//The light array only grows, so shrinking the window never reallocates it.
+	uint32_t LightArrayLength = MaxLightsPerTile * (TotalThreads.x * TotalThreads.y * LocalThreads.x * LocalThreads.y);
+	if (LightArrayLength > m_LightArrayLength) {
+		LWVideoBuffer *oLightArray = m_LightArrayBuffer;
+		m_LightArrayBuffer = m_Driver->CreateVideoBuffer<uint32_t>(LWVideoBuffer::ImageBuffer, LWVideoBuffer::GPUResource, LightArrayLength, m_Allocator, nullptr);
+		m_LightCullPipeline->SetResource("LightArray", m_LightArrayBuffer);
+		m_MetallicRoughnessPipeline->SetResource("LightArray", m_LightArrayBuffer);
+		m_SpecularGlossinessPipeline->SetResource("LightArray", m_LightArrayBuffer);
+
+		if (oLightArray) m_Driver->DestroyVideoBuffer(oLightArray);
+		m_LightArrayLength = LightArrayLength;
+		m_GPUMemory.Set(GPUMemoryReport::LightArray, (uint64_t)LightArrayLength * sizeof(uint32_t));
+	}
 
+	//Targets go back to the pool, so returning to a recent size or sample count reuses them.
+	const uint32_t TargetFlags = LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::RenderTarget;
 	if (m_ScreenFB) {
 		m_Driver->DestroyFrameBuffer(m_ScreenFB);
-		m_Driver->DestroyTexture(m_ScreenTex);
-		m_Driver->DestroyTexture(m_FinalScreenTex);
-		m_Driver->DestroyTexture(m_ScreenTexMS);
-		m_Driver->DestroyTexture(m_EmissionTex);
-		m_Driver->DestroyTexture(m_EmissionTexMS);
-		m_Driver->DestroyTexture(m_ScreenDepth);
-	}
-	m_ScreenFB = m_Driver->CreateFrameBuffer(WndSize.CastTo<int32_t>(), m_Allocator);
-	m_ScreenTexMS = m_Driver->CreateTexture2DMS(LWTexture::RenderTarget, LWImage::RGBA8, m_ScreenFB->GetSize(), m_Settings.m_SampleCount, m_Allocator);
-	m_ScreenTex = m_Driver->CreateTexture2D(LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::RenderTarget, LWImage::RGBA8, m_ScreenFB->GetSize(), nullptr, 0, m_Allocator);
-	m_FinalScreenTex = m_Driver->CreateTexture2D(LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::RenderTarget, LWImage::RGBA8, m_ScreenFB->GetSize(), nullptr, 0, m_Allocator);
-	m_EmissionTexMS = m_Driver->CreateTexture2DMS(LWTexture::RenderTarget, LWImage::RGBA8, m_ScreenFB->GetSize(), m_Settings.m_SampleCount, m_Allocator);
-	m_EmissionTex = m_Driver->CreateTexture2D(LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::RenderTarget, LWImage::RGBA8, m_ScreenFB->GetSize(), nullptr, 0, m_Allocator);
-	m_ScreenDepth = m_Driver->CreateTexture2DMS(LWTexture::RenderTarget, LWImage::DEPTH24STENCIL8, m_ScreenFB->GetSize(), m_Settings.m_SampleCount, m_Allocator);
+		m_RenderTargets.Release(m_ScreenTex);
+		m_RenderTargets.Release(m_ScreenTexMS);
+		m_RenderTargets.Release(m_EmissionTex);
+		m_RenderTargets.Release(m_EmissionTexMS);
+		m_RenderTargets.Release(m_ScreenDepth);
+	}
+	m_ScreenFB = m_Driver->CreateFrameBuffer(TargetSize, m_Allocator);
+	LWVector2i ScreenSize = m_ScreenFB->GetSize();
+	m_ScreenTexMS = m_RenderTargets.Acquire(m_Driver, LWTexture::RenderTarget, LWImage::RGBA8, ScreenSize, Samples, m_Allocator);
+	m_ScreenTex = m_RenderTargets.Acquire(m_Driver, TargetFlags, LWImage::RGBA8, ScreenSize, 0, m_Allocator);
+	m_EmissionTexMS = m_RenderTargets.Acquire(m_Driver, LWTexture::RenderTarget, LWImage::RGBA8, ScreenSize, Samples, m_Allocator);
+	m_EmissionTex = m_RenderTargets.Acquire(m_Driver, TargetFlags, LWImage::RGBA8, ScreenSize, 0, m_Allocator);
+	m_ScreenDepth = m_RenderTargets.Acquire(m_Driver, LWTexture::RenderTarget, LWImage::DEPTH24STENCIL8, ScreenSize, Samples, m_Allocator);
+	//Emission is consumed by it's blur before the composite writes the final image, so they share memory.
+	m_FinalScreenTex = m_EmissionTex;
+	m_GPUMemory.Set(GPUMemoryReport::ScreenTargets, GPUMemoryReport::TextureBytes(ScreenSize, 3, Samples) + GPUMemoryReport::TextureBytes(ScreenSize, 2));
 
 	if (m_HighlightFB) {
 		m_Driver->DestroyFrameBuffer(m_HighlightFB);
-		m_Driver->DestroyTexture(m_HighlightTex);
-		m_Driver->DestroyTexture(m_HighlightTexMS);
+		m_RenderTargets.Release(m_HighlightTex);
 	}
-	LWVector2i HighlightSize = WndSize.CastTo<int32_t>();
+	LWVector2i HighlightSize = TargetSize;
 	m_HighlightFB = m_Driver->CreateFrameBuffer(HighlightSize, m_Allocator);
-	m_HighlightTex = m_Driver->CreateTexture2D(LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::RenderTarget, LWImage::RGBA8, HighlightSize, nullptr, 0, m_Allocator);
-	m_HighlightTexMS = m_Driver->CreateTexture2DMS(LWTexture::RenderTarget, LWImage::RGBA8, HighlightSize, m_Settings.m_SampleCount, m_Allocator);
+	m_HighlightTex = m_RenderTargets.Acquire(m_Driver, TargetFlags, LWImage::RGBA8, HighlightSize, 0, m_Allocator);
+	//Multisampled emission is resolved before the highlight pass draws, so they share memory.
+	m_HighlightTexMS = m_EmissionTexMS;
+	m_GPUMemory.Set(GPUMemoryReport::HighlightTargets, GPUMemoryReport::TextureBytes(HighlightSize));
 
 	if (m_BlurFB) {
 		m_Driver->DestroyFrameBuffer(m_BlurFB);
-		m_Driver->DestroyTexture(m_BlurTempTexture);
-		m_Driver->DestroyTexture(m_BEmissionTexture);
-		m_Driver->DestroyTexture(m_BHighlightTexture);
+		m_RenderTargets.Release(m_BlurTempTexture);
+		m_RenderTargets.Release(m_BEmissionTexture);
+		m_RenderTargets.Release(m_BHighlightTexture);
 	}
-	LWVector2i BlurSize = (WndSize / 2).CastTo<int32_t>();
+	LWVector2i BlurSize = TargetSize / 2;
 	m_BlurFB = m_Driver->CreateFrameBuffer(BlurSize, m_Allocator);
-	m_BlurTempTexture = m_Driver->CreateTexture2D(LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::RenderTarget, LWImage::RGBA8, BlurSize, nullptr, 0, m_Allocator);
-	m_BEmissionTexture = m_Driver->CreateTexture2D(LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::RenderTarget, LWImage::RGBA8, BlurSize, nullptr, 0, m_Allocator);
-	m_BHighlightTexture = m_Driver->CreateTexture2D(LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::RenderTarget, LWImage::RGBA8, BlurSize, nullptr, 0, m_Allocator);
-
+	m_BlurTempTexture = m_RenderTargets.Acquire(m_Driver, TargetFlags, LWImage::RGBA8, BlurSize, 0, m_Allocator);
+	m_BEmissionTexture = m_RenderTargets.Acquire(m_Driver, TargetFlags, LWImage::RGBA8, BlurSize, 0, m_Allocator);
+	m_BHighlightTexture = m_RenderTargets.Acquire(m_Driver, TargetFlags, LWImage::RGBA8, BlurSize, 0, m_Allocator);
+	m_GPUMemory.Set(GPUMemoryReport::BlurTargets, GPUMemoryReport::TextureBytes(BlurSize, 3));
 
+	//The kernel is rewritten in place rather than recreated.
 	uint32_t KernelSize = m_Driver->GetUniformPaddedLength<GGaussianKernel>(GaussianKernelCount);
 	char *GKernel = m_Allocator.Allocate<char>(KernelSize);
-	GGaussianKernel::MakeKernel(m_Driver, ScreenGaussianKernel, 10.0f, m_ScreenFB->GetSize(), GKernel);
-	if (m_GaussianKernel) m_Driver->DestroyVideoBuffer(m_GaussianKernel);
-	m_GaussianKernel = m_Driver->CreatePaddedVideoBuffer<GGaussianKernel>(LWVideoBuffer::Uniform, LWVideoBuffer::Static, GaussianKernelCount, m_Allocator, GKernel);
+	GGaussianKernel::MakeKernel(m_Driver, ScreenGaussianKernel, 10.0f, ScreenSize, GKernel);
+	if (!m_GaussianKernel) m_GaussianKernel = m_Driver->CreatePaddedVideoBuffer<GGaussianKernel>(LWVideoBuffer::Uniform, LWVideoBuffer::WriteDiscardable, GaussianKernelCount, m_Allocator, GKernel);
+	else m_Driver->UpdateVideoBuffer(m_GaussianKernel, (const uint8_t*)GKernel, KernelSize);
 	LWAllocator::Destroy(GKernel);
 
 	m_SizeChanged = false;
@@ -494,6 +1215,16 @@ Renderer &Renderer::LoadAssets(LWEAssetManager *AssetMan) {
 
 	m_StaticVertexShader = AssetMan->GetAsset<LWShader>("StaticVertexShader");
 	m_SkeletonVertexShader = AssetMan->GetAsset<LWShader>("SkeletonVertexShader");
+	m_InstancedVertexShader = AssetMan->GetAsset<LWShader>("InstancedVertexShader");
+
+	m_PBRMetallicShader = AssetMan->GetAsset<LWShader>("PBRMetallicShader");
+	m_PBRSpecularGlossinessShader = AssetMan->GetAsset<LWShader>("PBRSpecularGlossinessShader");
+	m_PBRUnlitShader = AssetMan->GetAsset<LWShader>("PBRUnlitShader");
+	m_SkyboxShader = AssetMan->GetAsset<LWShader>("SkyboxShader");
+	m_PBRMetallicArrayShader = AssetMan->GetAsset<LWShader>("PBRMetallicArrayShader");
+	m_PBRSpecularGlossinessArrayShader = AssetMan->GetAsset<LWShader>("PBRSpecularGlossinessArrayShader");
+	m_PBRUnlitArrayShader = AssetMan->GetAsset<LWShader>("PBRUnlitArrayShader");
+	m_SkyboxArrayShader = AssetMan->GetAsset<LWShader>("SkyboxArrayShader");
 
 	m_MetallicRoughnessPipeline = AssetMan->GetAsset<LWPipeline>("MetallicRoughnessPipeline");
 	m_SpecularGlossinessPipeline = AssetMan->GetAsset<LWPipeline>("SpecularGlossinessPipeline");
@@ -520,12 +1251,12 @@ Renderer &Renderer::LoadAssets(LWEAssetManager *AssetMan) {
 	m_ShadowPipeline->SetResource("Lights", m_LightDataBuffer);
 
 	m_LightCullPipeline->SetUniformBlock(0, m_GlobalDataBlock);
-	m_LightCullPipeline->SetUniformBlock(1, m_PassDataBlock);
 	m_LightCullPipeline->SetResource("Lights", m_LightDataBuffer);
 
 	m_UIPipeline = AssetMan->GetAsset<LWPipeline>("UIPipeline");
 	m_UIPipeline->SetUniformBlock(0, m_UIUniform);
 
+	if (m_Settings.m_TextureArrays) ApplyTextureMode();
 	return *this;
 }
 
@@ -541,66 +1272,160 @@ Renderer &Renderer::EndFrame(void) {
 	return *this;
 }
 
-LWPipeline *Renderer::PreparePipeline(GFrame &F, const GFrameModel &Mdl, bool isSkinned, bool Transparent, bool IsShadowed) {
-	auto ApplyFlagsToPipeline = [this](LWPipeline *P, LWShader *VertexShader, uint32_t Flags, bool Transparent) -> LWPipeline* {
-		P->SetVertexShader(VertexShader);
-		P->SetBlendMode(Transparent || (Flags&GFrameModel::ForceTransparency)!=0, LWPipeline::BLEND_SRC_ALPHA, LWPipeline::BLEND_ONE_MINUS_SRC_ALPHA);
-		P->SetDepthOutput((Flags & GFrameModel::NoDepthOut) == 0);
-		m_Driver->UpdatePipelineStages(P);
+LWPipeline *Renderer::PreparePipeline(GFrame &F, const GFrameModel &Mdl, bool isSkinned, bool Transparent, bool IsShadowed, bool isInstanced) {
+	//Only state that differs from what was last applied to the pipeline is sent to the driver.
+	auto ApplyFlagsToPipeline = [this](LWPipeline *P, GPipelineState &S, LWShader *VertexShader, uint32_t Flags, bool Transparent) -> LWPipeline* {
+		bool Blending = Transparent || (Flags & GFrameModel::ForceTransparency) != 0;
+		bool DepthOutput = (Flags & GFrameModel::NoDepthOut) == 0;
+		bool Changed = false;
+		if (P != m_LastPipeline) m_Stats.m_PipelineSwitches++;
+		m_LastPipeline = P;
+		if (S.m_VertexShader != VertexShader) {
+			P->SetVertexShader(VertexShader);
+			S.m_VertexShader = VertexShader;
+			Changed = true;
+		} else m_Stats.m_RedundantSkipped++;
+		if (!S.m_Applied || S.m_Blending != Blending) {
+			P->SetBlendMode(Blending, LWPipeline::BLEND_SRC_ALPHA, LWPipeline::BLEND_ONE_MINUS_SRC_ALPHA);
+			S.m_Blending = Blending;
+			Changed = true;
+		} else m_Stats.m_RedundantSkipped++;
+		if (!S.m_Applied || S.m_DepthOutput != DepthOutput) {
+			P->SetDepthOutput(DepthOutput);
+			S.m_DepthOutput = DepthOutput;
+			Changed = true;
+		} else m_Stats.m_RedundantSkipped++;
+		S.m_Applied = true;
+		if (Changed) {
+			m_Driver->UpdatePipelineStages(P);
+			//Updated stages may remap the pipeline's blocks and resources, so they have to be bound again.
+			S.m_PassOffset = -1;
+			S.m_ModelList = S.m_AnimList = S.m_MaterialList = nullptr;
+		} else m_Stats.m_RedundantSkipped++;
 		return P;
 	};
-	auto ApplyTexture = [this](LWPipeline *P, const GFrameModel &Mdl, uint32_t TexID, uint32_t RscOffset) {
+	auto ApplyTexture = [this](LWPipeline *P, GPipelineState &S, const GFrameModel &Mdl, uint32_t TexID, uint32_t RscOffset) {
 		const GModelTexture &T = Mdl.m_TextureList[TexID];
-		LWTexture *Tex = nullptr;
-		auto Iter = m_TextureMap.find(T.m_TextureID);
-		if (Iter != m_TextureMap.end()) {
-			Tex = Iter->second;
-			if (Tex) Tex->SetTextureState(T.m_TextureState);
+		bool Bound = (S.m_BoundTextures & (1 << TexID)) != 0;
+		LWTexture *Tex = S.m_Textures[TexID];
+		if (!Bound || S.m_TextureIDs[TexID] != T.m_TextureID) {
+			LWTexture **Slot = m_TextureSlots.Find(T.m_TextureID);
+			Tex = Slot ? *Slot : nullptr;
+		}
+		if (Tex) {
+			if (Tex->GetTextureState() != T.m_TextureState) Tex->SetTextureState(T.m_TextureState);
+			else m_Stats.m_RedundantSkipped++;
 		}
-		P->SetResource(RscOffset + TexID, Tex);
+		if (!Bound || S.m_Textures[TexID] != Tex) {
+			P->SetResource(RscOffset + TexID, Tex);
+			m_Stats.m_ResourceBinds++;
+		} else m_Stats.m_RedundantSkipped++;
+		S.m_Textures[TexID] = Tex;
+		S.m_TextureIDs[TexID] = T.m_TextureID;
+		S.m_BoundTextures |= 1 << TexID;
 	};
-	LWShader *VertShader = isSkinned ? m_SkeletonVertexShader : m_StaticVertexShader;
+	LWShader *VertShader = isSkinned ? m_SkeletonVertexShader : (isInstanced ? m_InstancedVertexShader : m_StaticVertexShader);
 
-	if (IsShadowed) return ApplyFlagsToPipeline(m_ShadowPipeline, VertShader, Mdl.m_Flags, false);
+	GPipelineState &S = GetPipelineState(Mdl, IsShadowed);
+	if (IsShadowed) return ApplyFlagsToPipeline(m_ShadowPipeline, S, VertShader, Mdl.m_Flags, false);
 	LWPipeline *P = nullptr;
 	if (Mdl.m_PipelineID == Material::PBRMetallicRoughness) {
 		P = m_MetallicRoughnessPipeline;
-		ApplyTexture(P, Mdl, GMaterial::NormalTexID, MetallicRoughnessTexOffset);
-		ApplyTexture(P, Mdl, GMaterial::OcclussionTexID, MetallicRoughnessTexOffset);
-		ApplyTexture(P, Mdl, GMaterial::EmissiveTexID, MetallicRoughnessTexOffset);
-		ApplyTexture(P, Mdl, GMaterial::PBRAlbedoTexID, MetallicRoughnessTexOffset);
-		ApplyTexture(P, Mdl, GMaterial::PBRMetallicRoughnessTexID, MetallicRoughnessTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::NormalTexID, MetallicRoughnessTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::OcclussionTexID, MetallicRoughnessTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::EmissiveTexID, MetallicRoughnessTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::PBRAlbedoTexID, MetallicRoughnessTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::PBRMetallicRoughnessTexID, MetallicRoughnessTexOffset);
 	} else if (Mdl.m_PipelineID == Material::PBRSpecularGlossiness) {
 		P = m_SpecularGlossinessPipeline;
-		ApplyTexture(P, Mdl, GMaterial::NormalTexID, SpecularGlossinessTexOffset);
-		ApplyTexture(P, Mdl, GMaterial::OcclussionTexID, SpecularGlossinessTexOffset);
-		ApplyTexture(P, Mdl, GMaterial::EmissiveTexID, SpecularGlossinessTexOffset);
-		ApplyTexture(P, Mdl, GMaterial::SGDiffuseColorTexID, SpecularGlossinessTexOffset);
-		ApplyTexture(P, Mdl, GMaterial::SGSpecularColorTexID, SpecularGlossinessTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::NormalTexID, SpecularGlossinessTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::OcclussionTexID, SpecularGlossinessTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::EmissiveTexID, SpecularGlossinessTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::SGDiffuseColorTexID, SpecularGlossinessTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::SGSpecularColorTexID, SpecularGlossinessTexOffset);
 	} else if (Mdl.m_PipelineID == Material::PBRUnlit) {
 		P = m_UnlitPipeline;
-		ApplyTexture(P, Mdl, GMaterial::NormalTexID, UnlitTexOffset);
-		ApplyTexture(P, Mdl, GMaterial::OcclussionTexID, UnlitTexOffset);
-		ApplyTexture(P, Mdl, GMaterial::EmissiveTexID, UnlitTexOffset);
-		ApplyTexture(P, Mdl, GMaterial::ULColorTexID, UnlitTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::NormalTexID, UnlitTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::OcclussionTexID, UnlitTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::EmissiveTexID, UnlitTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::ULColorTexID, UnlitTexOffset);
 	} else if (Mdl.m_PipelineID == Material::Skybox) {
 		P = m_SkyboxPipeline;
-		ApplyTexture(P, Mdl, GMaterial::SBBackTexID, SkyboxTexOffset);
-		ApplyTexture(P, Mdl, GMaterial::SBHorizonTexID, SkyboxTexOffset);
-		ApplyTexture(P, Mdl, GMaterial::SBGlowTexID, SkyboxTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::SBBackTexID, SkyboxTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::SBHorizonTexID, SkyboxTexOffset);
+		ApplyTexture(P, S, Mdl, GMaterial::SBGlowTexID, SkyboxTexOffset);
 	} else if (Mdl.m_PipelineID == Material::Cloud) {
 		P = m_CloudPipeline;
 	}
-	return ApplyFlagsToPipeline(P, VertShader, Mdl.m_Flags, Transparent);
+	return ApplyFlagsToPipeline(P, S, VertShader, Mdl.m_Flags, Transparent);
+}
+
+GPipelineState &Renderer::GetPipelineState(const GFrameModel &Mdl, bool IsShadowed) {
+	if (IsShadowed) return m_PipelineStates[ShadowPipelineState];
+	return m_PipelineStates[std::min<uint32_t>(Mdl.m_PipelineID, ShadowPipelineState - 1)];
+}
+
+Renderer &Renderer::BindDrawData(GFrame &F, LWPipeline *P, GPipelineState &S, const GFrameModel &Mdl, uint32_t PassID, bool isSkinned) {
+	uint32_t PassOffset = F.m_PassRingBase + PassID;
+	if (S.m_PassOffset != PassOffset) {
+		P->SetPaddedUniformBlock<GPassData>(1, m_PassDataRing.GetBuffer(), PassOffset, m_Driver);
+		S.m_PassOffset = PassOffset;
+		m_Stats.m_ResourceBinds++;
+	} else m_Stats.m_RedundantSkipped++;
+	//The lists are only rebound when their ring grows or the stages are updated.
+	LWVideoBuffer *ModelList = m_ModelDataRing.GetBuffer();
+	if (S.m_ModelList != ModelList) {
+		P->SetResource("ModelList", ModelList);
+		S.m_ModelList = ModelList;
+		m_Stats.m_ResourceBinds++;
+	} else m_Stats.m_RedundantSkipped++;
+	LWVideoBuffer *MaterialList = m_MaterialDataRing.GetBuffer();
+	if (S.m_MaterialList != MaterialList) {
+		P->SetResource("MaterialList", MaterialList);
+		S.m_MaterialList = MaterialList;
+		m_Stats.m_ResourceBinds++;
+	} else m_Stats.m_RedundantSkipped++;
+	//Static vertex shaders never read the anim list.
+	if (isSkinned) {
+		LWVideoBuffer *AnimList = m_AnimDataRing.GetBuffer();
+		if (S.m_AnimList != AnimList) {
+			P->SetResource("AnimList", AnimList);
+			S.m_AnimList = AnimList;
+			m_Stats.m_ResourceBinds++;
+		} else m_Stats.m_RedundantSkipped++;
+	}
+	P->SetPaddedUniformBlock<GDrawData>(2, m_DrawIndexBuffer, F.m_ModelRingBase + Mdl.GetModelBufferID(), m_Driver);
+	m_Stats.m_ResourceBinds++;
+	return *this;
 }
 
 Renderer &Renderer::ApplyFrame(GFrame &F) {
-	F.FinalizeFrame();
+	F.FinalizeFrame(m_SortPool);
+	if (m_Settings.m_TextureArrays) WriteTextureLayers(F);
+	uint32_t StorageSize = F.GetStorageSize();
+	if (StorageSize > m_FrameStorageSize) {
+		m_FrameStorageSize = StorageSize;
+		LogEvent(LWUTF8I::Fmt<128>("Frame storage grew to {}KB for {} models.", StorageSize / 1024, F.m_ModelCount));
+	}
 	m_Driver->UpdateVideoBuffer(m_LightDataBuffer, (uint8_t*)F.m_LightsBuffer, sizeof(GLight) * F.m_LightCount);
+	//Each frame uploads into it's own region of the rings, empty staging buffers are skipped as they aren't allocated until the first frame that writes to them.
+	//The region was last drawn from RingFrames applied frames ago, only that frame has to finish before it's overwritten.
+	uint32_t Frame = m_AppliedFrames++;
+	m_RingFence.Wait(m_Driver, Frame);
+	F.m_PassRingBase = m_PassDataRing.Write(m_Driver, Frame, F.m_PassDataBuffer, MaxRawPasses, m_Allocator);
+	F.m_AnimRingBase = m_AnimDataRing.Write(m_Driver, Frame, F.m_AnimDataBuffer, F.m_AnimCount, m_Allocator);
+	F.m_ModelRingBase = m_ModelDataRing.Write(m_Driver, Frame, F.m_ModelDataBuffer, F.m_ModelCount, m_Allocator);
+	F.m_MaterialRingBase = m_MaterialDataRing.Write(m_Driver, Frame, F.m_MaterialBuffer, F.m_MaterialCount, m_Allocator);
+	F.m_InstanceRingBase = m_InstanceDataRing.Write(m_Driver, Frame, F.m_InstanceDataBuffer, F.m_InstanceCount, m_Allocator);
+	UpdateDrawIndexTable();
+	//Models hold their frame's AnimID and MaterialIndex, the global block is uploaded once the regions they're relative to are known.
+	F.m_GlobalData.AnimBase = F.m_AnimRingBase;
+	F.m_GlobalData.MaterialBase = F.m_MaterialRingBase;
 	m_Driver->UpdateVideoBuffer(m_GlobalDataBlock, (uint8_t*)&F.m_GlobalData, sizeof(GGlobalData));
-	m_Driver->UpdateVideoBuffer(m_PassDataBlock, (uint8_t*)F.m_PassDataBuffer, m_Driver->GetUniformPaddedLength<GPassData>(MaxRawPasses));
-	m_Driver->UpdateVideoBuffer(m_AnimDataBlock, (uint8_t*)F.m_AnimDataBuffer, m_Driver->GetUniformPaddedLength<GAnimData>(F.m_AnimCount));
-	m_Driver->UpdateVideoBuffer(m_ModelDataBlock, (uint8_t*)F.m_ModelDataBuffer, m_Driver->GetUniformPaddedLength<GModelData>(F.m_ModelCount));
+	if (m_LightCullPipeline) m_LightCullPipeline->SetPaddedUniformBlock<GPassData>(1, m_PassDataRing.GetBuffer(), F.m_PassRingBase, m_Driver);
+	m_AppliedUploadBytes = sizeof(GLight) * F.m_LightCount + sizeof(GGlobalData) + m_Driver->GetUniformPaddedLength<GPassData>(MaxRawPasses);
+	m_AppliedUploadBytes += sizeof(GAnimData) * F.m_AnimCount + sizeof(GModelData) * F.m_ModelCount + sizeof(GMaterial) * F.m_MaterialCount + m_Driver->GetUniformPaddedLength<GInstanceData>(F.m_InstanceCount);
+	m_AppliedMaterials = F.m_MaterialCount;
 	m_Driver->UpdateVideoBuffer(m_ParticleVertBuffer, (uint8_t*)F.m_ParticleVertices, sizeof(ParticleVert) * F.m_ParticleCount);
 	return *this;
 }
@@ -626,83 +1451,118 @@ Renderer &Renderer::ApplySettings(const RenderSettings &Settings) {
 	if (Settings.m_ShadowQuality != m_Settings.m_ShadowQuality || !m_ShadowFrameBuffer) {
 		if (m_ShadowFrameBuffer) {
 			m_Driver->DestroyFrameBuffer(m_ShadowFrameBuffer);
-			m_Driver->DestroyFrameBuffer(m_ShadowCubeFrameBuffer);
 			m_Driver->DestroyTexture(m_ShadowTextureArray);
-			m_Driver->DestroyTexture(m_ShadowCubemapArray);
 		}
+		ReleaseShadowCubeTargets();
+		std::fill(m_ShadowArrayHashes, m_ShadowArrayHashes + GFrame::MaxShadowRTs, 0);
+		std::fill(m_ShadowCubeHashes, m_ShadowCubeHashes + GFrame::MaxShadowRTs * 6, 0);
 		m_ShadowFrameBuffer = m_Driver->CreateFrameBuffer(ShadowSizes[Settings.m_ShadowQuality], m_Allocator);
-		m_ShadowCubeFrameBuffer = m_Driver->CreateFrameBuffer(CubeShadowSizes[Settings.m_ShadowQuality], m_Allocator);
+		m_ShadowCubeSize = CubeShadowSizes[Settings.m_ShadowQuality];
 
 		m_ShadowTextureArray = m_Driver->CreateTexture2DArray(LWTexture::RenderTarget | LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::CompareModeRefTexture | LWTexture::CompareLessEqual, LWImage::DEPTH32, m_ShadowFrameBuffer->GetSize(), GFrame::MaxShadowRTs, nullptr, 0, m_Allocator);
-		m_ShadowCubemapArray = m_Driver->CreateTextureCubeArray(LWTexture::RenderTarget | LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::CompareModeRefTexture | LWTexture::CompareLessEqual, LWImage::DEPTH32, m_ShadowCubeFrameBuffer->GetSize(), GFrame::MaxShadowRTs, nullptr, 0, m_Allocator);
+		m_GPUMemory.Set(GPUMemoryReport::ShadowArray, GPUMemoryReport::TextureBytes(m_ShadowFrameBuffer->GetSize(), GFrame::MaxShadowRTs));
+		if (!m_EmptyShadowCubemap) m_EmptyShadowCubemap = m_Driver->CreateTextureCubeArray(LWTexture::RenderTarget | LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::CompareModeRefTexture | LWTexture::CompareLessEqual, LWImage::DEPTH32, LWVector2i(1), 1, nullptr, 0, m_Allocator);
+
+		if (m_SoftRenderer) m_SoftRenderer->SetShadowSize(m_ShadowFrameBuffer->GetSize());
 
 		m_MetallicRoughnessPipeline->SetResource("DepthTex", m_ShadowTextureArray);
 		m_SpecularGlossinessPipeline->SetResource("DepthTex", m_ShadowTextureArray);
-		m_MetallicRoughnessPipeline->SetResource("DepthCubeTex", m_ShadowCubemapArray);
-		m_SpecularGlossinessPipeline->SetResource("DepthCubeTex", m_ShadowCubemapArray);
-		LWVector2f iShadowCubeSize = 1.0f / m_ShadowCubeFrameBuffer->GetSizef();
-		for (uint32_t i = 0; i < MaxFrames; i++) m_Frames[i].m_GlobalData.iShadowCubeSize = iShadowCubeSize;
+		m_MetallicRoughnessPipeline->SetResource("DepthCubeTex", m_EmptyShadowCubemap);
+		m_SpecularGlossinessPipeline->SetResource("DepthCubeTex", m_EmptyShadowCubemap);
+		LWVector2f iShadowCubeSize = 1.0f / m_ShadowCubeSize.CastTo<float>();
+		for (uint32_t i = 0; i < MaxFrames; i++) {
+			m_Frames[i].m_GlobalData.iShadowCubeSize = iShadowCubeSize;
+			m_Frames[i].m_ShadowMapSize = (uint32_t)m_ShadowFrameBuffer->GetSize().x;
+		}
 	}
 
 	//Update reflection settings.
-	if (Settings.m_ReflectionQuality != Settings.m_ReflectionQuality || !m_ReflectionFrameBuffer) {
-		if (m_ReflectionFrameBuffer) {
-			m_Driver->DestroyFrameBuffer(m_ReflectionFrameBuffer);
-			m_Driver->DestroyTexture(m_ReflectionDepthmap);
-			m_Driver->DestroyTexture(m_ReflectionCubemap[0]);
-			m_Driver->DestroyTexture(m_ReflectionCubemap[1]);
-		}
-		m_ReflectionFrameBuffer = m_Driver->CreateFrameBuffer(ReflectionSizes[Settings.m_ReflectionQuality], m_Allocator);
-		m_ReflectionDepthmap = m_Driver->CreateTexture2D(LWTexture::RenderTarget, LWImage::DEPTH24STENCIL8, m_ReflectionFrameBuffer->GetSize(), nullptr, 0, m_Allocator);
-		m_ReflectionCubemap[0] = m_Driver->CreateTextureCubeMap(LWTexture::RenderTarget | LWTexture::MinLinearMipmapLinear | LWTexture::MagLinear | LWTexture::MakeMipmaps, LWImage::RGBA8, m_ReflectionFrameBuffer->GetSize(), nullptr, 0, m_Allocator);
-		m_ReflectionCubemap[1] = m_Driver->CreateTextureCubeMap(LWTexture::RenderTarget | LWTexture::MinLinearMipmapLinear | LWTexture::MagLinear | LWTexture::MakeMipmaps, LWImage::RGBA8, m_ReflectionFrameBuffer->GetSize(), nullptr, 0, m_Allocator);
-		m_ReflectionFrameBuffer->SetAttachment(LWFrameBuffer::Depth, m_ReflectionDepthmap);
-	
-		//m_MetallicRoughnessPipeline->SetResource("SpecularEnvTex", m_ReflectionCubemap);
-
+	if (Settings.m_ReflectionQuality != m_Settings.m_ReflectionQuality || !m_ReflectionSize.x) {
+		ReleaseReflectionTargets();
+		m_ReflectionSize = ReflectionSizes[Settings.m_ReflectionQuality];
 	}
 
+	bool TextureArrays = Settings.m_TextureArrays;
+	if (TextureArrays != m_Settings.m_TextureArrays && m_MaterialTexturesLoaded) {
+		LogWarn("Texture arrays can only be changed before any material textures are loaded.");
+		TextureArrays = m_Settings.m_TextureArrays;
+	}
+	bool TextureModeChanged = TextureArrays != m_Settings.m_TextureArrays;
 	m_Settings = Settings;
+	m_Settings.m_TextureArrays = TextureArrays;
+	if (TextureModeChanged) ApplyTextureMode();
 	m_SizeChanged = true;
 	return *this;
 }
 
+bool Renderer::FindGeometry(const GFrameModel &Mdl, LWVideoBuffer *&VBuffer, LWVideoBuffer *&IBuffer, uint32_t &Count, uint32_t &Offset) {
+	IBuffer = nullptr;
+	const GGeometry *VGeom = m_GeometrySlots.Find(Mdl.m_VerticeID);
+	if (!VGeom) return false;
+	const GGeometry &V = *VGeom;
+	VBuffer = V.m_Arena == -1 ? V.m_Buffer : m_GeometryArenas[V.m_Arena].GetBuffer();
+	if (!VBuffer) return false;
+	Count = V.m_Count;
+	Offset = V.m_Offset;
+	if (Mdl.m_IndiceID) {
+		const GGeometry *IGeom = m_GeometrySlots.Find(Mdl.m_IndiceID);
+		if (!IGeom) return false;
+		const GGeometry &I = *IGeom;
+		//Arena indices are rebased onto the vertices they were uploaded with, and standalone indices can't reach into an arena.
+		if (I.m_Arena == -1 ? V.m_Arena != -1 : I.m_VerticeID != Mdl.m_VerticeID) return false;
+		IBuffer = I.m_Arena == -1 ? I.m_Buffer : m_GeometryArenas[I.m_Arena].GetBuffer();
+		if (!IBuffer) return false;
+		Count = I.m_Count;
+		Offset = I.m_Offset;
+	}
+	Count = Mdl.m_Count ? Mdl.m_Count : Count;
+	return true;
+}
+
 Renderer &Renderer::RenderModel(GFrame &F, const GFrameModel &Mdl, uint32_t PassID, bool Transparent, bool IsShadowed) {
 	LWVideoBuffer *VBuffer = nullptr;
 	LWVideoBuffer *IBuffer = nullptr;
 	uint32_t Count = 0;
-	auto VIter = m_GeometryMap.find(Mdl.m_VerticeID);
-	if (VIter == m_GeometryMap.end()) return *this;
-	if (!VIter->second) return *this;
-	VBuffer = VIter->second;
-	Count = VBuffer->GetLength();
-	if (Mdl.m_IndiceID) {
-		auto IIter = m_GeometryMap.find(Mdl.m_IndiceID);
-		if (IIter == m_GeometryMap.end()) return *this;
-		if (!IIter->second) return *this;
-		IBuffer = IIter->second;
-		Count = IBuffer->GetLength();
-	}
-	Count = Mdl.m_Count ? Mdl.m_Count : Count;
-	LWPipeline *P = PreparePipeline(F, Mdl, VBuffer->GetTypeSize() == sizeof(GSkeletonVertice), Transparent, IsShadowed);
-	P->SetPaddedUniformBlock<GPassData>(1, m_PassDataBlock, PassID, m_Driver);
-	P->SetPaddedUniformBlock<GAnimData>(2, m_AnimDataBlock, Mdl.GetAnimBufferID(), m_Driver);
-	P->SetPaddedUniformBlock<GModelData>(3, m_ModelDataBlock, Mdl.GetModelBufferID(), m_Driver);
-	m_Driver->DrawBuffer(P, LWVideoDriver::Triangle, VBuffer, IBuffer, Count, VBuffer->GetTypeSize(), Mdl.m_Offset);
+	uint32_t Offset = 0;
+	if (!FindGeometry(Mdl, VBuffer, IBuffer, Count, Offset)) return *this;
+	m_Stats.m_DrawCalls++;
+	bool isSkinned = VBuffer->GetTypeSize() == sizeof(GSkeletonVertice);
+	LWPipeline *P = PreparePipeline(F, Mdl, isSkinned, Transparent, IsShadowed);
+	BindDrawData(F, P, GetPipelineState(Mdl, IsShadowed), Mdl, PassID, isSkinned);
+	m_Driver->DrawBuffer(P, LWVideoDriver::Triangle, VBuffer, IBuffer, Count, VBuffer->GetTypeSize(), Offset + Mdl.m_Offset);
 	return *this;
 }
 
+bool Renderer::RenderInstances(GFrame &F, const GFrameModel &Mdl, uint32_t PassID, bool Transparent, bool IsShadowed, uint32_t InstanceID, uint32_t InstanceCount) {
+	LWVideoBuffer *VBuffer = nullptr;
+	LWVideoBuffer *IBuffer = nullptr;
+	uint32_t Count = 0;
+	uint32_t Offset = 0;
+	if (!FindGeometry(Mdl, VBuffer, IBuffer, Count, Offset)) return true;
+	//Each instance of a skinned model has it's own pose, so they're drawn separately.
+	if (VBuffer->GetTypeSize() == sizeof(GSkeletonVertice)) return false;
+	m_Stats.m_DrawCalls++;
+	m_Stats.m_InstancedModels += InstanceCount;
+	LWPipeline *P = PreparePipeline(F, Mdl, false, Transparent, IsShadowed, true);
+	BindDrawData(F, P, GetPipelineState(Mdl, IsShadowed), Mdl, PassID, false);
+	P->SetPaddedUniformBlock<GInstanceData>(3, m_InstanceDataRing.GetBuffer(), F.m_InstanceRingBase + InstanceID, m_Driver);
+	m_Stats.m_ResourceBinds++;
+	m_Driver->DrawInstancedBuffer(P, LWVideoDriver::Triangle, VBuffer, IBuffer, Count, VBuffer->GetTypeSize(), InstanceCount, Offset + Mdl.m_Offset);
+	return true;
+}
+
 Renderer &Renderer::RenderPass(GFrame &F, uint32_t PassID) {
 	GFramePass &Pass = F.m_PassList[PassID];
 	if (!Pass.isInitialized(F.m_FrameID)) return *this;
 	bool isShadowed = Pass.isShadowed();
-	for (uint32_t i = 0; i < Pass.m_OpaqueCount; i++) {
-		GElement &E = Pass.m_OpaqueElements[i];
-		RenderModel(F, F.m_ModelList[E.m_Index], PassID, false, isShadowed);
-	}
-	for (uint32_t i = 0; i < Pass.m_TransparentCount; i++) {
-		GElement &E = Pass.m_TransparentElements[i];
-		RenderModel(F, F.m_ModelList[E.m_Index], PassID, true, isShadowed);
+	for (uint32_t b = 0; b < Pass.m_BatchCount; b++) {
+		const GPassBatch &B = Pass.m_Batches[b];
+		const GPassElement &First = Pass.m_Elements[B.m_First];
+		if (B.m_InstanceID != -1 && RenderInstances(F, F.m_ModelList[First.m_Index], PassID, First.isTransparent(), isShadowed, B.m_InstanceID, B.m_Count)) continue;
+		for (uint32_t i = B.m_First; i < B.m_First + B.m_Count; i++) {
+			GPassElement &E = Pass.m_Elements[i];
+			RenderModel(F, F.m_ModelList[E.m_Index], PassID, E.isTransparent(), isShadowed);
+		}
 	}
 	return *this;
 }
@@ -723,6 +1583,15 @@ Renderer &Renderer::RenderBlurPass(GFrame &F, uint32_t KernelOffset, LWFrameBuff
 Renderer &Renderer::RenderShadowPass(GFrame &F, uint32_t PassID) {
 	GFramePass &P = F.m_PassList[PassID];
 	bool isPoint = P.isPoint();
+	if (isPoint && !ReserveShadowCubeTargets()) return *this;
+	uint64_t &CachedHash = isPoint ? m_ShadowCubeHashes[P.m_TargetIndex * 6 + P.m_TargetFace] : m_ShadowArrayHashes[P.m_TargetIndex];
+	uint64_t Hash = HashShadowPass(F, PassID);
+	if (Hash == CachedHash) {
+		m_Stats.m_ShadowPassesSkipped++;
+		return *this;
+	}
+	CachedHash = Hash;
+	m_Stats.m_ShadowPassesRendered++;
 	if (isPoint) {
 		m_ShadowCubeFrameBuffer->SetCubeAttachment(LWFrameBuffer::Depth, m_ShadowCubemapArray, P.m_TargetFace, P.m_TargetIndex);
 		m_Driver->SetFrameBuffer(m_ShadowCubeFrameBuffer, true);
@@ -735,18 +1604,44 @@ Renderer &Renderer::RenderShadowPass(GFrame &F, uint32_t PassID) {
 	return *this;
 }
 
+uint64_t Renderer::HashShadowPass(GFrame &F, uint32_t PassID) {
+	GFramePass &P = F.m_PassList[PassID];
+	SpriteHasher H;
+	H.Push(m_GeometryRevision).Push(P.m_Flag).Push(P.m_ElementCount).Push(F.m_GlobalData.ProjViewMatrixs[PassID]);
+	for (uint32_t i = 0; i < P.m_ElementCount; i++) {
+		const GPassElement &E = P.m_Elements[i];
+		const GFrameModel &Mdl = F.m_ModelList[E.m_Index];
+		LWVideoBuffer *VBuffer = nullptr;
+		LWVideoBuffer *IBuffer = nullptr;
+		uint32_t Count = 0;
+		uint32_t Offset = 0;
+		if (!FindGeometry(Mdl, VBuffer, IBuffer, Count, Offset)) continue;
+		H.Push(E.m_Index).Push(Mdl.m_VerticeID).Push(Mdl.m_IndiceID).Push(Mdl.m_Flags).Push(Count).Push(Offset);
+		H.Push(F.GetModelDataAt(Mdl.GetModelBufferID())->TransformMatrix);
+		if (VBuffer->GetTypeSize() == sizeof(GSkeletonVertice)) H.Push(*F.GetAnimDataAt(Mdl.GetAnimBufferID()));
+	}
+	//0 marks a map that must be redrawn, so it can't be a valid hash.
+	return H.Get() ? H.Get() : 1;
+}
+
 Renderer &Renderer::CopyOutput(GFrame &F) {
 	//Update output dimensions if needed:
 	LWVector2i CurrentSize = m_OutputFramebuffer ? m_OutputFramebuffer->GetSize() : LWVector2i();
+	uint32_t Layers = F.m_TargetLayers ? F.m_TargetLayers : ((1 << RenderCount) - 1);
 	
-	if (F.m_TargetTextureSize.x > 0 && F.m_TargetTextureSize != CurrentSize) {
+	if (F.m_TargetTextureSize.x > 0 && (F.m_TargetTextureSize != CurrentSize || Layers != m_OutputLayers)) {
 		
 		if (m_OutputFramebuffer) {
 			m_Driver->DestroyTexture(m_OutputTexture);
 			m_Driver->DestroyFrameBuffer(m_OutputFramebuffer);
 		}
+		uint32_t LayerCount = 0;
+		for (uint32_t i = 0; i < RenderCount; i++) LayerCount += (Layers >> i) & 1;
+		m_OutputLayers = Layers;
 		m_OutputFramebuffer = m_Driver->CreateFrameBuffer(F.m_TargetTextureSize, m_Allocator);
-		m_OutputTexture = m_Driver->CreateTexture2DArray(LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::RenderTarget, LWImage::RGBA8, m_OutputFramebuffer->GetSize(), RenderCount, nullptr, 0, m_Allocator);
+		m_OutputTexture = m_Driver->CreateTexture2DArray(LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::RenderTarget, LWImage::RGBA8, m_OutputFramebuffer->GetSize(), LayerCount, nullptr, 0, m_Allocator);
+		m_GPUMemory.Set(GPUMemoryReport::OutputArray, GPUMemoryReport::TextureBytes(m_OutputFramebuffer->GetSize(), LayerCount));
+		LogEvent(LWUTF8I::Fmt<128>("Allocated {}x{} output array with {} layers({}KB).", F.m_TargetTextureSize.x, F.m_TargetTextureSize.y, LayerCount, (uint32_t)(m_GPUMemory.m_Bytes[GPUMemoryReport::OutputArray] / 1024)));
 	}
 	if (!m_OutputFramebuffer) return *this;
 	if (F.m_TargetViewBounds == LWVector4i(0)) return *this;
@@ -764,10 +1659,11 @@ Renderer &Renderer::CopyOutput(GFrame &F) {
 									LWVertexUI(LWVector4f(WndSize.x, 0.0f, 0.0f, 1.0f), LWVector4f(1.0f), LWVector4f(TRTex, 0.0f, 0.0f)),
 									LWVertexUI(LWVector4f(WndSize.x, WndSize.y, 0.0f, 1.0f), LWVector4f(1.0f), LWVector4f(BRTex, 0.0f, 0.0f)),
 									LWVertexUI(LWVector4f(0.0f, WndSize.y, 0.0f, 1.0f), LWVector4f(1.0f), LWVector4f(BLTex, 0.0f, 0.0f)) };
-	uint32_t RType = F.m_GlobalData.RenderOutput & RenderBits;
+	uint32_t RLayer = GetOutputLayerIndex(F.m_GlobalData.RenderOutput & RenderBits);
+	if (RLayer == -1) return *this;
 
 	m_Driver->UpdateVideoBuffer(m_CopyGeometry, (uint8_t*)OutGeom, sizeof(LWVertexUI) * 6);
-	m_OutputFramebuffer->SetAttachment(LWFrameBuffer::Color0, m_OutputTexture, RType);
+	m_OutputFramebuffer->SetAttachment(LWFrameBuffer::Color0, m_OutputTexture, RLayer);
 	m_Driver->SetFrameBuffer(m_OutputFramebuffer, false);
 	m_Driver->ViewPort(F.m_TargetViewBounds);
 	if(F.m_SpriteFrame==0) m_Driver->ClearColor(0x0);
@@ -777,18 +1673,86 @@ Renderer &Renderer::CopyOutput(GFrame &F) {
 	return *this;
 }
 
+bool Renderer::ReserveShadowCubeTargets(void) {
+	if (m_ShadowCubemapArray) return true;
+	m_ShadowCubeFrameBuffer = m_Driver->CreateFrameBuffer(m_ShadowCubeSize, m_Allocator);
+	m_ShadowCubemapArray = m_Driver->CreateTextureCubeArray(LWTexture::RenderTarget | LWTexture::MinLinear | LWTexture::MagLinear | LWTexture::CompareModeRefTexture | LWTexture::CompareLessEqual, LWImage::DEPTH32, m_ShadowCubeSize, GFrame::MaxShadowRTs, nullptr, 0, m_Allocator);
+	if (!m_ShadowCubeFrameBuffer || !m_ShadowCubemapArray) {
+		LogCritical("Error: Could not create point light shadow targets.");
+		ReleaseShadowCubeTargets();
+		return false;
+	}
+	m_MetallicRoughnessPipeline->SetResource("DepthCubeTex", m_ShadowCubemapArray);
+	m_SpecularGlossinessPipeline->SetResource("DepthCubeTex", m_ShadowCubemapArray);
+	std::fill(m_ShadowCubeHashes, m_ShadowCubeHashes + GFrame::MaxShadowRTs * 6, 0);
+	m_GPUMemory.Set(GPUMemoryReport::ShadowCubeArray, GPUMemoryReport::TextureBytes(m_ShadowCubeSize, GFrame::MaxShadowRTs * 6));
+	LogEvent(LWUTF8I::Fmt<128>("Allocated point light shadow targets({}KB).", (uint32_t)(m_GPUMemory.m_Bytes[GPUMemoryReport::ShadowCubeArray] / 1024)));
+	return true;
+}
+
+bool Renderer::ReserveReflectionTargets(void) {
+	if (m_ReflectionFrameBuffer) return true;
+	m_ReflectionFrameBuffer = m_Driver->CreateFrameBuffer(m_ReflectionSize, m_Allocator);
+	m_ReflectionDepthmap = m_Driver->CreateTexture2D(LWTexture::RenderTarget, LWImage::DEPTH24STENCIL8, m_ReflectionSize, nullptr, 0, m_Allocator);
+	m_ReflectionCubemap[0] = m_Driver->CreateTextureCubeMap(LWTexture::RenderTarget | LWTexture::MinLinearMipmapLinear | LWTexture::MagLinear | LWTexture::MakeMipmaps, LWImage::RGBA8, m_ReflectionSize, nullptr, 0, m_Allocator);
+	m_ReflectionCubemap[1] = m_Driver->CreateTextureCubeMap(LWTexture::RenderTarget | LWTexture::MinLinearMipmapLinear | LWTexture::MagLinear | LWTexture::MakeMipmaps, LWImage::RGBA8, m_ReflectionSize, nullptr, 0, m_Allocator);
+	if (!m_ReflectionFrameBuffer || !m_ReflectionDepthmap || !m_ReflectionCubemap[0] || !m_ReflectionCubemap[1]) {
+		LogCritical("Error: Could not create reflection targets.");
+		ReleaseReflectionTargets();
+		return false;
+	}
+	m_ReflectionFrameBuffer->SetAttachment(LWFrameBuffer::Depth, m_ReflectionDepthmap);
+	//m_MetallicRoughnessPipeline->SetResource("SpecularEnvTex", m_ReflectionCubemap);
+	m_GPUMemory.Set(GPUMemoryReport::ReflectionTargets, GPUMemoryReport::TextureBytes(m_ReflectionSize) + GPUMemoryReport::TextureBytes(m_ReflectionSize, 12, 1, true));
+	LogEvent(LWUTF8I::Fmt<128>("Allocated reflection targets({}KB).", (uint32_t)(m_GPUMemory.m_Bytes[GPUMemoryReport::ReflectionTargets] / 1024)));
+	return true;
+}
+
+void Renderer::ReleaseShadowCubeTargets(void) {
+	if (m_ShadowCubeFrameBuffer) m_Driver->DestroyFrameBuffer(m_ShadowCubeFrameBuffer);
+	if (m_ShadowCubemapArray) m_Driver->DestroyTexture(m_ShadowCubemapArray);
+	m_ShadowCubeFrameBuffer = nullptr;
+	m_ShadowCubemapArray = nullptr;
+	m_GPUMemory.Set(GPUMemoryReport::ShadowCubeArray, 0);
+	return;
+}
+
+void Renderer::ReleaseReflectionTargets(void) {
+	if (m_ReflectionFrameBuffer) m_Driver->DestroyFrameBuffer(m_ReflectionFrameBuffer);
+	if (m_ReflectionDepthmap) m_Driver->DestroyTexture(m_ReflectionDepthmap);
+	for (auto &&Cube : m_ReflectionCubemap) {
+		if (Cube) m_Driver->DestroyTexture(Cube);
+		Cube = nullptr;
+	}
+	m_ReflectionFrameBuffer = nullptr;
+	m_ReflectionDepthmap = nullptr;
+	m_GPUMemory.Set(GPUMemoryReport::ReflectionTargets, 0);
+	return;
+}
+
 Renderer &Renderer::Render(LWWindow *Window) {
+	if (m_SoftRenderer) return RenderSoftware();
 	m_SizeChanged = m_SizeChanged || Window->SizeUpdated();
 	if (!m_Driver->Update()) return *this;
 	ProcessPendingGeometry();
 	ProcessPendingTextures();
 	SizeUpdated(Window);
+	m_RenderTargets.NextFrame(m_Driver);
+	m_GPUMemory.Set(GPUMemoryReport::PooledTargets, m_RenderTargets.GetFreeBytes());
 	if(m_ReadFrame!=m_WriteFrame){
 		ApplyFrame(m_Frames[m_ReadFrame % MaxFrames]);
 		m_ReadFrame++;
 	}
 	if (!m_ReadFrame) return *this;
 	GFrame &F = m_Frames[(m_ReadFrame - 1) % MaxFrames];
+	m_Stats = RenderStats();
+	m_Stats.m_UploadBytes = m_AppliedUploadBytes;
+	m_Stats.m_Materials = m_AppliedMaterials;
+	m_AppliedUploadBytes = 0;
+	m_AppliedMaterials = 0;
+	m_LastPipeline = nullptr;
+	//Ring offsets are only unique within the frame that was applied.
+	for (auto &&S : m_PipelineStates) S.m_PassOffset = -1;
 	
 	//Disabled Forward+ implementation.
 	//m_Driver->Dispatch(m_LightCullPipeline, LWVector3i(F.m_GlobalData.ThreadDimensions, 1));
@@ -798,6 +1762,8 @@ Renderer &Renderer::Render(LWWindow *Window) {
 		GFramePass &Pass = F.m_PassList[i];
 		if(!Pass.isInitialized(F.m_FrameID)) continue;
 		if (Pass.isShadowed()) RenderShadowPass(F, i);
+		//Reflection passes aren't drawn yet, but the first one to be requested creates the targets they'll render into.
+		if (Pass.isReflection()) ReserveReflectionTargets();
 	}
 
 	//Main View Pass
@@ -844,7 +1810,14 @@ Renderer &Renderer::Render(LWWindow *Window) {
 
 	//Copy sprite outputs to render target.
 	CopyOutput(F);
-
+	//Nothing after this reads the uniform rings, so the region this frame was drawn from can be fenced.
+	m_RingFence.Signal(m_Driver, m_AppliedFrames - 1, m_Allocator);
+	m_FrameStats = m_Stats;
+	m_TotalStats += m_Stats;
+	m_StatsFrameCount++;
+	//Hidden windows don't own their back buffer's pixels, so all rendering has to end in framebuffers.
+	//Nothing is presented to pace the gpu either, the ring fence keeps it from falling more than RingFrames-1 frames behind.
+	if (m_Offscreen) return *this;
 
 	//Render everything to screen:
 	m_Driver->SetFrameBuffer(nullptr, true);
@@ -856,12 +1829,47 @@ Renderer &Renderer::Render(LWWindow *Window) {
 	return *this;
 }
 
+Renderer &Renderer::RenderSoftware(void) {
+	ProcessPendingGeometry();
+	ProcessPendingTextures();
+	if (m_ReadFrame == m_WriteFrame) return *this;
+	GFrame &F = m_Frames[m_ReadFrame % MaxFrames];
+	F.FinalizeFrame(m_SortPool);
+	m_SoftRenderer->RenderFrame(F);
+	m_ReadFrame++;
+	return *this;
+}
+
+Renderer &Renderer::SetOffscreen(bool Offscreen) {
+	m_Offscreen = Offscreen;
+	return *this;
+}
+
+Renderer &Renderer::SetSoftware(bool Software) {
+	if (Software == (m_SoftRenderer != nullptr)) return *this;
+	if (!Software) {
+		LWAllocator::Destroy(m_SoftRenderer);
+		m_SoftRenderer = nullptr;
+		return *this;
+	}
+	//Geometry and textures are captured as they're uploaded, so this has to be enabled before any scene is loaded.
+	m_SoftRenderer = m_Allocator.Create<SoftRenderer>();
+	if (m_ShadowFrameBuffer) m_SoftRenderer->SetShadowSize(m_ShadowFrameBuffer->GetSize());
+	return *this;
+}
+
+bool Renderer::isSoftware(void) const {
+	return m_SoftRenderer != nullptr;
+}
+
 GMaterial Renderer::PrepareGMaterial(GFrameModel &Mdl, const LWVector2f &AtlasSubPosition, const LWVector2f &AtlasSubSize, float TransparencyMult, Material &Mat) {
-	float Time = Mat.GetTime();
 	uint32_t TexCnt = Mat.GetTextureCount();
 	uint32_t PipelineID = Mat.GetPipelineID();
-	GMaterial GMat;
-	LWVector4f T = LWVector4f(1.0f, 1.0f, 1.0f, Mat.GetTransparency() * TransparencyMult);
+	const GMaterial *Cached = Mat.GetCachedConstants();
+	GMaterial GMat = Cached ? *Cached : EvaluateGMaterial(Mat);
+	if (!Cached && !Mat.isAnimated()) Mat.CacheConstants(GMat);
+	//Texture ids can change without touching the material's tweens, so they're never cached.
+	GMat.HasTexturesFlag = 0;
 	for (uint32_t i = 0; i < TexCnt; i++) {
 		GModelTexture &GT = Mdl.m_TextureList[i];
 		MaterialTexture &MT = Mat.GetTexture(i);
@@ -870,10 +1878,20 @@ GMaterial Renderer::PrepareGMaterial(GFrameModel &Mdl, const LWVector2f &AtlasSu
 		//GT.m_TextureID = MT.m_Reference ? MT.m_Reference->m_Data.m_ID : 0;
 		if (GT.m_TextureID) GMat.HasTexturesFlag |= (1 << i);
 		GT.m_TextureState = MT.m_TextureState;
-		LWVector4f SubTex = Mat.GetTextureTween(i).GetValue(Time, LWVector4f(0.0f, 0.0f, 1.0f, 1.0f));
-		SubTex = LWVector4f(SubTex.xy() + AtlasSubPosition, SubTex.zw() * AtlasSubSize);
-		GMat.SubTextures[i] = SubTex;
+		LWVector4f SubTex = GMat.SubTextures[i];
+		GMat.SubTextures[i] = LWVector4f(SubTex.xy() + AtlasSubPosition, SubTex.zw() * AtlasSubSize);
 	}
+	if (PipelineID == Material::PBRMetallicRoughness || PipelineID == Material::PBRSpecularGlossiness || PipelineID == Material::PBRUnlit) GMat.MaterialColorA.w *= TransparencyMult;
+	return GMat;
+}
+
+GMaterial Renderer::EvaluateGMaterial(const Material &Mat) {
+	float Time = Mat.GetTime();
+	uint32_t TexCnt = Mat.GetTextureCount();
+	uint32_t PipelineID = Mat.GetPipelineID();
+	GMaterial GMat;
+	LWVector4f T = LWVector4f(1.0f, 1.0f, 1.0f, Mat.GetTransparency());
+	for (uint32_t i = 0; i < TexCnt; i++) GMat.SubTextures[i] = Mat.GetTextureTween(i).GetValue(Time, LWVector4f(0.0f, 0.0f, 1.0f, 1.0f));
 	if (PipelineID == Material::PBRMetallicRoughness) {
 		GMat.MaterialColorA = Mat.GetColorTween(Material::PBRAlbedoBaseFactorClrTweenID).GetValue(Time, LWVector4f(1.0f)) * T;
 		GMat.MaterialColorB = Mat.GetColorTween(Material::PBRMetallicRoughnessClrTweenID).GetValue(Time, LWVector4f(1.0f));
@@ -1112,9 +2130,14 @@ uint32_t Renderer::WriteGeometry(GFrame &F, uint32_t VerticeID, uint32_t IndiceI
 	return F.PushModel(Mdl, PassBits, AnimID, Transform, M, Mat.isTransparent());
 }
 
-uint32_t Renderer::PushPendingGeometry(uint32_t ID, uint32_t DataType, char *Data, uint32_t DataCnt, uint32_t DataSize, LWAllocator &Allocator, bool Copy) {
+uint32_t Renderer::PushPendingGeometry(uint32_t ID, uint32_t DataType, char *Data, uint32_t DataCnt, uint32_t DataSize, LWAllocator &Allocator, bool Copy, uint32_t VerticeID) {
 	if (m_PendingGeomWriteFrame - m_PendingGeomReadFrame >= MaxPendingGeometry) return 0;
+	if (ID && !m_GeometryIDs.isValid(ID)) {
+		LogWarn(LWUTF8I::Fmt<128>("Geometry {} was released, and can't be uploaded to.", ID));
+		return 0;
+	}
 	ID = ID ? ID : NextGeometryID();
+	if (!ID) return 0;
 	char *D = Data;
 	if (Copy) {
 		uint32_t Len = DataCnt * DataSize;
@@ -1122,37 +2145,150 @@ uint32_t Renderer::PushPendingGeometry(uint32_t ID, uint32_t DataType, char *Dat
 		std::copy(Data, Data + Len, D);
 	}
 	PendingGeometry &P = m_PendingGeometry[m_PendingGeomWriteFrame % MaxPendingGeometry];
-	P = PendingGeometry(D, ID, DataType, DataSize, DataCnt);
+	P = PendingGeometry(D, ID, DataType, DataSize, DataCnt, VerticeID);
 	m_PendingGeomWriteFrame++;
 	return ID;
 }
 
-uint32_t Renderer::PushPendingTexture(uint32_t ID, LWImage *Image) {
+bool Renderer::ReleaseGeometry(uint32_t ID) {
+	if (!ID) return true;
+	if (m_PendingGeomWriteFrame - m_PendingGeomReadFrame >= MaxPendingGeometry) {
+		LogWarn(LWUTF8I::Fmt<128>("Pending geometry is full, geometry {} will not be released.", ID));
+		return false;
+	}
+	m_PendingGeometry[m_PendingGeomWriteFrame % MaxPendingGeometry] = PendingGeometry(nullptr, ID, 0, 0, 0);
+	m_PendingGeomWriteFrame++;
+	return true;
+}
+
+uint32_t Renderer::PushPendingTexture(uint32_t ID, LWImage *Image, bool isMaterial) {
 	if (m_PendingTexWriteFrame - m_PendingTexReadFrame >= MaxPendingTexture) return 0;
+	if (!Image) return 0;
+	if (ID && !m_TextureIDs.isValid(ID)) {
+		LogWarn(LWUTF8I::Fmt<128>("Texture {} was released, and can't be uploaded to.", ID));
+		return 0;
+	}
 	ID = ID ? ID : NextTextureID();
+	if (!ID) return 0;
 	uint32_t Idx = m_PendingTexWriteFrame % MaxPendingTexture;
-	m_PendingTextures[Idx] = { Image, ID };
+	m_PendingTextures[Idx] = { Image, ID, isMaterial };
 	m_PendingTexWriteFrame++;
 	return ID;
 }
 
+bool Renderer::ReleaseTexture(uint32_t ID) {
+	if (!ID) return true;
+	if (m_PendingTexWriteFrame - m_PendingTexReadFrame >= MaxPendingTexture) {
+		LogWarn(LWUTF8I::Fmt<128>("Pending textures are full, texture {} will not be released.", ID));
+		return false;
+	}
+	m_PendingTextures[m_PendingTexWriteFrame % MaxPendingTexture] = { nullptr, ID };
+	m_PendingTexWriteFrame++;
+	return true;
+}
+
 void Renderer::ProcessPendingGeometry(void) {
 	const uint32_t MaxPerFrame = 5;
+	bool Released = false;
 	for (uint32_t i = 0; i < MaxPerFrame && m_PendingGeomReadFrame != m_PendingGeomWriteFrame; i++, m_PendingGeomReadFrame++) {
 		PendingGeometry &PGeom = m_PendingGeometry[m_PendingGeomReadFrame % MaxPendingGeometry];
-		LWVideoBuffer *Buf = nullptr;
+		GGeometry Geom;
 		if (PGeom.m_Count) {
-			if (!(Buf = PGeom.MakeBuffer(m_Driver, m_Allocator))) continue;
+			uint32_t Offset = 0;
+			uint32_t Arena = AllocateGeometry(PGeom, Offset);
+			if (Arena != -1) Geom = GGeometry(Arena, Offset, PGeom.m_Count, PGeom.m_VerticeID);
+			else {
+				LWVideoBuffer *Buf = PGeom.MakeBuffer(m_Driver, m_Allocator);
+				if (!Buf) continue;
+				Geom = GGeometry(Buf);
+			}
 		}
-		auto Iter = m_GeometryMap.find(PGeom.m_ID);
-		if (Iter == m_GeometryMap.end()) {
-			m_GeometryMap.emplace(PGeom.m_ID, Buf);
-		} else {
-			LWVideoBuffer *oBuf = Iter->second;
-			Iter->second = Buf;
-			if (oBuf) m_Driver->DestroyVideoBuffer(oBuf);
+		GGeometry *O = m_GeometrySlots.Find(PGeom.m_ID);
+		if (O) {
+			if (O->m_Arena != -1) {
+				m_GeometryArenas[O->m_Arena].Free(O->m_Offset, O->m_Count);
+				Released = true;
+			} else if (O->m_Buffer) m_Driver->DestroyVideoBuffer(O->m_Buffer);
+		}
+		if (PGeom.m_Count) m_GeometrySlots.Insert(PGeom.m_ID) = Geom;
+		else {
+			m_GeometrySlots.Remove(PGeom.m_ID);
+			m_GeometryIDs.Free(PGeom.m_ID);
 		}
+		if (m_SoftRenderer) m_SoftRenderer->PushGeometry(PGeom.m_ID, PGeom.m_Data, PGeom.m_TypeSize, PGeom.m_Count);
 		PGeom.Finished();
+		m_GeometryRevision++;
+	}
+	if (Released) CompactGeometry();
+	for (uint32_t i = 0; i < m_GeometryArenaCount; i++) m_GeometryArenas[i].Update(m_Driver, m_Allocator);
+	return;
+}
+
+uint32_t Renderer::FindGeometryArena(uint32_t BufferType, uint32_t TypeSize) {
+	for (uint32_t i = 0; i < m_GeometryArenaCount; i++) {
+		if (m_GeometryArenas[i].isFormat(BufferType, TypeSize)) return i;
+	}
+	if (m_GeometryArenaCount >= MaxGeometryArenas) return -1;
+	m_GeometryArenas[m_GeometryArenaCount] = GeometryArena(BufferType, TypeSize);
+	return m_GeometryArenaCount++;
+}
+
+uint32_t Renderer::AllocateGeometry(const PendingGeometry &PGeom, uint32_t &Offset) {
+	if (PGeom.m_BufferType == LWVideoBuffer::Vertex) {
+		uint32_t Arena = FindGeometryArena(LWVideoBuffer::Vertex, PGeom.m_TypeSize);
+		if (Arena == -1) return -1;
+		GeometryArena &A = m_GeometryArenas[Arena];
+		if ((Offset = A.Allocate(PGeom.m_Count, m_Allocator)) == -1) return -1;
+		std::copy(PGeom.m_Data, PGeom.m_Data + PGeom.m_Count * PGeom.m_TypeSize, A.GetData(Offset));
+		return Arena;
+	}
+	bool isIndex16 = PGeom.m_BufferType == LWVideoBuffer::Index16;
+	if (!isIndex16 && PGeom.m_BufferType != LWVideoBuffer::Index32) return -1;
+	const GGeometry *V = m_GeometrySlots.Find(PGeom.m_VerticeID);
+	if (!V || V->m_Arena == -1) return -1;
+	//Indices are widened to 32 bits, since they now index the whole vertex arena.
+	uint32_t Arena = FindGeometryArena(LWVideoBuffer::Index32, sizeof(uint32_t));
+	if (Arena != -1) Offset = m_GeometryArenas[Arena].Allocate(PGeom.m_Count, m_Allocator);
+	if (Arena == -1 || Offset == -1) {
+		LogCritical(LWUTF8I::Fmt<128>("Error could not allocate indices for id: {}", PGeom.m_ID));
+		return -1;
+	}
+	uint32_t Base = V->m_Offset;
+	uint32_t *Indices = (uint32_t*)m_GeometryArenas[Arena].GetData(Offset);
+	for (uint32_t i = 0; i < PGeom.m_Count; i++) Indices[i] = Base + (isIndex16 ? ((uint16_t*)PGeom.m_Data)[i] : ((uint32_t*)PGeom.m_Data)[i]);
+	return Arena;
+}
+
+void Renderer::CompactGeometry(void) {
+	std::vector<std::pair<uint32_t, GGeometry*>> List;
+	std::unordered_map<uint32_t, uint32_t> VerticeDeltas;
+	for (uint32_t a = 0; a < m_GeometryArenaCount; a++) {
+		GeometryArena &A = m_GeometryArenas[a];
+		if (!A.NeedsCompaction()) continue;
+		List.clear();
+		for (auto &&S : m_GeometrySlots) {
+			if (S.m_ID && S.m_Value.m_Arena == a) List.emplace_back(S.m_ID, &S.m_Value);
+		}
+		std::sort(List.begin(), List.end(), [](const std::pair<uint32_t, GGeometry*> &L, const std::pair<uint32_t, GGeometry*> &R) { return L.second->m_Offset < R.second->m_Offset; });
+		uint32_t OldEnd = A.GetEnd();
+		uint32_t End = 0;
+		for (auto &&G : List) {
+			if (G.second->m_Offset != End) {
+				A.Move(G.second->m_Offset, End, G.second->m_Count);
+				VerticeDeltas[G.first] = G.second->m_Offset - End;
+				G.second->m_Offset = End;
+			}
+			End += G.second->m_Count;
+		}
+		A.ResetFreeList(End);
+		LogEvent(LWUTF8I::Fmt<128>("Compacted geometry arena {} from {} to {} elements.", a, OldEnd, End));
+	}
+	if (VerticeDeltas.empty()) return;
+	for (auto &&S : m_GeometrySlots) {
+		GGeometry &G = S.m_Value;
+		if (!S.m_ID || G.m_Arena == -1 || !G.m_VerticeID) continue;
+		auto DIter = VerticeDeltas.find(G.m_VerticeID);
+		if (DIter != VerticeDeltas.end()) m_GeometryArenas[G.m_Arena].Rebase(G.m_Offset, G.m_Count, DIter->second);
 	}
 	return;
 }
@@ -1161,21 +2297,117 @@ void Renderer::ProcessPendingTextures(void) {
 	const uint32_t MaxPerFrame = 5;
 	for (uint32_t i = 0; i < MaxPerFrame && m_PendingTexReadFrame != m_PendingTexWriteFrame; i++, m_PendingTexReadFrame++) {
 		PendingTexture &PTex = m_PendingTextures[m_PendingTexReadFrame % MaxPendingTexture];
-		LWTexture *Tex = nullptr;
-		if (PTex.m_Image) Tex = m_Driver->CreateTexture(0, *PTex.m_Image, m_Allocator);
-		auto Iter = m_TextureMap.find(PTex.m_ID);
-		if (Iter == m_TextureMap.end()) {
-			m_TextureMap.emplace(PTex.m_ID, Tex);
+		LWTexture **Slot = m_TextureSlots.Find(PTex.m_ID);
+		//A texture array is shared with other textures, so only the layer is released.
+		if (!ReleaseTextureLayer(PTex.m_ID) && Slot && *Slot) m_Driver->DestroyTexture(*Slot);
+		if (m_SoftRenderer) m_SoftRenderer->PushTexture(PTex.m_ID, PTex.m_Image);
+		//A pending texture without an image releases it's id.
+		if (PTex.m_Image) {
+			m_MaterialTexturesLoaded |= PTex.m_Material;
+			if (!PlaceTextureLayer(PTex)) m_TextureSlots.Insert(PTex.m_ID) = m_Driver->CreateTexture(0, *PTex.m_Image, m_Allocator);
 		} else {
-			LWTexture *oTex = Iter->second;
-			Iter->second = Tex;
-			if (oTex) m_Driver->DestroyTexture(oTex);
+			m_TextureSlots.Remove(PTex.m_ID);
+			m_TextureIDs.Free(PTex.m_ID);
 		}
-		LWAllocator::Destroy(PTex.m_Image);
+		//Pipelines may still reference the destroyed texture, or have looked up this id before it loaded.
+		for (auto &&S : m_PipelineStates) S.m_BoundTextures = 0;
+		PTex.m_Image = LWAllocator::Destroy(PTex.m_Image);
 	}
+	UpdateTextureArrays();
 	return;
 }
 
+bool Renderer::PlaceTextureLayer(PendingTexture &PTex) {
+	if (!m_Settings.m_TextureArrays || !PTex.m_Material || PTex.m_Image->GetType() != LWImage::Image2D) return false;
+	//The material shaders only take arrays now, so a texture that doesn't fit in one is left unloaded instead.
+	m_TextureSlots.Insert(PTex.m_ID) = nullptr;
+	uint32_t Array = FindTextureArray(*PTex.m_Image);
+	if (Array == -1) {
+		LogWarn(LWUTF8I::Fmt<128>("Texture {} doesn't fit in any texture array, and won't be drawn.", PTex.m_ID));
+		return true;
+	}
+	uint32_t Layer = m_TextureArrays[Array].Insert(PTex.m_ID, PTex.m_Image);
+	m_TextureLayers.Insert(PTex.m_ID) = GTextureLayer(Array, Layer);
+	PTex.m_Image = nullptr;
+	return true;
+}
+
+bool Renderer::ReleaseTextureLayer(uint32_t ID) {
+	GTextureLayer *L = m_TextureLayers.Find(ID);
+	if (!L) return false;
+	m_TextureArrays[L->m_Array].Remove(L->m_Layer);
+	m_TextureLayers.Remove(ID);
+	return true;
+}
+
+uint32_t Renderer::FindTextureArray(const LWImage &Image) {
+	for (uint32_t i = 0; i < m_TextureArrayCount; i++) {
+		if (m_TextureArrays[i].isFormat(Image) && !m_TextureArrays[i].isFull()) return i;
+	}
+	if (m_TextureArrayCount >= MaxTextureArrays) return -1;
+	m_TextureArrays[m_TextureArrayCount] = GTextureArray(Image);
+	return m_TextureArrayCount++;
+}
+
+void Renderer::UpdateTextureArrays(void) {
+	for (uint32_t i = 0; i < m_TextureArrayCount; i++) {
+		GTextureArray &A = m_TextureArrays[i];
+		if (!A.Update(m_Driver, m_Allocator)) continue;
+		for (auto &&ID : A.GetLayerIDs()) {
+			LWTexture **Slot = m_TextureSlots.Find(ID);
+			if (Slot) *Slot = A.GetTexture();
+		}
+		for (auto &&S : m_PipelineStates) S.m_BoundTextures = 0;
+	}
+	return;
+}
+
+void Renderer::WriteTextureLayers(GFrame &F) {
+	for (uint32_t i = 0; i < F.m_MaterialCount; i++) {
+		const GFrameModel &Mdl = F.m_ModelList[F.m_MaterialModels[i]];
+		uint32_t Layers[3] = {};
+		for (uint32_t t = 0; t < MaxTextures; t++) {
+			const GTextureLayer *L = m_TextureLayers.Find(Mdl.m_TextureList[t].m_TextureID);
+			if (L) Layers[t / 2] |= L->m_Layer << ((t & 1) * 16);
+		}
+		std::copy(Layers, Layers + 3, F.GetMaterialAt(i)->TextureLayers);
+	}
+	return;
+}
+
+void Renderer::ApplyTextureMode(void) {
+	bool Arrays = m_Settings.m_TextureArrays;
+	auto SetPixelShader = [this](LWPipeline *P, LWShader *Shader) {
+		if (!P || !Shader) return;
+		P->SetPixelShader(Shader);
+		m_Driver->UpdatePipelineStages(P);
+	};
+	SetPixelShader(m_MetallicRoughnessPipeline, Arrays ? m_PBRMetallicArrayShader : m_PBRMetallicShader);
+	SetPixelShader(m_SpecularGlossinessPipeline, Arrays ? m_PBRSpecularGlossinessArrayShader : m_PBRSpecularGlossinessShader);
+	SetPixelShader(m_UnlitPipeline, Arrays ? m_PBRUnlitArrayShader : m_PBRUnlitShader);
+	SetPixelShader(m_SkyboxPipeline, Arrays ? m_SkyboxArrayShader : m_SkyboxShader);
+	for (auto &&S : m_PipelineStates) S = GPipelineState();
+	return;
+}
+
+bool Renderer::UpdateDrawIndexTable(void) {
+	uint32_t Count = m_ModelDataRing.GetRegionCapacity() * GStorageRing<GModelData>::RingFrames;
+	if (Count <= m_DrawIndexCount) return true;
+	//The table is only written when it's created, every later frame binds into it without uploading anything.
+	char *Data = m_Driver->AllocatePadded<GDrawData>(Count, m_Allocator);
+	for (uint32_t i = 0; i < Count; i++) m_Driver->GetUniformPaddedAt<GDrawData>(i, Data)->ModelIndex = i;
+	LWVideoBuffer *Buffer = m_Driver->CreatePaddedVideoBuffer<GDrawData>(LWVideoBuffer::Uniform, LWVideoBuffer::Static, Count, m_Allocator, Data);
+	LWAllocator::Destroy(Data);
+	if (!Buffer) {
+		LogCritical(LWUTF8I::Fmt<128>("Error could not create draw index table of {} elements.", Count));
+		return false;
+	}
+	if (m_DrawIndexBuffer) m_Driver->DestroyVideoBuffer(m_DrawIndexBuffer);
+	m_DrawIndexBuffer = Buffer;
+	m_DrawIndexCount = Count;
+	return true;
+}
+
 void Renderer::SetIBLBrdfTexture(LWTexture *Tex) {
 	m_MetallicRoughnessPipeline->SetResource("brdfLUTTex", Tex);
 	m_SpecularGlossinessPipeline->SetResource("brdfLUTTex", Tex);
@@ -1195,37 +2427,36 @@ void Renderer::SetIBLSpecularTexture(LWTexture *Tex) {
 }
 
 LWTexture *Renderer::GetTexture(uint32_t ID) {
-	auto Iter = m_TextureMap.find(ID);
-	if (Iter == m_TextureMap.end()) return nullptr;
-	return Iter->second;
+	LWTexture **Slot = m_TextureSlots.Find(ID);
+	return Slot ? *Slot : nullptr;
 }
 
 LWVideoBuffer *Renderer::GetGeometry(uint32_t ID) {
-	auto Iter = m_GeometryMap.find(ID);
-	if (Iter == m_GeometryMap.end()) return nullptr;
-	return Iter->second;
+	const GGeometry *G = m_GeometrySlots.Find(ID);
+	if (!G) return nullptr;
+	return G->m_Arena == -1 ? G->m_Buffer : m_GeometryArenas[G->m_Arena].GetBuffer();
 }
 
 bool Renderer::GeometryIsLoaded(uint32_t ID) const {
-	auto Iter = m_GeometryMap.find(ID);
-	if (Iter == m_GeometryMap.end()) return false;
-	if (!Iter->second) return false;
-	return true;
+	const GGeometry *G = m_GeometrySlots.Find(ID);
+	return G && G->isLoaded();
 }
 
 bool Renderer::TextureIsLoaded(uint32_t ID) const {
-	auto Iter = m_TextureMap.find(ID);
-	if (Iter == m_TextureMap.end()) return false;
-	if (!Iter->second) return false;
-	return true;
+	LWTexture *const *Slot = m_TextureSlots.Find(ID);
+	return Slot && *Slot;
 }
 
 uint32_t Renderer::NextGeometryID(void) {
-	return ++m_NextGeometryID;
+	uint32_t ID = m_GeometryIDs.Allocate();
+	if (!ID) LogCritical("Error: Out of geometry ids.");
+	return ID;
 }
 
 uint32_t Renderer::NextTextureID(void) {
-	return ++m_NextTextureID;
+	uint32_t ID = m_TextureIDs.Allocate();
+	if (!ID) LogCritical("Error: Out of texture ids.");
+	return ID;
 }
 
 bool Renderer::MakeConePrimitive(void){
@@ -1255,8 +2486,8 @@ bool Renderer::MakeConePrimitive(void){
 	}
 	LWVideoBuffer *VBuffer = m_Driver->CreateVideoBuffer<GStaticVertice>(LWVideoBuffer::Vertex, LWVideoBuffer::Static, ConeRadiCnt + 2, m_Allocator, Verts);
 	LWVideoBuffer *IBuffer = m_Driver->CreateVideoBuffer<uint16_t>(LWVideoBuffer::Index16, LWVideoBuffer::Static, ConeRadiCnt * 6, m_Allocator, Idxs);
-	m_GeometryMap.emplace(m_ConeVertID, VBuffer);
-	m_GeometryMap.emplace(m_ConeIdxID, IBuffer);
+	m_GeometrySlots.Insert(m_ConeVertID) = GGeometry(VBuffer);
+	m_GeometrySlots.Insert(m_ConeIdxID) = GGeometry(IBuffer);
 	return true;
 }
 
@@ -1320,8 +2551,8 @@ bool Renderer::MakeCubePrimitive(void) {
 	m_CubeIdxID = NextGeometryID();
 	LWVideoBuffer *VBuffer = m_Driver->CreateVideoBuffer<GStaticVertice>(LWVideoBuffer::Vertex, LWVideoBuffer::Static, 24, m_Allocator, Verts);
 	LWVideoBuffer *IBuffer = m_Driver->CreateVideoBuffer<uint16_t>(LWVideoBuffer::Index16, LWVideoBuffer::Static, 36, m_Allocator, Idxs);
-	m_GeometryMap.emplace(m_CubeVertID, VBuffer);
-	m_GeometryMap.emplace(m_CubeIdxID, IBuffer);
+	m_GeometrySlots.Insert(m_CubeVertID) = GGeometry(VBuffer);
+	m_GeometrySlots.Insert(m_CubeIdxID) = GGeometry(IBuffer);
 	return true;
 }
 
@@ -1378,7 +2609,7 @@ bool Renderer::MakeSpherePrimitive(void) {
 	}
 	m_SphereVertID = NextGeometryID();
 	LWVideoBuffer *VBuffer = m_Driver->CreateVideoBuffer<GStaticVertice>(LWVideoBuffer::Vertex, LWVideoBuffer::Static, TotalVertices, m_Allocator, Verts);
-	m_GeometryMap.emplace(m_SphereVertID, VBuffer);
+	m_GeometrySlots.Insert(m_SphereVertID) = GGeometry(VBuffer);
 	return true;
 }
 
@@ -1446,7 +2677,7 @@ bool Renderer::MakeHalfSpherePrimitive(void) {
 	}
 	m_HalfSphereVertID = NextGeometryID();
 	LWVideoBuffer *VBuffer = m_Driver->CreateVideoBuffer<GStaticVertice>(LWVideoBuffer::Vertex, LWVideoBuffer::Static, o, m_Allocator, Verts);
-	m_GeometryMap.emplace(m_HalfSphereVertID, VBuffer);
+	m_GeometrySlots.Insert(m_HalfSphereVertID) = GGeometry(VBuffer);
 	return true;
 }
 
@@ -1461,7 +2692,7 @@ bool Renderer::MakePlanePrimitive(void) {
 	
 	m_PlaneVertID = NextGeometryID();
 	LWVideoBuffer *VBuffer = m_Driver->CreateVideoBuffer<GStaticVertice>(LWVideoBuffer::Vertex, LWVideoBuffer::Static, 6, m_Allocator, Verts);
-	m_GeometryMap.emplace(m_PlaneVertID, VBuffer);
+	m_GeometrySlots.Insert(m_PlaneVertID) = GGeometry(VBuffer);
 	return true;
 }
 
@@ -1487,8 +2718,8 @@ bool Renderer::MakeSkyBoxPrimitive(void) {
 	m_SkyBoxIdxID = NextGeometryID();
 	LWVideoBuffer *VBuffer = m_Driver->CreateVideoBuffer<GStaticVertice>(LWVideoBuffer::Vertex, LWVideoBuffer::Static, o, m_Allocator, Verts);
 	LWVideoBuffer *IBuffer = m_Driver->CreateVideoBuffer<uint16_t>(LWVideoBuffer::Index16, LWVideoBuffer::Static, 12, m_Allocator, Idxs);
-	m_GeometryMap.emplace(m_SkyBoxVertID, VBuffer);
-	m_GeometryMap.emplace(m_SkyBoxIdxID, IBuffer);
+	m_GeometrySlots.Insert(m_SkyBoxVertID) = GGeometry(VBuffer);
+	m_GeometrySlots.Insert(m_SkyBoxIdxID) = GGeometry(IBuffer);
 	return true;
 }
 
@@ -1510,6 +2741,35 @@ LWTexture *Renderer::GetOutputTexture(void) {
 	return m_OutputTexture;
 }
 
+LWVector2i Renderer::GetOutputSize(void) {
+	if (m_SoftRenderer) return m_SoftRenderer->GetOutputSize();
+	return m_OutputTexture ? m_OutputTexture->Get2DSize() : LWVector2i();
+}
+
+bool Renderer::ReadOutputLayer(uint32_t Layer, uint8_t *Texels) {
+	if (m_SoftRenderer) {
+		const uint8_t *Src = m_SoftRenderer->GetOutputLayer(Layer);
+		if (!Src) return false;
+		LWVector2i Size = m_SoftRenderer->GetOutputSize();
+		std::copy(Src, Src + (size_t)Size.x * Size.y * 4, Texels);
+		return true;
+	}
+	uint32_t Idx = GetOutputLayerIndex(Layer);
+	if (Idx == -1) return false;
+	return m_Driver->DownloadTexture2DArray(m_OutputTexture, 0, Idx, Texels);
+}
+
+uint32_t Renderer::GetOutputLayerIndex(uint32_t Layer) const {
+	if (!m_OutputTexture || Layer >= (uint32_t)RenderCount || !(m_OutputLayers & (1 << Layer))) return -1;
+	uint32_t Idx = 0;
+	for (uint32_t i = 0; i < Layer; i++) Idx += (m_OutputLayers >> i) & 1;
+	return Idx;
+}
+
+const GPUMemoryReport &Renderer::GetGPUMemory(void) const {
+	return m_GPUMemory;
+}
+
 uint32_t Renderer::GetParticleVertID(void) const {
 	return m_ParticleVertID;
 }
@@ -1558,14 +2818,22 @@ RenderSettings Renderer::GetSettings(void) const {
 	return m_Settings;
 }
 
+RenderStats Renderer::GetFrameStats(void) const {
+	return m_FrameStats;
+}
+
 Renderer::Renderer(LWVideoDriver *Driver, LWAllocator &Allocator) : m_Allocator(Allocator), m_Driver(Driver) {
 
 	m_UIUniform = Driver->CreateVideoBuffer<LWMatrix4f>(LWVideoBuffer::Uniform, LWVideoBuffer::WriteDiscardable, 1, m_Allocator, nullptr);
 	m_LightDataBuffer = m_Driver->CreateVideoBuffer<GLight>(LWVideoBuffer::ImageBuffer, LWVideoBuffer::WriteDiscardable, MaxLights, m_Allocator, nullptr);
 	m_GlobalDataBlock = m_Driver->CreatePaddedVideoBuffer<GGlobalData>(LWVideoBuffer::Uniform, LWVideoBuffer::WriteDiscardable, 1, m_Allocator, nullptr);
-	m_PassDataBlock = m_Driver->CreatePaddedVideoBuffer<GPassData>(LWVideoBuffer::Uniform, LWVideoBuffer::WriteDiscardable, MaxRawPasses, m_Allocator, nullptr);
-	m_AnimDataBlock = m_Driver->CreatePaddedVideoBuffer<GAnimData>(LWVideoBuffer::Uniform, LWVideoBuffer::WriteDiscardable, MaxAnimations, m_Allocator, nullptr);
-	m_ModelDataBlock = m_Driver->CreatePaddedVideoBuffer<GModelData>(LWVideoBuffer::Uniform, LWVideoBuffer::WriteDiscardable, MaxModels, m_Allocator, nullptr);
+	//Rings start small and grow with the frames written to them, so an element is always there to bind.
+	m_PassDataRing.Grow(m_Driver, MaxRawPasses, m_Allocator);
+	m_AnimDataRing.Grow(m_Driver, GFrame::InitialAnimations, m_Allocator);
+	m_ModelDataRing.Grow(m_Driver, GFrameArray<GFrameModel>::InitialCapacity, m_Allocator);
+	m_MaterialDataRing.Grow(m_Driver, GFrameArray<GFrameModel>::InitialCapacity, m_Allocator);
+	m_InstanceDataRing.Grow(m_Driver, GFrame::InitialInstanceBlocks, m_Allocator);
+	UpdateDrawIndexTable();
 
 	LWVertexTexture PostProcessGeom[6] = { LWVertexTexture(LWVector4f(-1.0f, 1.0f, 0.0f, 1.0f), LWVector4f(0.0f, 0.0f, 0.0f, 0.0f)),
 										LWVertexTexture(LWVector4f(-1.0f,-1.0f, 0.0f, 1.0f), LWVector4f(0.0f, 1.0f, 0.0f, 0.0f)),
@@ -1589,65 +2857,66 @@ Renderer::Renderer(LWVideoDriver *Driver, LWAllocator &Allocator) : m_Allocator(
 	m_ParticleVertBuffer = m_Driver->CreateVideoBuffer<ParticleVert>(LWVideoBuffer::Vertex, LWVideoBuffer::WriteDiscardable, GFrame::MaxParticleVertices, Allocator, nullptr);
 	LWVideoBuffer *VParticleIdxBuffer = m_Driver->CreateVideoBuffer<uint32_t>(LWVideoBuffer::Index32, LWVideoBuffer::Static, ParticleIdxCount, Allocator, ParticleIdxBuffer);
 	LWAllocator::Destroy(ParticleIdxBuffer);
-	m_GeometryMap.emplace(m_ParticleVertID, m_ParticleVertBuffer);
-	m_GeometryMap.emplace(m_ParticleIdxID, VParticleIdxBuffer);
+	m_GeometrySlots.Insert(m_ParticleVertID) = GGeometry(m_ParticleVertBuffer);
+	m_GeometrySlots.Insert(m_ParticleIdxID) = GGeometry(VParticleIdxBuffer);
 
 	for (uint32_t i = 0; i < MaxFrames; i++) new (&m_Frames[i]) GFrame(m_Driver, Allocator);
 	MakePrimitives();
 }
 
 Renderer::~Renderer() {
+	if (m_StatsFrameCount) {
+		uint32_t Skipped = m_TotalStats.m_RedundantSkipped / m_StatsFrameCount;
+		LogEvent(LWUTF8I::Fmt<256>("Average per frame over {} frames: {} draws, {} instanced models, {} pipeline switches, {} resource binds, {} redundant updates skipped, {} materials, {}KB uploaded.", m_StatsFrameCount, m_TotalStats.m_DrawCalls / m_StatsFrameCount, m_TotalStats.m_InstancedModels / m_StatsFrameCount, m_TotalStats.m_PipelineSwitches / m_StatsFrameCount, m_TotalStats.m_ResourceBinds / m_StatsFrameCount, Skipped, m_TotalStats.m_Materials / m_StatsFrameCount, (uint32_t)(m_TotalStats.m_UploadBytes / m_StatsFrameCount / 1024)));
+		LogEvent(LWUTF8I::Fmt<128>("Shadow maps rendered {} times, reused {} times.", m_TotalStats.m_ShadowPassesRendered, m_TotalStats.m_ShadowPassesSkipped));
+	}
+	uint64_t PeakTotal = 0;
+	for (uint32_t i = 0; i < GPUMemoryReport::ResourceCount; i++) {
+		if (!m_GPUMemory.m_PeakBytes[i]) continue;
+		PeakTotal += m_GPUMemory.m_PeakBytes[i];
+		LogEvent(LWUTF8I::Fmt<128>("GPU memory for {}: {}KB, peak {}KB.", GPUMemoryReport::ResourceNames[i], (uint32_t)(m_GPUMemory.m_Bytes[i] / 1024), (uint32_t)(m_GPUMemory.m_PeakBytes[i] / 1024)));
+	}
+	LogEvent(LWUTF8I::Fmt<128>("GPU memory for render targets: {}KB, sum of peaks {}KB.", (uint32_t)(m_GPUMemory.GetTotal() / 1024), (uint32_t)(PeakTotal / 1024)));
+	LogEvent(LWUTF8I::Fmt<128>("Render target pool created {} targets, reused {}.", m_RenderTargets.GetCreatedCount(), m_RenderTargets.GetReusedCount()));
+	LWAllocator::Destroy(m_SoftRenderer);
 	m_Driver->DestroyVideoBuffer(m_UIUniform);
-	m_Driver->DestroyVideoBuffer(m_PassDataBlock);
-	m_Driver->DestroyVideoBuffer(m_AnimDataBlock);
-	m_Driver->DestroyVideoBuffer(m_ModelDataBlock);
+	m_PassDataRing.Destroy(m_Driver);
+	m_AnimDataRing.Destroy(m_Driver);
+	m_ModelDataRing.Destroy(m_Driver);
+	m_MaterialDataRing.Destroy(m_Driver);
+	m_InstanceDataRing.Destroy(m_Driver);
+	if (m_DrawIndexBuffer) m_Driver->DestroyVideoBuffer(m_DrawIndexBuffer);
 	m_Driver->DestroyVideoBuffer(m_GlobalDataBlock);
 	m_Driver->DestroyVideoBuffer(m_LightDataBuffer);
 	m_Driver->DestroyVideoBuffer(m_PostProcessGeometry);
 	m_Driver->DestroyVideoBuffer(m_CopyGeometry);
 	if (m_LightArrayBuffer) m_Driver->DestroyVideoBuffer(m_LightArrayBuffer);
 	if (m_GaussianKernel) m_Driver->DestroyVideoBuffer(m_GaussianKernel);
-	if (m_ScreenFB) {
-		m_Driver->DestroyFrameBuffer(m_ScreenFB);
-		m_Driver->DestroyTexture(m_ScreenTexMS);
-		m_Driver->DestroyTexture(m_EmissionTexMS);
-		m_Driver->DestroyTexture(m_FinalScreenTex);
-		m_Driver->DestroyTexture(m_ScreenTex);
-		m_Driver->DestroyTexture(m_EmissionTex);
-		m_Driver->DestroyTexture(m_ScreenDepth);
-	}
-	if (m_HighlightFB) {
-		m_Driver->DestroyFrameBuffer(m_HighlightFB);
-		m_Driver->DestroyTexture(m_HighlightTex);
-		m_Driver->DestroyTexture(m_HighlightTexMS);
-	}
-	if (m_BlurFB) {
-		m_Driver->DestroyFrameBuffer(m_BlurFB);
-		m_Driver->DestroyTexture(m_BlurTempTexture);
-		m_Driver->DestroyTexture(m_BEmissionTexture);
-		m_Driver->DestroyTexture(m_BHighlightTexture);
-	}
+	if (m_ScreenFB) m_Driver->DestroyFrameBuffer(m_ScreenFB);
+	if (m_HighlightFB) m_Driver->DestroyFrameBuffer(m_HighlightFB);
+	if (m_BlurFB) m_Driver->DestroyFrameBuffer(m_BlurFB);
+	//Destroys the window sized targets, whether in use or waiting for reuse.
+	m_RenderTargets.Destroy(m_Driver);
 	if (m_OutputFramebuffer) {
 		m_Driver->DestroyFrameBuffer(m_OutputFramebuffer);
 		m_Driver->DestroyTexture(m_OutputTexture);
 	}
+	m_RingFence.Destroy(m_Driver);
 	if (m_ShadowFrameBuffer) {
 		m_Driver->DestroyFrameBuffer(m_ShadowFrameBuffer);
-		m_Driver->DestroyFrameBuffer(m_ShadowCubeFrameBuffer);
 		m_Driver->DestroyTexture(m_ShadowTextureArray);
-		m_Driver->DestroyTexture(m_ShadowCubemapArray);
-	}
-	if (m_ReflectionFrameBuffer) {
-		m_Driver->DestroyFrameBuffer(m_ReflectionFrameBuffer);
-		m_Driver->DestroyTexture(m_ReflectionDepthmap);
-		m_Driver->DestroyTexture(m_ReflectionCubemap[0]);
-		m_Driver->DestroyTexture(m_ReflectionCubemap[1]);
 	}
+	if (m_EmptyShadowCubemap) m_Driver->DestroyTexture(m_EmptyShadowCubemap);
+	ReleaseShadowCubeTargets();
+	ReleaseReflectionTargets();
 
-	for (auto &&Iter : m_GeometryMap) {
-		if (Iter.second) m_Driver->DestroyVideoBuffer(Iter.second);
+	for (auto &&S : m_GeometrySlots) {
+		if (S.m_ID && S.m_Value.m_Buffer) m_Driver->DestroyVideoBuffer(S.m_Value.m_Buffer);
 	}
-	for (auto &&Iter : m_TextureMap) {
-		if (Iter.second) m_Driver->DestroyTexture(Iter.second);
+	for (uint32_t i = 0; i < m_GeometryArenaCount; i++) m_GeometryArenas[i].Destroy(m_Driver);
+	//Textures in an array are destroyed with their array.
+	for (auto &&S : m_TextureSlots) {
+		if (S.m_ID && S.m_Value && !m_TextureLayers.Find(S.m_ID)) m_Driver->DestroyTexture(S.m_Value);
 	}
+	for (uint32_t i = 0; i < m_TextureArrayCount; i++) m_TextureArrays[i].Destroy(m_Driver);
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "Camera.h"
 #include "Logger.h"
 #include "Animation.h"
+#include "SpriteHash.h"
 
 //Node
 Node::Node(LWEGLTFParser &P, LWEGLTFNode &N, Renderer *R, LWAllocator &Allocator) : m_Transform(N.m_TransformMatrix) {
@@ -20,13 +21,16 @@ Node::Node(LWEGLTFParser &P, LWEGLTFNode &N, Renderer *R, LWAllocator &Allocator
 			m_Animation->MakeGLTFSkin(P, GSkn);
 		}
 		
-		m_Mesh->GetVertices().UploadData(R, Allocator, true);
-		m_Mesh->GetIndices().UploadData(R, Allocator, true);
+		MeshGeometry &Vertices = m_Mesh->GetVertices();
+		MeshGeometry &Indices = m_Mesh->GetIndices();
+		Vertices.UploadData(R, Allocator, true);
+		Indices.UploadData(R, Allocator, true, Vertices.m_ID);
 		m_Mesh->BuildAABB(LWSMatrix4f(), nullptr);
+		m_MeshHash = SpriteHasher().Push(Vertices.m_Data, Vertices.m_TypeSize * Vertices.m_Count).Push(Indices.m_Data, Indices.m_TypeSize * Indices.m_Count).Get();
 	}
 }
 
-Node::Node(Node &&O) noexcept : m_Transform(O.m_Transform), m_MaterialList(std::move(O.m_MaterialList)), m_ChildrenList(std::move(O.m_ChildrenList)), m_Mesh(O.m_Mesh), m_Animation(O.m_Animation){
+Node::Node(Node &&O) noexcept : m_Transform(O.m_Transform), m_MaterialList(std::move(O.m_MaterialList)), m_ChildrenList(std::move(O.m_ChildrenList)), m_Mesh(O.m_Mesh), m_Animation(O.m_Animation), m_MeshHash(O.m_MeshHash){
 	O.m_Mesh = nullptr;
 	O.m_Animation = nullptr;
 }
@@ -39,6 +43,7 @@ Node::~Node() {
 //Scene
 bool Scene::LoadGLTFFile(Scene &S, const LWUTF8Iterator &Path, Renderer *R, LWAllocator &Allocator) {
 	LWEGLTFParser P;
+	S.m_Renderer = R;
 
 	std::vector<uint32_t> NodeList;
 	std::vector<uint32_t> MeshList;
@@ -90,7 +95,11 @@ bool Scene::LoadGLTFFile(Scene &S, const LWUTF8Iterator &Path, Renderer *R, LWAl
 			LogCritical(LWUTF8I::Fmt<256>("Error: Failed to load image '{}'.", P.GetImage(ImageList[i])->GetName()));
 			LWAllocator::Destroy(Img);
 		} else {
-			S.PushImageTexID(R->PushPendingTexture(0, Img));
+			//Only RGBA8 texels are hashed, other formats fall back to their size and format.
+			LWVector2i Size = Img->GetSize2D();
+			SpriteHasher H = SpriteHasher().Push(Size).Push(Img->GetPackType());
+			if (Img->GetPackType() == LWImage::RGBA8) H.Push(Img->GetTexels(0), (uint32_t)(Size.x * Size.y * 4));
+			S.PushImageTexID(R->PushPendingTexture(0, Img, true), H.Get());
 		}
 	}
 	for (uint32_t i = 0; i < MaterialList.size(); i++) {
@@ -114,8 +123,9 @@ bool Scene::LoadGLTFFile(Scene &S, const LWUTF8Iterator &Path, Renderer *R, LWAl
 	return true;
 }
 
-bool Scene::PushImageTexID(uint32_t ID) {
+bool Scene::PushImageTexID(uint32_t ID, uint64_t ContentHash) {
 	m_ImageTexID.push_back(ID);
+	m_ImageHash.push_back(ContentHash);
 	return true;
 }
 
@@ -165,6 +175,47 @@ void Scene::DrawScene(GFrame &F, Renderer *R, float Time, uint32_t PassBits, con
 	return;
 }
 
+void Scene::HashScene(SpriteHasher &H, Renderer *R, float Time, const LWSMatrix4f &Transform) {
+	std::function<void(uint32_t, const LWSMatrix4f &)> HashNode = [this, &Time, &H, &R, &HashNode](uint32_t NodeID, const LWSMatrix4f &Transform) {
+		LWSMatrix4f BoneTransforms[Mesh::MaxBones];
+		LWSMatrix4f BoneMatrixs[Mesh::MaxBones];
+		Node &N = m_NodeList[NodeID];
+		LWSMatrix4f Trans = N.m_Transform * Transform;
+		Material DefMaterial;
+		if (N.m_Mesh) {
+			uint32_t PrimCount = N.m_Mesh->GetPrimitiveCount();
+			H.Push(N.m_MeshHash).Push(Trans);
+			if (N.m_Animation) {
+				uint32_t BoneCount = N.m_Animation->MakeBoneTransforms(Time, false, N.m_Mesh, BoneTransforms);
+				if (BoneCount) {
+					BoneCount = N.m_Mesh->BuildRenderMatrixs(BoneTransforms, BoneMatrixs);
+					H.Push(BoneMatrixs, sizeof(LWSMatrix4f) * BoneCount);
+				}
+			}
+			for (uint32_t i = 0; i < PrimCount; i++) {
+				Primitive &P = N.m_Mesh->GetPrimitive(i);
+				Material *Mat = &DefMaterial;
+				if (i < N.m_MaterialList.size()) Mat = &m_MaterialList[N.m_MaterialList[i]];
+				Mat->SetTime(Time, true);
+				GFrameModel Mdl = GFrameModel(Mat->GetPipelineID(), 0, 0, 0, P.m_Offset, P.m_Count);
+				GMaterial GMat = R->PrepareGMaterial(Mdl, LWVector2f(0.0f), LWVector2f(1.0f), 1.0f, *Mat);
+				//GMaterial's padding is never written, so only it's fields are hashed.
+				H.Push(P).Push(Mat->GetPipelineID()).Push(Mat->isTransparent());
+				H.Push(GMat.MaterialColorA).Push(GMat.MaterialColorB).Push(GMat.EmissiveFactor).Push(GMat.SubTextures).Push(GMat.HasTexturesFlag);
+				for (uint32_t n = 0; n < Mat->GetTextureCount(); n++) {
+					MaterialTexture &MT = Mat->GetTexture(n);
+					H.Push(GetImageHash(MT.m_TextureID)).Push(MT.m_TextureState);
+				}
+			}
+		}
+		for (auto &&C : N.m_ChildrenList) HashNode(C, Trans);
+		return;
+	};
+
+	for (auto &&C : m_RootNodes) HashNode(C, Transform);
+	return;
+}
+
 LWVector4i Scene::CaclulateBounding(float Time, const LWSMatrix4f &Transform, const LWVector2f &WndSize, Camera &Cam, int32_t BorderSize, LWSVector4f &BoundsMin, LWSVector4f &BoundsMax){
 	LWSMatrix4f ProjViewMatrix = Cam.GetProjViewMatrix();
 	std::function<bool(uint32_t, const LWSMatrix4f &, LWVector4i &, LWSVector4f &, LWSVector4f &, bool)> BoundNode = [this, &Time, &WndSize, &Cam, &ProjViewMatrix, &BoundNode](uint32_t NodeID, const LWSMatrix4f &Transform, LWVector4i &ParentsBound, LWSVector4f &ParentsMinBounds, LWSVector4f &ParentsMaxBounds, bool ParentHadBounds)->bool {
@@ -215,6 +266,13 @@ uint32_t Scene::GetImageTexID(uint32_t Idx) {
 	return m_ImageTexID[Idx];
 }
 
+uint64_t Scene::GetImageHash(uint32_t TexID) const {
+	for (uint32_t i = 0; i < (uint32_t)m_ImageTexID.size(); i++) {
+		if (m_ImageTexID[i] == TexID) return m_ImageHash[i];
+	}
+	return 0;
+}
+
 Material &Scene::GetMaterial(uint32_t Idx) {
 	return m_MaterialList[Idx];
 }
@@ -223,5 +281,17 @@ float Scene::GetTotalTime(void) const {
 	return m_TotalTime;
 }
 
+void Scene::Release(Renderer *R) {
+	for (auto &&N : m_NodeList) {
+		if (!N.m_Mesh) continue;
+		R->ReleaseGeometry(N.m_Mesh->GetVertices().m_ID);
+		R->ReleaseGeometry(N.m_Mesh->GetIndices().m_ID);
+	}
+	for (auto &&ID : m_ImageTexID) R->ReleaseTexture(ID);
+	m_Renderer = nullptr;
+	return;
+}
+
 Scene::~Scene() {
+	if (m_Renderer) Release(m_Renderer);
 }
\ No newline at end of file
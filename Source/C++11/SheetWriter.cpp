@@ -0,0 +1,482 @@
+#include "SheetWriter.h"
+#include <LWCore/LWAllocator.h>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+//Texels are handled as little endian packed RGBA in the QOI coder.
+static uint32_t QOIHash(uint32_t Texel) {
+	return ((Texel & 0xFF) * 3 + ((Texel >> 8) & 0xFF) * 5 + ((Texel >> 16) & 0xFF) * 7 + (Texel >> 24) * 11) & 63;
+}
+
+static void PutLE32(uint8_t *Buf, uint32_t Value) {
+	Buf[0] = (uint8_t)Value;
+	Buf[1] = (uint8_t)(Value >> 8);
+	Buf[2] = (uint8_t)(Value >> 16);
+	Buf[3] = (uint8_t)(Value >> 24);
+	return;
+}
+
+//SheetEncoding
+SheetEncoding::SheetEncoding(uint32_t BlockFormat, uint32_t ChannelA, uint32_t ChannelB, bool sRGB) : m_BlockFormat(BlockFormat), m_ChannelA(ChannelA), m_ChannelB(ChannelB), m_sRGB(sRGB) {}
+
+//SheetWriter
+SheetWriter *SheetWriter::Make(uint32_t Format, LWAllocator &Allocator) {
+	if (Format == FormatPNG) return Allocator.Create<SheetWriterPNG>();
+	if (Format == FormatDDS || Format == FormatKTX2) return Allocator.Create<SheetWriterBC>(Format);
+	if (Format == FormatQOI) return Allocator.Create<SheetWriterQOI>();
+	return nullptr;
+}
+
+const char8_t *SheetWriter::GetExtension(uint32_t Format) {
+	const char8_t *Extensions[FormatCount] = { "png", "dds", "ktx2", "qoi" };
+	if (Format >= FormatCount) return nullptr;
+	return Extensions[Format];
+}
+
+bool SheetWriter::Convert(const LWUTF8Iterator &SrcPath, const LWUTF8Iterator &DstPath, uint32_t Format, const SheetEncoding &Encoding, LWAllocator &Allocator) {
+	SheetReaderQOI Reader;
+	if (!Reader.Open(SrcPath, Allocator)) return false;
+	LWVector2i Size = Reader.GetSize();
+	SheetWriter *Writer = Make(Format, Allocator);
+	if (!Writer) return false;
+	uint8_t *Band = Allocator.Allocate<uint8_t>((uint32_t)Size.x * 4 * BandRows);
+	bool Result = Writer->Begin(DstPath, Size, Encoding, Allocator);
+	for (uint32_t y = 0; y < (uint32_t)Size.y && Result; y += BandRows) {
+		uint32_t RowCount = std::min<uint32_t>(BandRows, (uint32_t)Size.y - y);
+		Result = Reader.ReadRows(Band, RowCount) && Writer->WriteRows(Band, RowCount);
+	}
+	Result = Result && Writer->Finish();
+	LWAllocator::Destroy(Band);
+	LWAllocator::Destroy(Writer);
+	return Result;
+}
+
+//SheetWriterPNG
+bool SheetWriterPNG::Begin(const LWUTF8Iterator &Path, const LWVector2i &Size, const SheetEncoding &Encoding, LWAllocator &Allocator) {
+	const uint8_t Signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	auto WriteBE = [](uint8_t *Buf, uint32_t Value) {
+		Buf[0] = (uint8_t)(Value >> 24);
+		Buf[1] = (uint8_t)(Value >> 16);
+		Buf[2] = (uint8_t)(Value >> 8);
+		Buf[3] = (uint8_t)Value;
+	};
+	m_Size = Size;
+	m_RowsWritten = 0;
+	if (!LWFileStream::OpenStream(m_Stream, Path, LWFileStream::WriteMode | LWFileStream::BinaryMode, Allocator, nullptr)) return false;
+	uint32_t RowLen = (uint32_t)m_Size.x * 4;
+	m_PrevRow = Allocator.Allocate<uint8_t>(RowLen);
+	m_FilterRow = Allocator.Allocate<uint8_t>(RowLen + 1);
+	m_TestRow = Allocator.Allocate<uint8_t>(RowLen + 1);
+	m_IDATBuffer = Allocator.Allocate<uint8_t>(IDATSize);
+	std::memset(m_PrevRow, 0, RowLen);
+
+	std::memset(&m_ZStream, 0, sizeof(m_ZStream));
+	if (deflateInit(&m_ZStream, CompressionLevel) != Z_OK) return false;
+	m_ZStreamValid = true;
+	m_ZStream.next_out = m_IDATBuffer;
+	m_ZStream.avail_out = IDATSize;
+
+	//8 bit RGBA, no interlacing.
+	uint8_t IHDR[13];
+	WriteBE(IHDR, (uint32_t)m_Size.x);
+	WriteBE(IHDR + 4, (uint32_t)m_Size.y);
+	IHDR[8] = 8;
+	IHDR[9] = 6;
+	IHDR[10] = IHDR[11] = IHDR[12] = 0;
+	if (m_Stream.Write((const char*)Signature, sizeof(Signature)) != sizeof(Signature)) return false;
+	return WriteChunk("IHDR", IHDR, sizeof(IHDR));
+}
+
+bool SheetWriterPNG::WriteRows(const uint8_t *Rows, uint32_t RowCount) {
+	if (!m_ZStreamValid) return false;
+	uint32_t RowLen = (uint32_t)m_Size.x * 4;
+	for (uint32_t i = 0; i < RowCount && m_RowsWritten < (uint32_t)m_Size.y; i++, m_RowsWritten++) {
+		const uint8_t *Row = Rows + RowLen * i;
+		FilterRow(Row);
+		if (!Deflate(m_FilterRow, RowLen + 1, Z_NO_FLUSH)) return false;
+		std::memcpy(m_PrevRow, Row, RowLen);
+	}
+	return true;
+}
+
+bool SheetWriterPNG::Finish(void) {
+	if (!m_ZStreamValid) return false;
+	if (m_RowsWritten != (uint32_t)m_Size.y) return false;
+	if (!Deflate(nullptr, 0, Z_FINISH)) return false;
+	deflateEnd(&m_ZStream);
+	m_ZStreamValid = false;
+	return WriteChunk("IEND", nullptr, 0);
+}
+
+bool SheetWriterPNG::WriteChunk(const char *Type, const uint8_t *Data, uint32_t Len) {
+	uint8_t Header[8] = { (uint8_t)(Len >> 24), (uint8_t)(Len >> 16), (uint8_t)(Len >> 8), (uint8_t)Len, (uint8_t)Type[0], (uint8_t)Type[1], (uint8_t)Type[2], (uint8_t)Type[3] };
+	uint32_t CRC = (uint32_t)crc32(0, Header + 4, 4);
+	if (Len) CRC = (uint32_t)crc32(CRC, Data, Len);
+	uint8_t Footer[4] = { (uint8_t)(CRC >> 24), (uint8_t)(CRC >> 16), (uint8_t)(CRC >> 8), (uint8_t)CRC };
+	if (m_Stream.Write((const char*)Header, sizeof(Header)) != sizeof(Header)) return false;
+	if (Len && m_Stream.Write((const char*)Data, Len) != Len) return false;
+	return m_Stream.Write((const char*)Footer, sizeof(Footer)) == sizeof(Footer);
+}
+
+bool SheetWriterPNG::Deflate(const uint8_t *Data, uint32_t Len, int32_t Flush) {
+	m_ZStream.next_in = (Bytef*)Data;
+	m_ZStream.avail_in = Len;
+	while (true) {
+		int32_t Res = deflate(&m_ZStream, Flush);
+		if (Res == Z_STREAM_ERROR) return false;
+		bool isFinished = Flush == Z_FINISH && Res == Z_STREAM_END;
+		//Flush a full IDAT chunk, or what remains once the stream has ended.
+		if (!m_ZStream.avail_out || (isFinished && m_ZStream.avail_out != IDATSize)) {
+			if (!WriteChunk("IDAT", m_IDATBuffer, IDATSize - m_ZStream.avail_out)) return false;
+			m_ZStream.next_out = m_IDATBuffer;
+			m_ZStream.avail_out = IDATSize;
+		}
+		if (isFinished) break;
+		if (Flush != Z_FINISH && !m_ZStream.avail_in && m_ZStream.avail_out) break;
+	}
+	return true;
+}
+
+void SheetWriterPNG::FilterRow(const uint8_t *Row) {
+	const uint32_t Bpp = 4;
+	uint32_t RowLen = (uint32_t)m_Size.x * 4;
+	const uint8_t *Prev = m_PrevRow;
+	auto Paeth = [](int32_t a, int32_t b, int32_t c)->uint8_t {
+		int32_t p = a + b - c;
+		int32_t pa = abs(p - a);
+		int32_t pb = abs(p - b);
+		int32_t pc = abs(p - c);
+		if (pa <= pb && pa <= pc) return (uint8_t)a;
+		if (pb <= pc) return (uint8_t)b;
+		return (uint8_t)c;
+	};
+	auto ApplyFilter = [&Row, &Prev, &RowLen, &Bpp, &Paeth](uint8_t Type, uint8_t *Out)->uint64_t {
+		uint64_t Sum = 0;
+		Out[0] = Type;
+		for (uint32_t i = 0; i < RowLen; i++) {
+			int32_t a = i >= Bpp ? Row[i - Bpp] : 0;
+			int32_t b = Prev[i];
+			int32_t c = i >= Bpp ? Prev[i - Bpp] : 0;
+			uint8_t v = Row[i];
+			if (Type == 1) v = (uint8_t)(v - a);
+			else if (Type == 2) v = (uint8_t)(v - b);
+			else if (Type == 3) v = (uint8_t)(v - ((a + b) >> 1));
+			else if (Type == 4) v = (uint8_t)(v - Paeth(a, b, c));
+			Out[i + 1] = v;
+			Sum += (uint64_t)(v < 128 ? v : 256 - v);
+		}
+		return Sum;
+	};
+	//Same heuristic as libpng's adaptive filtering, keep the filter with the smallest sum of signed differences.
+	uint64_t BestSum = ApplyFilter(0, m_FilterRow);
+	for (uint8_t Type = 1; Type < 5; Type++) {
+		uint64_t Sum = ApplyFilter(Type, m_TestRow);
+		if (Sum >= BestSum) continue;
+		BestSum = Sum;
+		std::swap(m_FilterRow, m_TestRow);
+	}
+	return;
+}
+
+SheetWriterPNG::~SheetWriterPNG() {
+	if (m_ZStreamValid) deflateEnd(&m_ZStream);
+	LWAllocator::Destroy(m_PrevRow);
+	LWAllocator::Destroy(m_FilterRow);
+	LWAllocator::Destroy(m_TestRow);
+	LWAllocator::Destroy(m_IDATBuffer);
+}
+
+//SheetWriterBC
+bool SheetWriterBC::Begin(const LWUTF8Iterator &Path, const LWVector2i &Size, const SheetEncoding &Encoding, LWAllocator &Allocator) {
+	m_Size = Size;
+	m_Encoding = Encoding;
+	m_RowsWritten = 0;
+	m_BandRows = 0;
+	m_PaddedWidth = ((uint32_t)m_Size.x + 3) & ~3u;
+	uint32_t BlockSize = BlockCompress::GetBlockSize(m_Encoding.m_BlockFormat);
+	uint32_t BlocksX = m_PaddedWidth / 4;
+	uint32_t BlocksY = ((uint32_t)m_Size.y + 3) / 4;
+	uint32_t DataSize = BlocksX * BlocksY * BlockSize;
+	if (!LWFileStream::OpenStream(m_Stream, Path, LWFileStream::WriteMode | LWFileStream::BinaryMode, Allocator, nullptr)) return false;
+	m_Band = Allocator.Allocate<uint8_t>(m_PaddedWidth * 4 * BandBlockRows * 4);
+	m_Blocks = Allocator.Allocate<uint8_t>(BlocksX * BlockSize * BandBlockRows);
+	if (m_Container == FormatKTX2) return WriteKTX2Header(DataSize);
+	return WriteDDSHeader(DataSize);
+}
+
+bool SheetWriterBC::WriteRows(const uint8_t *Rows, uint32_t RowCount) {
+	uint32_t RowLen = (uint32_t)m_Size.x * 4;
+	uint32_t PaddedRowLen = m_PaddedWidth * 4;
+	for (uint32_t i = 0; i < RowCount && m_RowsWritten < (uint32_t)m_Size.y; i++, m_RowsWritten++) {
+		uint8_t *Row = m_Band + PaddedRowLen * m_BandRows;
+		std::memcpy(Row, Rows + RowLen * i, RowLen);
+		//Replicate the edge texel into the padding so partial blocks don't bleed.
+		for (uint32_t o = RowLen; o < PaddedRowLen; o += 4) std::memcpy(Row + o, Row + RowLen - 4, 4);
+		if (++m_BandRows == BandBlockRows * 4 && !CompressBand()) return false;
+	}
+	return true;
+}
+
+bool SheetWriterBC::Finish(void) {
+	uint32_t PaddedRowLen = m_PaddedWidth * 4;
+	if (m_RowsWritten != (uint32_t)m_Size.y) return false;
+	if (!m_BandRows) return true;
+	for (; m_BandRows & 3; m_BandRows++) std::memcpy(m_Band + PaddedRowLen * m_BandRows, m_Band + PaddedRowLen * (m_BandRows - 1), PaddedRowLen);
+	return CompressBand();
+}
+
+bool SheetWriterBC::CompressBand(void) {
+	uint32_t BlockSize = BlockCompress::GetBlockSize(m_Encoding.m_BlockFormat);
+	uint32_t Len = (m_PaddedWidth / 4) * BlockSize * (m_BandRows / 4);
+	BlockCompress::CompressRows(m_Band, m_PaddedWidth, m_BandRows, m_Encoding.m_BlockFormat, m_Encoding.m_ChannelA, m_Encoding.m_ChannelB, m_Encoding.m_Quality, m_Blocks);
+	m_BandRows = 0;
+	return m_Stream.Write((const char*)m_Blocks, Len) == Len;
+}
+
+bool SheetWriterBC::WriteDDSHeader(uint32_t DataSize) {
+	const uint32_t DXGIFormats[BlockCompress::FormatCount] = { 80, 83, 98 }; //BC4_UNORM, BC5_UNORM, BC7_UNORM(+1 for srgb).
+	uint8_t Header[148] = {};
+	uint32_t DXGIFormat = DXGIFormats[m_Encoding.m_BlockFormat];
+	if (m_Encoding.m_BlockFormat == BlockCompress::BC7 && m_Encoding.m_sRGB) DXGIFormat++;
+	std::memcpy(Header, "DDS ", 4);
+	PutLE32(Header + 4, 124);
+	PutLE32(Header + 8, 0x81007); //Caps|Height|Width|PixelFormat|LinearSize.
+	PutLE32(Header + 12, (uint32_t)m_Size.y);
+	PutLE32(Header + 16, (uint32_t)m_Size.x);
+	PutLE32(Header + 20, DataSize);
+	PutLE32(Header + 28, 1);
+	PutLE32(Header + 76, 32);
+	PutLE32(Header + 80, 0x4); //FourCC pixel format.
+	std::memcpy(Header + 84, "DX10", 4);
+	PutLE32(Header + 108, 0x1000); //Texture caps.
+	//DX10 extended header.
+	PutLE32(Header + 128, DXGIFormat);
+	PutLE32(Header + 132, 3); //Texture2D.
+	PutLE32(Header + 140, 1);
+	return m_Stream.Write((const char*)Header, sizeof(Header)) == sizeof(Header);
+}
+
+bool SheetWriterBC::WriteKTX2Header(uint32_t DataSize) {
+	const uint8_t Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+	const uint32_t VkFormats[BlockCompress::FormatCount] = { 139, 141, 145 }; //BC4_UNORM, BC5_UNORM, BC7_UNORM(+1 for srgb).
+	const uint8_t ColorModels[BlockCompress::FormatCount] = { 131, 132, 134 };
+	const uint32_t DFDOffset = 104;
+	uint8_t Header[176] = {};
+	uint32_t BlockSize = BlockCompress::GetBlockSize(m_Encoding.m_BlockFormat);
+	uint32_t SampleCnt = m_Encoding.m_BlockFormat == BlockCompress::BC5 ? 2 : 1;
+	uint32_t DFDLen = 4 + 24 + 16 * SampleCnt;
+	uint32_t DataOffset = (DFDOffset + DFDLen + 15) & ~15u;
+	uint32_t VkFormat = VkFormats[m_Encoding.m_BlockFormat];
+	bool isSRGB = m_Encoding.m_BlockFormat == BlockCompress::BC7 && m_Encoding.m_sRGB;
+	if (isSRGB) VkFormat++;
+	std::memcpy(Header, Identifier, sizeof(Identifier));
+	PutLE32(Header + 12, VkFormat);
+	PutLE32(Header + 16, 1); //typeSize.
+	PutLE32(Header + 20, (uint32_t)m_Size.x);
+	PutLE32(Header + 24, (uint32_t)m_Size.y);
+	PutLE32(Header + 36, 1); //faceCount.
+	PutLE32(Header + 40, 1); //levelCount.
+	PutLE32(Header + 48, DFDOffset);
+	PutLE32(Header + 52, DFDLen);
+	//Single level index, no supercompression.
+	PutLE32(Header + 80, DataOffset);
+	PutLE32(Header + 88, DataSize);
+	PutLE32(Header + 96, DataSize);
+	//Basic data format descriptor.
+	uint8_t *DFD = Header + DFDOffset;
+	PutLE32(DFD, DFDLen);
+	PutLE32(DFD + 8, 2 | ((24 + 16 * SampleCnt) << 16)); //versionNumber, descriptorBlockSize.
+	DFD[12] = ColorModels[m_Encoding.m_BlockFormat];
+	DFD[13] = 1; //BT709 primaries.
+	DFD[14] = isSRGB ? 2 : 1; //sRGB or linear transfer.
+	DFD[16] = DFD[17] = 3; //4x4 texel blocks.
+	DFD[20] = (uint8_t)BlockSize;
+	for (uint32_t i = 0; i < SampleCnt; i++) {
+		uint8_t *Sample = DFD + 28 + 16 * i;
+		Sample[0] = (uint8_t)(i * 64);
+		Sample[2] = (uint8_t)(BlockSize * 8 / SampleCnt - 1);
+		Sample[3] = (uint8_t)i; //Red/Green channel id for BC5, data channel otherwise.
+		PutLE32(Sample + 12, 0xFFFFFFFF);
+	}
+	return m_Stream.Write((const char*)Header, DataOffset) == DataOffset;
+}
+
+SheetWriterBC::SheetWriterBC(uint32_t Container) : m_Container(Container) {}
+
+SheetWriterBC::~SheetWriterBC() {
+	LWAllocator::Destroy(m_Band);
+	LWAllocator::Destroy(m_Blocks);
+}
+
+//SheetWriterQOI
+bool SheetWriterQOI::Begin(const LWUTF8Iterator &Path, const LWVector2i &Size, const SheetEncoding &Encoding, LWAllocator &Allocator) {
+	m_Size = Size;
+	m_RowsWritten = 0;
+	m_Prev = 0xFF000000;
+	m_Run = 0;
+	std::memset(m_Index, 0, sizeof(m_Index));
+	if (!LWFileStream::OpenStream(m_Stream, Path, LWFileStream::WriteMode | LWFileStream::BinaryMode, Allocator, nullptr)) return false;
+	m_Buffer = Allocator.Allocate<uint8_t>(BufferSize);
+	//Magic, big endian size, 4 channels, srgb with linear alpha.
+	uint8_t Header[14] = { 'q', 'o', 'i', 'f', (uint8_t)(Size.x >> 24), (uint8_t)(Size.x >> 16), (uint8_t)(Size.x >> 8), (uint8_t)Size.x, (uint8_t)(Size.y >> 24), (uint8_t)(Size.y >> 16), (uint8_t)(Size.y >> 8), (uint8_t)Size.y, 4, 0 };
+	std::memcpy(m_Buffer, Header, sizeof(Header));
+	m_BufferLen = sizeof(Header);
+	return true;
+}
+
+bool SheetWriterQOI::WriteRows(const uint8_t *Rows, uint32_t RowCount) {
+	const uint32_t MaxOpSize = 5;
+	const uint32_t MaxRun = 62;
+	RowCount = std::min<uint32_t>(RowCount, (uint32_t)m_Size.y - m_RowsWritten);
+	uint32_t TexelCnt = (uint32_t)m_Size.x * RowCount;
+	uint8_t *Out = m_Buffer + m_BufferLen;
+	uint8_t *OutEnd = m_Buffer + BufferSize - MaxOpSize;
+	uint32_t Prev = m_Prev;
+	uint32_t Run = m_Run;
+	for (uint32_t i = 0; i < TexelCnt; i++) {
+		uint32_t Texel;
+		std::memcpy(&Texel, Rows + i * 4, sizeof(uint32_t));
+		if (Texel == Prev) {
+			if (++Run == MaxRun) {
+				*Out++ = 0xC0 | (uint8_t)(Run - 1);
+				Run = 0;
+			}
+		} else {
+			if (Run) {
+				*Out++ = 0xC0 | (uint8_t)(Run - 1);
+				Run = 0;
+			}
+			uint32_t Hash = QOIHash(Texel);
+			if (m_Index[Hash] == Texel) *Out++ = (uint8_t)Hash;
+			else {
+				m_Index[Hash] = Texel;
+				if ((Texel >> 24) == (Prev >> 24)) {
+					int8_t dr = (int8_t)((Texel & 0xFF) - (Prev & 0xFF));
+					int8_t dg = (int8_t)(((Texel >> 8) & 0xFF) - ((Prev >> 8) & 0xFF));
+					int8_t db = (int8_t)(((Texel >> 16) & 0xFF) - ((Prev >> 16) & 0xFF));
+					int8_t dr_dg = (int8_t)(dr - dg);
+					int8_t db_dg = (int8_t)(db - dg);
+					if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) *Out++ = 0x40 | (uint8_t)((dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+					else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+						*Out++ = 0x80 | (uint8_t)(dg + 32);
+						*Out++ = (uint8_t)((dr_dg + 8) << 4 | (db_dg + 8));
+					} else {
+						*Out++ = 0xFE;
+						std::memcpy(Out, &Texel, 3);
+						Out += 3;
+					}
+				} else {
+					*Out++ = 0xFF;
+					std::memcpy(Out, &Texel, 4);
+					Out += 4;
+				}
+			}
+			Prev = Texel;
+		}
+		if (Out >= OutEnd) {
+			m_BufferLen = (uint32_t)(Out - m_Buffer);
+			if (!FlushBuffer()) return false;
+			Out = m_Buffer;
+		}
+	}
+	m_BufferLen = (uint32_t)(Out - m_Buffer);
+	m_Prev = Prev;
+	m_Run = Run;
+	m_RowsWritten += RowCount;
+	return true;
+}
+
+bool SheetWriterQOI::Finish(void) {
+	const uint8_t EndMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+	if (m_RowsWritten != (uint32_t)m_Size.y) return false;
+	if (m_Run) {
+		m_Buffer[m_BufferLen++] = 0xC0 | (uint8_t)(m_Run - 1);
+		m_Run = 0;
+	}
+	if (m_BufferLen + sizeof(EndMarker) > BufferSize && !FlushBuffer()) return false;
+	std::memcpy(m_Buffer + m_BufferLen, EndMarker, sizeof(EndMarker));
+	m_BufferLen += sizeof(EndMarker);
+	return FlushBuffer();
+}
+
+bool SheetWriterQOI::FlushBuffer(void) {
+	uint32_t Len = m_BufferLen;
+	m_BufferLen = 0;
+	return m_Stream.Write((const char*)m_Buffer, Len) == Len;
+}
+
+SheetWriterQOI::~SheetWriterQOI() {
+	LWAllocator::Destroy(m_Buffer);
+}
+
+//SheetReaderQOI
+bool SheetReaderQOI::Open(const LWUTF8Iterator &Path, LWAllocator &Allocator) {
+	uint8_t Header[14];
+	m_Prev = 0xFF000000;
+	m_Run = 0;
+	std::memset(m_Index, 0, sizeof(m_Index));
+	if (!LWFileStream::OpenStream(m_Stream, Path, LWFileStream::ReadMode | LWFileStream::BinaryMode, Allocator, nullptr)) return false;
+	m_Buffer = Allocator.Allocate<uint8_t>(BufferSize);
+	for (uint32_t i = 0; i < sizeof(Header); i++) {
+		if (!NextByte(Header[i])) return false;
+	}
+	if (std::memcmp(Header, "qoif", 4)) return false;
+	m_Size.x = (int32_t)((uint32_t)Header[4] << 24 | (uint32_t)Header[5] << 16 | (uint32_t)Header[6] << 8 | Header[7]);
+	m_Size.y = (int32_t)((uint32_t)Header[8] << 24 | (uint32_t)Header[9] << 16 | (uint32_t)Header[10] << 8 | Header[11]);
+	return Header[12] == 4;
+}
+
+bool SheetReaderQOI::ReadRows(uint8_t *Rows, uint32_t RowCount) {
+	uint32_t TexelCnt = (uint32_t)m_Size.x * RowCount;
+	uint32_t Prev = m_Prev;
+	for (uint32_t i = 0; i < TexelCnt; i++) {
+		if (m_Run) m_Run--;
+		else {
+			uint8_t Op, b;
+			if (!NextByte(Op)) return false;
+			if (Op == 0xFE || Op == 0xFF) {
+				uint32_t Cnt = Op == 0xFE ? 3 : 4;
+				for (uint32_t n = 0; n < Cnt; n++) {
+					if (!NextByte(b)) return false;
+					Prev = (Prev & ~(0xFFu << (n * 8))) | ((uint32_t)b << (n * 8));
+				}
+			} else if ((Op & 0xC0) == 0x00) Prev = m_Index[Op];
+			else if ((Op & 0xC0) == 0x40) {
+				uint32_t r = ((Prev & 0xFF) + ((Op >> 4) & 3) - 2) & 0xFF;
+				uint32_t g = (((Prev >> 8) & 0xFF) + ((Op >> 2) & 3) - 2) & 0xFF;
+				uint32_t bl = (((Prev >> 16) & 0xFF) + (Op & 3) - 2) & 0xFF;
+				Prev = (Prev & 0xFF000000) | bl << 16 | g << 8 | r;
+			} else if ((Op & 0xC0) == 0x80) {
+				if (!NextByte(b)) return false;
+				int32_t dg = (int32_t)(Op & 0x3F) - 32;
+				uint32_t r = ((Prev & 0xFF) + dg - 8 + (b >> 4)) & 0xFF;
+				uint32_t g = (((Prev >> 8) & 0xFF) + dg) & 0xFF;
+				uint32_t bl = (((Prev >> 16) & 0xFF) + dg - 8 + (b & 0xF)) & 0xFF;
+				Prev = (Prev & 0xFF000000) | bl << 16 | g << 8 | r;
+			} else m_Run = Op & 0x3F;
+			m_Index[QOIHash(Prev)] = Prev;
+		}
+		std::memcpy(Rows + i * 4, &Prev, sizeof(uint32_t));
+	}
+	m_Prev = Prev;
+	return true;
+}
+
+const LWVector2i &SheetReaderQOI::GetSize(void) const {
+	return m_Size;
+}
+
+bool SheetReaderQOI::NextByte(uint8_t &Byte) {
+	if (m_BufferPos == m_BufferLen) {
+		m_BufferLen = m_Stream.Read(m_Buffer, BufferSize);
+		m_BufferPos = 0;
+		if (!m_BufferLen) return false;
+	}
+	Byte = m_Buffer[m_BufferPos++];
+	return true;
+}
+
+SheetReaderQOI::~SheetReaderQOI() {
+	LWAllocator::Destroy(m_Buffer);
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "SlotTable.h"
+
+//GSlotAllocator
+uint32_t GSlotAllocator::GetSlot(uint32_t ID) {
+	return ID & SlotMask;
+}
+
+uint32_t GSlotAllocator::Allocate(void) {
+	std::lock_guard<std::mutex> Lock(m_Lock);
+	uint32_t Slot = 0;
+	if (!m_FreeSlots.empty()) {
+		Slot = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+	} else {
+		if (m_Generations.empty()) m_Generations.push_back(0);
+		if (m_Generations.size() > SlotMask) return 0;
+		Slot = (uint32_t)m_Generations.size();
+		m_Generations.push_back(0);
+	}
+	return (m_Generations[Slot] << SlotBits) | Slot;
+}
+
+void GSlotAllocator::Free(uint32_t ID) {
+	std::lock_guard<std::mutex> Lock(m_Lock);
+	uint32_t Slot = GetSlot(ID);
+	if (!Slot || Slot >= m_Generations.size() || m_Generations[Slot] != (ID >> SlotBits)) return;
+	m_Generations[Slot] = (m_Generations[Slot] + 1) & GenerationMask;
+	m_FreeSlots.push_back(Slot);
+	return;
+}
+
+bool GSlotAllocator::isValid(uint32_t ID) {
+	std::lock_guard<std::mutex> Lock(m_Lock);
+	uint32_t Slot = GetSlot(ID);
+	return Slot && Slot < m_Generations.size() && m_Generations[Slot] == (ID >> SlotBits);
+}
\ No newline at end of file
@@ -0,0 +1,744 @@
+#include "SoftRenderer.h"
+#include "Renderer.h"
+#include "Logger.h"
+#include <LWCore/LWMatrix.h>
+#include <LWCore/LWUnicode.h>
+#include <LWVideo/LWImage.h>
+#include <algorithm>
+#include <thread>
+#include <cmath>
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SOFTRENDERER_SSE
+#include <xmmintrin.h>
+#endif
+
+//Standard 4x msaa sample positions, in 1/16th pixel offsets from the pixel center.
+static const float SampleX[SoftRenderer::SampleCount] = { -2.0f / 16.0f, 6.0f / 16.0f, -6.0f / 16.0f, 2.0f / 16.0f };
+static const float SampleY[SoftRenderer::SampleCount] = { -6.0f / 16.0f, -2.0f / 16.0f, 2.0f / 16.0f, 6.0f / 16.0f };
+
+static float Saturate(float v) {
+	return std::min(std::max(v, 0.0f), 1.0f);
+}
+
+static float SmoothStep(float Edge0, float Edge1, float v) {
+	float t = Saturate((v - Edge0) / (Edge1 - Edge0));
+	return t * t * (3.0f - 2.0f * t);
+}
+
+static LWSVector4f SaturateV(const LWSVector4f &V) {
+	return V.Max(LWSVector4f(0.0f)).Min(LWSVector4f(1.0f));
+}
+
+//pow(rgb, e) with alpha replaced, matches the shader's ToneMap/SRGBToLinear.
+static LWSVector4f PowRGB(const LWSVector4f &V, float e, float Alpha) {
+	LWVector4f C = V.AsVec4();
+	return LWSVector4f(powf(fabsf(C.x), e), powf(fabsf(C.y), e), powf(fabsf(C.z), e), Alpha);
+}
+
+static LWSVector4f ToneMap(const LWSVector4f &V, float Alpha) {
+	return PowRGB(V, 1.0f / 2.2f, Alpha);
+}
+
+//Maps ndc depth to the depth buffer's range.
+static float WindowDepth(float z) {
+	return LWMatrix4_UseDXOrtho ? z : z * 0.5f + 0.5f;
+}
+
+//Distance to the near plane, negative when the vertex is behind it.
+static float NearDistance(const LWVector4f &Clip) {
+	return LWMatrix4_UseDXOrtho ? Clip.z : Clip.z + Clip.w;
+}
+
+static SoftRenderer::Vertex LerpVertex(const SoftRenderer::Vertex &A, const SoftRenderer::Vertex &B, float t, bool DepthOnly) {
+	SoftRenderer::Vertex R;
+	R.m_Clip = A.m_Clip + (B.m_Clip - A.m_Clip) * t;
+	if (DepthOnly) return R;
+	for (uint32_t i = 0; i < SoftRenderer::AttrCount; i++) R.m_Attr[i] = A.m_Attr[i] + (B.m_Attr[i] - A.m_Attr[i]) * t;
+	return R;
+}
+
+//Perspective correct interpolation of the triangle's attributes at pixel position x, y.
+static void InterpolateAttributes(const SoftRenderer::Triangle &T, float x, float y, float *Attr) {
+	float Lambda[3];
+	float iW = 0.0f;
+	for (uint32_t i = 0; i < 3; i++) {
+		Lambda[i] = (T.m_EdgeA[i] * x + T.m_EdgeB[i] * y + T.m_EdgeC[i]) * T.m_iArea;
+		iW += Lambda[i] * T.m_iW[i];
+	}
+	float W = 1.0f / iW;
+	for (uint32_t i = 0; i < SoftRenderer::AttrCount; i++) Attr[i] = (Lambda[0] * T.m_Attr[0][i] + Lambda[1] * T.m_Attr[1][i] + Lambda[2] * T.m_Attr[2][i]) * W;
+	return;
+}
+
+//Tests every sample of pixel x, y against the triangle's edges and the depth already in PixelDepth, writes each sample's depth to SampleDepth and returns the mask of samples that pass.
+//With SSE the four samples are one lane each, evaluated in the same order as the scalar path so both produce the same coverage.
+static uint32_t SampleCoverage(const SoftRenderer::Triangle &T, int32_t x, int32_t y, const float *PixelDepth, float *SampleDepth) {
+	static_assert(SoftRenderer::SampleCount == 4, "SampleCoverage expects one sse lane per sample.");
+#ifdef SOFTRENDERER_SSE
+	const __m128 Zero = _mm_setzero_ps();
+	__m128 px = _mm_add_ps(_mm_set1_ps(x + 0.5f), _mm_loadu_ps(SampleX));
+	__m128 py = _mm_add_ps(_mm_set1_ps(y + 0.5f), _mm_loadu_ps(SampleY));
+	__m128 Inside = _mm_cmpeq_ps(Zero, Zero);
+	__m128 Z = Zero;
+	for (uint32_t i = 0; i < 3; i++) {
+		__m128 E = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(T.m_EdgeA[i]), px), _mm_mul_ps(_mm_set1_ps(T.m_EdgeB[i]), py)), _mm_set1_ps(T.m_EdgeC[i]));
+		__m128 EdgeInside = _mm_cmpgt_ps(E, Zero);
+		if (T.m_TopLeft[i]) EdgeInside = _mm_or_ps(EdgeInside, _mm_cmpeq_ps(E, Zero));
+		Inside = _mm_and_ps(Inside, EdgeInside);
+		Z = _mm_add_ps(Z, _mm_mul_ps(_mm_mul_ps(E, _mm_set1_ps(T.m_iArea)), _mm_set1_ps(T.m_Depth[i])));
+	}
+	_mm_storeu_ps(SampleDepth, Z);
+	Inside = _mm_and_ps(Inside, _mm_cmpge_ps(Z, Zero));
+	Inside = _mm_and_ps(Inside, _mm_cmple_ps(Z, _mm_set1_ps(1.0f)));
+	Inside = _mm_and_ps(Inside, _mm_cmple_ps(Z, _mm_loadu_ps(PixelDepth)));
+	return (uint32_t)_mm_movemask_ps(Inside);
+#else
+	uint32_t Mask = 0;
+	for (uint32_t s = 0; s < SoftRenderer::SampleCount; s++) {
+		float px = x + 0.5f + SampleX[s];
+		float py = y + 0.5f + SampleY[s];
+		bool Inside = true;
+		float Z = 0.0f;
+		for (uint32_t i = 0; i < 3; i++) {
+			float E = T.m_EdgeA[i] * px + T.m_EdgeB[i] * py + T.m_EdgeC[i];
+			Inside = Inside && (E > 0.0f || (E == 0.0f && T.m_TopLeft[i]));
+			Z += E * T.m_iArea * T.m_Depth[i];
+		}
+		SampleDepth[s] = Z;
+		if (Inside && Z >= 0.0f && Z <= 1.0f && Z <= PixelDepth[s]) Mask |= 1 << s;
+	}
+	return Mask;
+#endif
+}
+
+//Bilinear sample with repeat wrapping, textures are not mipmapped.
+static LWSVector4f SampleTexture(const SoftTexture &Tex, const LWVector2f &TexCoord) {
+	auto Texel = [&Tex](int32_t x, int32_t y) -> LWSVector4f {
+		const uint8_t *T = Tex.m_Texels.data() + ((size_t)y * Tex.m_Size.x + x) * 4;
+		return LWSVector4f((float)T[0], (float)T[1], (float)T[2], (float)T[3]) * (1.0f / 255.0f);
+	};
+	if (!std::isfinite(TexCoord.x) || !std::isfinite(TexCoord.y)) return LWSVector4f(0.0f);
+	float x = (TexCoord.x - floorf(TexCoord.x)) * Tex.m_Size.x - 0.5f;
+	float y = (TexCoord.y - floorf(TexCoord.y)) * Tex.m_Size.y - 0.5f;
+	float fx = floorf(x);
+	float fy = floorf(y);
+	float tx = x - fx;
+	float ty = y - fy;
+	int32_t x0 = ((int32_t)fx + Tex.m_Size.x) % Tex.m_Size.x;
+	int32_t y0 = ((int32_t)fy + Tex.m_Size.y) % Tex.m_Size.y;
+	int32_t x1 = (x0 + 1) % Tex.m_Size.x;
+	int32_t y1 = (y0 + 1) % Tex.m_Size.y;
+	LWSVector4f A = Texel(x0, y0) * (1.0f - tx) + Texel(x1, y0) * tx;
+	LWSVector4f B = Texel(x0, y1) * (1.0f - tx) + Texel(x1, y1) * tx;
+	return A * (1.0f - ty) + B * ty;
+}
+
+//SoftRenderer
+void SoftRenderer::PushGeometry(uint32_t ID, const char *Data, uint32_t TypeSize, uint32_t Count) {
+	if (!Data || !Count) {
+		m_GeometryMap.erase(ID);
+		return;
+	}
+	SoftGeometry &Geom = m_GeometryMap[ID];
+	Geom.m_Data.assign(Data, Data + (size_t)TypeSize * Count);
+	Geom.m_TypeSize = TypeSize;
+	Geom.m_Count = Count;
+	return;
+}
+
+void SoftRenderer::PushTexture(uint32_t ID, const LWImage *Image) {
+	if (!Image) {
+		m_TextureMap.erase(ID);
+		return;
+	}
+	if (Image->GetPackType() != LWImage::RGBA8) {
+		LogWarn(LWUTF8I::Fmt<128>("Software renderer only supports RGBA8 textures, texture {} will be treated as unbound.", ID));
+		m_TextureMap.erase(ID);
+		return;
+	}
+	SoftTexture &Tex = m_TextureMap[ID];
+	Tex.m_Size = Image->GetSize2D();
+	const uint8_t *Texels = Image->GetTexels(0);
+	Tex.m_Texels.assign(Texels, Texels + (size_t)Tex.m_Size.x * Tex.m_Size.y * 4);
+	return;
+}
+
+SoftRenderer &SoftRenderer::SetShadowSize(const LWVector2i &Size) {
+	m_ShadowSize = Size;
+	for (auto &&Map : m_ShadowMaps) Map.clear();
+	return *this;
+}
+
+SoftRenderer &SoftRenderer::RenderFrame(GFrame &F) {
+	LWVector4i TargetBounds = F.m_TargetViewBounds;
+	uint32_t RType = F.m_GlobalData.RenderOutput & RenderBits;
+	if (TargetBounds.z <= 0 || TargetBounds.w <= 0 || RType >= (uint32_t)RenderCount) return *this;
+	if (!F.m_PassList[GFrame::MainViewPass].isInitialized(F.m_FrameID)) return *this;
+	if (F.m_TargetTextureSize != m_OutputSize) {
+		m_OutputSize = F.m_TargetTextureSize;
+		m_Output.assign((size_t)m_OutputSize.x * m_OutputSize.y * 4 * RenderCount, 0);
+	}
+	size_t LayerSize = (size_t)m_OutputSize.x * m_OutputSize.y * 4;
+	if (F.m_SpriteFrame == 0) std::fill(m_Output.begin() + LayerSize * RType, m_Output.begin() + LayerSize * (RType + 1), 0);
+	if ((F.m_GlobalData.RenderOutput & RenderIBLFlag) != 0 && !m_WarnedIBL) {
+		LogWarn("Software renderer does not support image based lighting, only scene lights are applied.");
+		m_WarnedIBL = true;
+	}
+	//Lighting only contributes to the default output, so the debug layers skip the shadow passes.
+	if (RType == RenderDefault) {
+		for (uint32_t i = GFrame::RTFirstPass; i < MaxRawPasses; i++) {
+			GFramePass &Pass = F.m_PassList[i];
+			if (!Pass.isInitialized(F.m_FrameID) || !Pass.isShadowed() || Pass.isPoint()) continue;
+			RenderShadowPass(F, i);
+		}
+	}
+	//The sprite's view bounds are the same size as it's tile, so each window pixel lands on a tile pixel.
+	LWVector2f ScreenSize = F.m_GlobalData.ScreenSize;
+	SoftViewport Viewport;
+	Viewport.m_Scale = ScreenSize * 0.5f;
+	Viewport.m_Offset = ScreenSize * 0.5f - LWVector2f(F.m_ViewBounds.x, F.m_ViewBounds.y) * ScreenSize;
+	Viewport.m_Size = LWVector2i(TargetBounds.z, TargetBounds.w);
+	size_t PixelCount = (size_t)Viewport.m_Size.x * Viewport.m_Size.y;
+	m_Color.assign(PixelCount, LWVector4f(0.0f));
+	m_Emission.assign(PixelCount, LWVector4f(0.0f));
+	if (BuildPass(F, GFrame::MainViewPass, Viewport, false)) {
+		m_Pool.Run(m_BinCount.x * m_BinCount.y, [this, &F, RType](uint32_t Tile, uint32_t Worker) {
+			RenderTile(F, Tile, Worker, RType);
+		});
+	}
+	ResolveOutput(F, RType);
+	return *this;
+}
+
+const uint8_t *SoftRenderer::GetOutputLayer(uint32_t Layer) const {
+	if (m_Output.empty() || Layer >= (uint32_t)RenderCount) return nullptr;
+	return m_Output.data() + (size_t)m_OutputSize.x * m_OutputSize.y * 4 * Layer;
+}
+
+LWVector2i SoftRenderer::GetOutputSize(void) const {
+	return m_OutputSize;
+}
+
+SoftRenderer::Vertex SoftRenderer::TransformVertex(const char *Vert, bool isSkinned, const GModelData &ModelData, const GAnimData *AnimData, const LWSMatrix4f &ProjView, bool DepthOnly) const {
+	const LWSVector4f Zero = LWSVector4f(0.0f);
+	const GStaticVertice *V = (const GStaticVertice*)Vert;
+	LWSMatrix4f Transform = ModelData.TransformMatrix;
+	if (isSkinned) {
+		const GSkeletonVertice *SV = (const GSkeletonVertice*)Vert;
+		const LWVector4f &W = SV->m_BoneWeights;
+		const LWVector4i &I = SV->m_BoneIndices;
+		LWSMatrix4f Blend = AnimData->BoneMatrixs[I.x] * W.x + AnimData->BoneMatrixs[I.y] * W.y + AnimData->BoneMatrixs[I.z] * W.z + AnimData->BoneMatrixs[I.w] * W.w;
+		Transform = Blend * Transform;
+	}
+	Vertex R;
+	LWSVector4f WPosition = LWSVector4f(V->m_Position) * Transform;
+	R.m_Clip = WPosition * ProjView;
+	if (DepthOnly) return R;
+	LWSVector4f Normal = (LWSVector4f(V->m_Normal).AAAB(Zero) * Transform).Normalize3();
+	LWSVector4f Tangent = (LWSVector4f(V->m_Tangent).AAAB(Zero) * Transform).Normalize3();
+	Tangent = (Tangent - Normal * Tangent.Dot3(Normal)).Normalize3();
+	LWSVector4f BiTangent = Normal.Cross3(Tangent) * V->m_Tangent.w;
+	LWVector4f P = WPosition.AsVec4();
+	LWVector4f T = Tangent.AsVec4();
+	LWVector4f B = BiTangent.AsVec4();
+	LWVector4f N = Normal.AsVec4();
+	float *A = R.m_Attr;
+	A[AttrWPosition] = P.x; A[AttrWPosition + 1] = P.y; A[AttrWPosition + 2] = P.z;
+	A[AttrTexCoord] = V->m_TexCoord.x; A[AttrTexCoord + 1] = V->m_TexCoord.y;
+	A[AttrTransparency] = 1.0f - V->m_TexCoord.z;
+	A[AttrTangent] = T.x; A[AttrTangent + 1] = T.y; A[AttrTangent + 2] = T.z;
+	A[AttrBiTangent] = B.x; A[AttrBiTangent + 1] = B.y; A[AttrBiTangent + 2] = B.z;
+	A[AttrNormal] = N.x; A[AttrNormal + 1] = N.y; A[AttrNormal + 2] = N.z;
+	return R;
+}
+
+void SoftRenderer::PushModel(GFrame &F, uint32_t ModelIndex, uint32_t PassID, const SoftViewport &Viewport, bool Transparent, bool DepthOnly) {
+	const GFrameModel &Mdl = F.m_ModelList[ModelIndex];
+	auto VIter = m_GeometryMap.find(Mdl.m_VerticeID);
+	if (VIter == m_GeometryMap.end()) return;
+	const SoftGeometry &VGeom = VIter->second;
+	const SoftGeometry *IGeom = nullptr;
+	if (Mdl.m_IndiceID) {
+		auto IIter = m_GeometryMap.find(Mdl.m_IndiceID);
+		if (IIter == m_GeometryMap.end()) return;
+		IGeom = &IIter->second;
+	}
+	bool isSkinned = VGeom.m_TypeSize == sizeof(GSkeletonVertice);
+	if (!isSkinned && VGeom.m_TypeSize != sizeof(GStaticVertice)) return;
+	uint32_t Total = IGeom ? IGeom->m_Count : VGeom.m_Count;
+	uint32_t Offset = Mdl.m_Offset;
+	uint32_t Count = Mdl.m_Count ? Mdl.m_Count : Total;
+	if (Offset >= Total) return;
+	Count = std::min(Count, Total - Offset);
+
+	const GModelData &ModelData = *F.GetModelDataAt(Mdl.GetModelBufferID());
+	const GAnimData *AnimData = isSkinned ? F.GetAnimDataAt(Mdl.GetAnimBufferID()) : nullptr;
+	const LWSMatrix4f &ProjView = F.m_GlobalData.ProjViewMatrixs[PassID];
+	uint32_t Flags = (Mdl.m_Flags & GFrameModel::NoDepthOut) == 0 ? Triangle::DepthOut : 0;
+	//Shadow passes never blend.
+	if (!DepthOnly && (Transparent || (Mdl.m_Flags & GFrameModel::ForceTransparency) != 0)) Flags |= Triangle::Blend;
+
+	m_VertexCache.assign(VGeom.m_Count, -1);
+	m_Vertices.clear();
+	auto Fetch = [&](uint32_t i) -> int32_t {
+		uint32_t Idx = i;
+		if (IGeom) Idx = IGeom->m_TypeSize == sizeof(uint16_t) ? ((const uint16_t*)IGeom->m_Data.data())[i] : ((const uint32_t*)IGeom->m_Data.data())[i];
+		if (Idx >= VGeom.m_Count) return -1;
+		if (m_VertexCache[Idx] < 0) {
+			m_VertexCache[Idx] = (int32_t)m_Vertices.size();
+			m_Vertices.push_back(TransformVertex(VGeom.m_Data.data() + (size_t)Idx * VGeom.m_TypeSize, isSkinned, ModelData, AnimData, ProjView, DepthOnly));
+		}
+		return m_VertexCache[Idx];
+	};
+	for (uint32_t i = Offset; i + 2 < Offset + Count; i += 3) {
+		int32_t a = Fetch(i);
+		int32_t b = Fetch(i + 1);
+		int32_t c = Fetch(i + 2);
+		if (a < 0 || b < 0 || c < 0) continue;
+		ClipTriangle(m_Vertices[a], m_Vertices[b], m_Vertices[c], Viewport, ModelIndex, Flags, DepthOnly);
+	}
+	return;
+}
+
+void SoftRenderer::ClipTriangle(const Vertex &A, const Vertex &B, const Vertex &C, const SoftViewport &Viewport, uint32_t ModelIndex, uint32_t Flags, bool DepthOnly) {
+	const Vertex *In[3] = { &A, &B, &C };
+	LWVector4f Clip[3] = { A.m_Clip.AsVec4(), B.m_Clip.AsVec4(), C.m_Clip.AsVec4() };
+	//Trivially reject triangles entirely outside of one of the side planes, anything partially outside is handled by the raster bounds.
+	if (Clip[0].x > Clip[0].w && Clip[1].x > Clip[1].w && Clip[2].x > Clip[2].w) return;
+	if (Clip[0].x < -Clip[0].w && Clip[1].x < -Clip[1].w && Clip[2].x < -Clip[2].w) return;
+	if (Clip[0].y > Clip[0].w && Clip[1].y > Clip[1].w && Clip[2].y > Clip[2].w) return;
+	if (Clip[0].y < -Clip[0].w && Clip[1].y < -Clip[1].w && Clip[2].y < -Clip[2].w) return;
+	float Dist[3] = { NearDistance(Clip[0]), NearDistance(Clip[1]), NearDistance(Clip[2]) };
+	if (Dist[0] >= 0.0f && Dist[1] >= 0.0f && Dist[2] >= 0.0f) {
+		SetupTriangle(A, B, C, Viewport, ModelIndex, Flags, DepthOnly);
+		return;
+	}
+	//Clipping a triangle against the near plane leaves at most a quad.
+	Vertex Out[4];
+	uint32_t OutCount = 0;
+	for (uint32_t i = 0; i < 3; i++) {
+		uint32_t n = (i + 1) % 3;
+		if (Dist[i] >= 0.0f) Out[OutCount++] = *In[i];
+		if ((Dist[i] >= 0.0f) != (Dist[n] >= 0.0f)) Out[OutCount++] = LerpVertex(*In[i], *In[n], Dist[i] / (Dist[i] - Dist[n]), DepthOnly);
+	}
+	for (uint32_t i = 2; i < OutCount; i++) SetupTriangle(Out[0], Out[i - 1], Out[i], Viewport, ModelIndex, Flags, DepthOnly);
+	return;
+}
+
+void SoftRenderer::SetupTriangle(const Vertex &A, const Vertex &B, const Vertex &C, const SoftViewport &Viewport, uint32_t ModelIndex, uint32_t Flags, bool DepthOnly) {
+	const float SubPixel = 256.0f;
+	const Vertex *V[3] = { &A, &B, &C };
+	float X[3], Y[3], Z[3], iW[3];
+	for (uint32_t i = 0; i < 3; i++) {
+		LWVector4f Clip = V[i]->m_Clip.AsVec4();
+		iW[i] = 1.0f / Clip.w;
+		//Snap to 8 bits of sub-pixel precision like gpu rasterizers, so shared edges stay watertight.
+		X[i] = std::round((Clip.x * iW[i] * Viewport.m_Scale.x + Viewport.m_Offset.x) * SubPixel) / SubPixel;
+		Y[i] = std::round((Clip.y * iW[i] * Viewport.m_Scale.y + Viewport.m_Offset.y) * SubPixel) / SubPixel;
+		Z[i] = WindowDepth(Clip.z * iW[i]);
+	}
+	float Area = (X[1] - X[0]) * (Y[2] - Y[0]) - (X[2] - X[0]) * (Y[1] - Y[0]);
+	//Lit pipelines cull clockwise faces, while the shadow pipeline culls counter clockwise faces.
+	if (DepthOnly ? Area >= 0.0f : Area <= 0.0f) return;
+	uint32_t Order[3] = { 0, 1, 2 };
+	if (Area < 0.0f) {
+		std::swap(Order[1], Order[2]);
+		Area = -Area;
+	}
+	auto ClampPixel = [](float v, int32_t Size) -> int32_t {
+		return (int32_t)std::min(std::max(v, -1.0f), (float)Size);
+	};
+	Triangle T;
+	T.m_Bounds.x = std::max(ClampPixel(floorf(std::min(std::min(X[0], X[1]), X[2])), Viewport.m_Size.x), 0);
+	T.m_Bounds.y = std::max(ClampPixel(floorf(std::min(std::min(Y[0], Y[1]), Y[2])), Viewport.m_Size.y), 0);
+	T.m_Bounds.z = std::min(ClampPixel(ceilf(std::max(std::max(X[0], X[1]), X[2])), Viewport.m_Size.x), Viewport.m_Size.x - 1);
+	T.m_Bounds.w = std::min(ClampPixel(ceilf(std::max(std::max(Y[0], Y[1]), Y[2])), Viewport.m_Size.y), Viewport.m_Size.y - 1);
+	if (T.m_Bounds.x > T.m_Bounds.z || T.m_Bounds.y > T.m_Bounds.w) return;
+	for (uint32_t i = 0; i < 3; i++) {
+		uint32_t a = Order[(i + 1) % 3];
+		uint32_t b = Order[(i + 2) % 3];
+		uint32_t v = Order[i];
+		float dx = X[b] - X[a];
+		float dy = Y[b] - Y[a];
+		T.m_EdgeA[i] = -dy;
+		T.m_EdgeB[i] = dx;
+		T.m_EdgeC[i] = dy * X[a] - dx * Y[a];
+		//Counter clockwise with y up, so left edges point down and top edges point left.
+		T.m_TopLeft[i] = dy < 0.0f || (dy == 0.0f && dx < 0.0f);
+		T.m_Depth[i] = Z[v];
+		T.m_iW[i] = iW[v];
+		if (!DepthOnly) {
+			for (uint32_t n = 0; n < AttrCount; n++) T.m_Attr[i][n] = V[v]->m_Attr[n] * iW[v];
+		}
+	}
+	T.m_iArea = 1.0f / Area;
+	T.m_ModelIndex = ModelIndex;
+	T.m_Flags = Flags;
+	uint32_t Index = (uint32_t)m_Triangles.size();
+	m_Triangles.push_back(T);
+	for (int32_t y = T.m_Bounds.y / (int32_t)TileSize; y <= T.m_Bounds.w / (int32_t)TileSize; y++) {
+		for (int32_t x = T.m_Bounds.x / (int32_t)TileSize; x <= T.m_Bounds.z / (int32_t)TileSize; x++) m_Bins[y * m_BinCount.x + x].push_back(Index);
+	}
+	return;
+}
+
+bool SoftRenderer::BuildPass(GFrame &F, uint32_t PassID, const SoftViewport &Viewport, bool DepthOnly) {
+	GFramePass &Pass = F.m_PassList[PassID];
+	m_PassViewport = Viewport;
+	m_BinCount = (Viewport.m_Size + LWVector2i(TileSize - 1)) / LWVector2i(TileSize);
+	m_Triangles.clear();
+	m_Bins.resize(m_BinCount.x * m_BinCount.y);
+	for (auto &&Bin : m_Bins) Bin.clear();
+	for (uint32_t i = 0; i < Pass.m_ElementCount; i++) PushModel(F, Pass.m_Elements[i].m_Index, PassID, Viewport, Pass.m_Elements[i].isTransparent(), DepthOnly);
+	return !m_Triangles.empty();
+}
+
+void SoftRenderer::RenderShadowPass(GFrame &F, uint32_t PassID) {
+	uint32_t Layer = F.m_PassList[PassID].m_TargetIndex;
+	if (Layer >= MaxShadowLayers) return;
+	std::vector<float> &Map = m_ShadowMaps[Layer];
+	Map.assign((size_t)m_ShadowSize.x * m_ShadowSize.y, 1.0f);
+	LWVector2f Size = LWVector2f((float)m_ShadowSize.x, (float)m_ShadowSize.y);
+	SoftViewport Viewport = { Size * 0.5f, Size * 0.5f, m_ShadowSize };
+	if (!BuildPass(F, PassID, Viewport, true)) return;
+	//Depth only, so every pixel is sampled once at it's center.
+	m_Pool.Run(m_BinCount.x * m_BinCount.y, [this, &Map](uint32_t Tile, uint32_t) {
+		int32_t TileX = (Tile % m_BinCount.x) * TileSize;
+		int32_t TileY = (Tile / m_BinCount.x) * TileSize;
+		int32_t TileMaxX = std::min(TileX + (int32_t)TileSize, m_PassViewport.m_Size.x) - 1;
+		int32_t TileMaxY = std::min(TileY + (int32_t)TileSize, m_PassViewport.m_Size.y) - 1;
+		for (auto &&Index : m_Bins[Tile]) {
+			const Triangle &T = m_Triangles[Index];
+			if ((T.m_Flags & Triangle::DepthOut) == 0) continue;
+			for (int32_t y = std::max(T.m_Bounds.y, TileY); y <= std::min(T.m_Bounds.w, TileMaxY); y++) {
+				float py = y + 0.5f;
+				float *Row = Map.data() + (size_t)y * m_PassViewport.m_Size.x;
+				for (int32_t x = std::max(T.m_Bounds.x, TileX); x <= std::min(T.m_Bounds.z, TileMaxX); x++) {
+					float px = x + 0.5f;
+					bool Inside = true;
+					float Depth = 0.0f;
+					for (uint32_t i = 0; i < 3; i++) {
+						float E = T.m_EdgeA[i] * px + T.m_EdgeB[i] * py + T.m_EdgeC[i];
+						Inside = Inside && (E > 0.0f || (E == 0.0f && T.m_TopLeft[i]));
+						Depth += E * T.m_iArea * T.m_Depth[i];
+					}
+					if (!Inside || Depth < 0.0f || Depth > 1.0f) continue;
+					Row[x] = std::min(Row[x], Depth);
+				}
+			}
+		}
+	});
+	return;
+}
+
+void SoftRenderer::RenderTile(GFrame &F, uint32_t Tile, uint32_t Worker, uint32_t RType) {
+	const uint32_t TileSamples = TileSize * TileSize * SampleCount;
+	float *Depth = m_TileDepth.data() + (size_t)Worker * TileSamples;
+	LWVector4f *Color = m_TileColor.data() + (size_t)Worker * TileSamples;
+	LWVector4f *Emission = m_TileEmission.data() + (size_t)Worker * TileSamples;
+	std::fill(Depth, Depth + TileSamples, 1.0f);
+	std::fill(Color, Color + TileSamples, LWVector4f(0.0f));
+	std::fill(Emission, Emission + TileSamples, LWVector4f(0.0f));
+	int32_t TileX = (Tile % m_BinCount.x) * TileSize;
+	int32_t TileY = (Tile / m_BinCount.x) * TileSize;
+	int32_t TileMaxX = std::min(TileX + (int32_t)TileSize, m_PassViewport.m_Size.x) - 1;
+	int32_t TileMaxY = std::min(TileY + (int32_t)TileSize, m_PassViewport.m_Size.y) - 1;
+	for (auto &&Index : m_Bins[Tile]) {
+		const Triangle &T = m_Triangles[Index];
+		const GFrameModel &Mdl = F.m_ModelList[T.m_ModelIndex];
+		for (int32_t y = std::max(T.m_Bounds.y, TileY); y <= std::min(T.m_Bounds.w, TileMaxY); y++) {
+			for (int32_t x = std::max(T.m_Bounds.x, TileX); x <= std::min(T.m_Bounds.z, TileMaxX); x++) {
+				uint32_t PixelIdx = ((y - TileY) * TileSize + (x - TileX)) * SampleCount;
+				float *PixelDepth = Depth + PixelIdx;
+				float SampleDepth[SampleCount];
+				uint32_t Mask = SampleCoverage(T, x, y, PixelDepth, SampleDepth);
+				if (!Mask) continue;
+				//Shaded once at the pixel center like msaa, and the result is written to every covered sample.
+				float Attr[AttrCount];
+				LWSVector4f SrcColor, SrcEmission;
+				InterpolateAttributes(T, x + 0.5f, y + 0.5f, Attr);
+				if (!ShadePixel(F, Mdl, Attr, RType, SrcColor, SrcEmission)) continue;
+				LWVector4f C = SaturateV(SrcColor).AsVec4();
+				LWVector4f E = SaturateV(SrcEmission).AsVec4();
+				for (uint32_t s = 0; s < SampleCount; s++) {
+					if ((Mask & (1 << s)) == 0) continue;
+					LWVector4f &DstColor = Color[PixelIdx + s];
+					LWVector4f &DstEmission = Emission[PixelIdx + s];
+					if (T.m_Flags & Triangle::Blend) {
+						DstColor = C * C.w + DstColor * (1.0f - C.w);
+						DstEmission = E * E.w + DstEmission * (1.0f - E.w);
+					} else {
+						DstColor = C;
+						DstEmission = E;
+					}
+					if (T.m_Flags & Triangle::DepthOut) PixelDepth[s] = SampleDepth[s];
+				}
+			}
+		}
+	}
+	//Resolve the samples into the sprite tile.
+	const float iSampleCount = 1.0f / SampleCount;
+	for (int32_t y = TileY; y <= TileMaxY; y++) {
+		for (int32_t x = TileX; x <= TileMaxX; x++) {
+			uint32_t PixelIdx = ((y - TileY) * TileSize + (x - TileX)) * SampleCount;
+			LWVector4f C = LWVector4f(0.0f);
+			LWVector4f E = LWVector4f(0.0f);
+			for (uint32_t s = 0; s < SampleCount; s++) {
+				C += Color[PixelIdx + s];
+				E += Emission[PixelIdx + s];
+			}
+			size_t Dst = (size_t)y * m_PassViewport.m_Size.x + x;
+			m_Color[Dst] = C * iSampleCount;
+			m_Emission[Dst] = E * iSampleCount;
+		}
+	}
+	return;
+}
+
+void SoftRenderer::ResolveOutput(GFrame &F, uint32_t RType) {
+	//Same 5 tap gaussian the gpu renderer blurs emission with, at it's 10 pixel radius.
+	const float Factors[5] = { 0.06136f, 0.24477f, 0.38774f, 0.24477f, 0.06136f };
+	const int32_t BlurStep = 10;
+	LWVector4i TargetBounds = F.m_TargetViewBounds;
+	int32_t Width = TargetBounds.z;
+	int32_t Height = TargetBounds.w;
+	//Debug outputs write no emission, so only the default output is blurred.
+	if (RType == RenderDefault) {
+		auto Blur = [this, &Factors, Width, Height](const LWVector4f *Src, LWVector4f *Dst, int32_t dx, int32_t dy) {
+			m_Pool.Run(Height, [&](uint32_t y, uint32_t) {
+				for (int32_t x = 0; x < Width; x++) {
+					LWVector4f Sum = LWVector4f(0.0f);
+					for (int32_t k = -2; k <= 2; k++) {
+						int32_t sx = x + k * dx * BlurStep;
+						int32_t sy = (int32_t)y + k * dy * BlurStep;
+						if (sx < 0 || sy < 0 || sx >= Width || sy >= Height) continue;
+						Sum += Src[(size_t)sy * Width + sx] * Factors[k + 2];
+					}
+					Dst[(size_t)y * Width + x] = Sum;
+				}
+			});
+		};
+		m_BlurTemp.resize(m_Emission.size());
+		Blur(m_Emission.data(), m_BlurTemp.data(), 1, 0);
+		Blur(m_BlurTemp.data(), m_Emission.data(), 0, 1);
+	}
+	//Composite like the gpu's final pass, rows are flipped since the output is stored top row first.
+	uint8_t *Layer = m_Output.data() + (size_t)m_OutputSize.x * m_OutputSize.y * 4 * RType;
+	auto Quantize = [](float v) -> uint8_t {
+		return (uint8_t)floorf(Saturate(v) * 255.0f + 0.5f);
+	};
+	for (int32_t y = 0; y < Height; y++) {
+		int32_t Row = TargetBounds.y + (Height - 1 - y);
+		if (Row < 0 || Row >= m_OutputSize.y) continue;
+		for (int32_t x = 0; x < Width; x++) {
+			int32_t Column = TargetBounds.x + x;
+			if (Column < 0 || Column >= m_OutputSize.x) continue;
+			const LWVector4f &A = m_Color[(size_t)y * Width + x];
+			const LWVector4f &B = m_Emission[(size_t)y * Width + x];
+			LWVector4f C = A + B - A * B;
+			uint8_t *Dst = Layer + ((size_t)Row * m_OutputSize.x + Column) * 4;
+			Dst[0] = Quantize(C.x);
+			Dst[1] = Quantize(C.y);
+			Dst[2] = Quantize(C.z);
+			Dst[3] = Quantize(C.w);
+		}
+	}
+	return;
+}
+
+bool SoftRenderer::ShadePixel(GFrame &F, const GFrameModel &Mdl, const float *Attr, uint32_t RType, LWSVector4f &Color, LWSVector4f &Emission) const {
+	const LWSVector4f One = LWSVector4f(1.0f);
+	const LWSVector4f Zero = LWSVector4f(0.0f);
+	uint32_t Pipeline = Mdl.m_PipelineID;
+	//Skybox and cloud pipelines aren't used by exports.
+	if (Pipeline != Material::PBRMetallicRoughness && Pipeline != Material::PBRSpecularGlossiness && Pipeline != Material::PBRUnlit) return false;
+	const GMaterial &Mat = *F.GetMaterialAt(F.GetModelDataAt(Mdl.GetModelBufferID())->MaterialIndex);
+	LWVector2f TexCoord = LWVector2f(Attr[AttrTexCoord], Attr[AttrTexCoord + 1]);
+	LWSVector4f WPosition = LWSVector4f(Attr[AttrWPosition], Attr[AttrWPosition + 1], Attr[AttrWPosition + 2], 1.0f);
+	LWSVector4f Tangent = LWSVector4f(Attr[AttrTangent], Attr[AttrTangent + 1], Attr[AttrTangent + 2], 0.0f);
+	LWSVector4f BiTangent = LWSVector4f(Attr[AttrBiTangent], Attr[AttrBiTangent + 1], Attr[AttrBiTangent + 2], 0.0f);
+	LWSVector4f Normal = LWSVector4f(Attr[AttrNormal], Attr[AttrNormal + 1], Attr[AttrNormal + 2], 0.0f);
+	LWSVector4f nViewDir = (F.m_GlobalData.ViewPositions[GFrame::MainViewPass] - WPosition).AAAB(Zero).Normalize3();
+	float Alpha = Attr[AttrTransparency];
+
+	Emission = LWSVector4f(Mat.EmissiveFactor) * SampleIf(Mdl, Mat, GMaterial::EmissiveTexID, TexCoord, true, One);
+	Color = Emission;
+	float AOcclusion = SampleIf(Mdl, Mat, GMaterial::OcclussionTexID, TexCoord, false, One).AsVec4().x;
+	LWVector4f NormalSmp = SampleIf(Mdl, Mat, GMaterial::NormalTexID, TexCoord, false, LWSVector4f(0.5f, 0.5f, 1.0f, 0.5f)).AsVec4();
+	LWSVector4f N = (Tangent * (NormalSmp.x * 2.0f - 1.0f) + BiTangent * (NormalSmp.y * 2.0f - 1.0f) + Normal * (NormalSmp.z * 2.0f - 1.0f)).Normalize3();
+
+	LWSVector4f Diffuse, Reflect0, Reflect90, DebugAlbedo, DebugMetallic;
+	float aRoughness = 0.0f;
+	if (Pipeline == Material::PBRMetallicRoughness) {
+		const LWSVector4f F0 = LWSVector4f(0.04f);
+		LWSVector4f Albedo = LWSVector4f(Mat.MaterialColorA) * SampleIf(Mdl, Mat, GMaterial::PBRAlbedoTexID, TexCoord, true, One);
+		LWSVector4f MRSmp = SampleIf(Mdl, Mat, GMaterial::PBRMetallicRoughnessTexID, TexCoord, false, One);
+		LWVector4f MR = MRSmp.AsVec4();
+		float Metallic = Mat.MaterialColorB.x * MR.z;
+		float Roughness = Mat.MaterialColorB.y * MR.y;
+		float A = Roughness * Roughness;
+		aRoughness = A * A;
+		Diffuse = Albedo * (One - F0) * (1.0f - Metallic);
+		Reflect0 = F0 + (Albedo - F0) * Metallic;
+		LWVector4f R0 = Reflect0.AsVec4();
+		Reflect90 = LWSVector4f(Saturate(std::max(std::max(R0.x, R0.y), R0.z) * 50.0f));
+		Alpha *= Albedo.AsVec4().w;
+		DebugAlbedo = Albedo;
+		DebugMetallic = MRSmp * LWSVector4f(1.0f, Mat.MaterialColorB.y, Mat.MaterialColorB.x, 1.0f);
+	} else if (Pipeline == Material::PBRSpecularGlossiness) {
+		LWSVector4f Diff = LWSVector4f(Mat.MaterialColorA) * SampleIf(Mdl, Mat, GMaterial::SGDiffuseColorTexID, TexCoord, true, One);
+		LWSVector4f Spec = LWSVector4f(Mat.MaterialColorB) * SampleIf(Mdl, Mat, GMaterial::SGSpecularColorTexID, TexCoord, true, One);
+		LWVector4f S = Spec.AsVec4();
+		float Roughness = 1.0f - S.w;
+		float Metallic = std::max(std::max(S.x, S.y), S.z);
+		float A = Roughness * Roughness;
+		aRoughness = A * A;
+		Diffuse = Diff * (1.0f - Metallic);
+		Reflect0 = Spec;
+		Reflect90 = LWSVector4f(Saturate(Metallic * 50.0f));
+		Alpha *= Diff.AsVec4().w;
+		DebugAlbedo = Diff;
+		DebugMetallic = LWSVector4f(1.0f, Metallic, Roughness, 1.0f);
+	} else {
+		LWSVector4f ULColor = LWSVector4f(Mat.MaterialColorA) * SampleIf(Mdl, Mat, GMaterial::ULColorTexID, TexCoord, true, One);
+		DebugMetallic = Color;
+		Color = Color + ULColor;
+		Alpha *= ULColor.AsVec4().w;
+		DebugAlbedo = ULColor;
+	}
+	if (Alpha < 0.01f) return false;
+	if (RType != RenderDefault) {
+		if (RType == RenderEmissions) Color = ToneMap(Emission, Alpha);
+		else if (RType == RenderNormals) Color = (N * 0.5f + LWSVector4f(0.5f)).AAAB(One);
+		else if (RType == RenderAlbedo) Color = ToneMap(DebugAlbedo, Alpha);
+		else Color = DebugMetallic;
+		Emission = Zero;
+		return true;
+	}
+	Emission = ToneMap(Emission, Alpha);
+	if (Pipeline == Material::PBRUnlit) {
+		Color = ToneMap(Color, Alpha);
+		return true;
+	}
+	for (uint32_t i = 0; i < F.m_LightCount; i++) {
+		const GLight &L = F.m_LightsBuffer[i];
+		LWVector4f LPos = L.m_Position.AsVec4();
+		LWVector4f LDir = L.m_Direction.AsVec4();
+		float Att = 1.0f;
+		float NdotL, NdotV, NdotH, VdotH;
+		if (LPos.w < 0.0f) {
+			//Ambient light.
+			Att = (-LPos.w - 1.0f) * AOcclusion;
+			NdotL = 1.0f;
+			NdotV = 0.0f;
+			NdotH = 0.5f;
+			VdotH = 0.5f;
+		} else {
+			LWSVector4f LightDir;
+			if (LPos.w == 0.0f) {
+				LightDir = (Zero - L.m_Direction).AAAB(Zero);
+				Att = DirectionShadow(F, L.m_ShadowIdxs, WPosition);
+			} else {
+				LWSVector4f Dir = (WPosition - L.m_Position).AAAB(Zero);
+				LWSVector4f nDir = Dir.Normalize3();
+				LightDir = Zero - nDir;
+				if (LPos.w == 1.0f) {
+					//Point light, cube map shadows are not supported so they're treated as unshadowed.
+					Att = 1.0f - Saturate((Dir.Length3() - LDir.y) / LDir.x);
+				} else {
+					float Len = LDir.w;
+					float MinCos = cosf(LPos.w - 1.0f);
+					float MaxCos = MinCos + (1.0f - MinCos) * 0.5f;
+					LWSVector4f SpotDir = L.m_Direction.AAAB(Zero);
+					Att = SpotShadow(F, L.m_ShadowIdxs.x, WPosition) * (1.0f - SmoothStep(Len * 0.75f, Len, SpotDir.Dot3(Dir))) * SmoothStep(MinCos, MaxCos, SpotDir.Dot3(nDir));
+				}
+			}
+			LWSVector4f nHalf = (nViewDir + LightDir).Normalize3();
+			NdotL = Saturate(N.Dot3(LightDir));
+			NdotV = Saturate(N.Dot3(nViewDir));
+			NdotH = Saturate(N.Dot3(nHalf));
+			VdotH = Saturate(nViewDir.Dot3(nHalf));
+		}
+		float A2 = aRoughness;
+		LWSVector4f Fr = Reflect0 + (Reflect90 - Reflect0) * powf(Saturate(1.0f - VdotH), 5.0f);
+		float G = NdotL * sqrtf(NdotV * NdotV * (1.0f - A2) + A2) + NdotV * sqrtf(NdotL * NdotL * (1.0f - A2) + A2);
+		G = G > 0.0f ? 0.5f / G : 0.0f;
+		float K = (NdotH * A2 - NdotH) * NdotH + 1.0f;
+		float D = K > 0.0f ? A2 / (LW_PI * K * K) : 0.0f;
+		LWSVector4f Light = Fr * (G * D) + (One - Fr) * Diffuse * (1.0f / LW_PI);
+		Color = Color + LWSVector4f(L.m_Color.x, L.m_Color.y, L.m_Color.z, 1.0f) * (L.m_Color.w * Att * NdotL) * Light;
+	}
+	Color = ToneMap(Color, Alpha);
+	return true;
+}
+
+LWSVector4f SoftRenderer::SampleIf(const GFrameModel &Mdl, const GMaterial &Mat, uint32_t TexID, const LWVector2f &TexCoord, bool MakeLinear, const LWSVector4f &DefaultValue) const {
+	if ((Mat.HasTexturesFlag & (1 << TexID)) == 0) return DefaultValue;
+	auto Iter = m_TextureMap.find(Mdl.m_TextureList[TexID].m_TextureID);
+	if (Iter == m_TextureMap.end()) return DefaultValue;
+	const LWVector4f &SubTexture = Mat.SubTextures[TexID];
+	LWSVector4f Smp = SampleTexture(Iter->second, LWVector2f(SubTexture.x, SubTexture.y) + LWVector2f(SubTexture.z, SubTexture.w) * TexCoord);
+	if (MakeLinear) Smp = PowRGB(Smp, 2.2f, Smp.AsVec4().w);
+	return Smp;
+}
+
+float SoftRenderer::SampleShadow(uint32_t Layer, const LWVector2f &TexCoord, float Depth, float Bias) const {
+	//4 bilinear comparison taps, one texel around the center.
+	const float Offsets[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { -1.0f, 1.0f }, { 1.0f, 1.0f } };
+	if (Layer >= MaxShadowLayers || m_ShadowMaps[Layer].empty()) return 1.0f;
+	const std::vector<float> &Map = m_ShadowMaps[Layer];
+	int32_t Width = m_ShadowSize.x;
+	int32_t Height = m_ShadowSize.y;
+	float Ref = Saturate(Depth - Bias);
+	auto Compare = [&Map, Width, Height, Ref](int32_t x, int32_t y) -> float {
+		x = std::min(std::max(x, 0), Width - 1);
+		y = std::min(std::max(y, 0), Height - 1);
+		return Ref <= Map[(size_t)y * Width + x] ? 1.0f : 0.0f;
+	};
+	float Att = 0.0f;
+	for (uint32_t i = 0; i < 4; i++) {
+		float x = std::min(std::max(TexCoord.x * Width - 0.5f + Offsets[i][0], -2.0f), (float)Width + 1.0f);
+		float y = std::min(std::max(TexCoord.y * Height - 0.5f + Offsets[i][1], -2.0f), (float)Height + 1.0f);
+		float fx = floorf(x);
+		float fy = floorf(y);
+		float tx = x - fx;
+		float ty = y - fy;
+		int32_t ix = (int32_t)fx;
+		int32_t iy = (int32_t)fy;
+		Att += (Compare(ix, iy) * (1.0f - tx) + Compare(ix + 1, iy) * tx) * (1.0f - ty) + (Compare(ix, iy + 1) * (1.0f - tx) + Compare(ix + 1, iy + 1) * tx) * ty;
+	}
+	return Att * 0.25f;
+}
+
+float SoftRenderer::DirectionShadow(GFrame &F, const LWVector4i &ShadowIdxs, const LWSVector4f &WPosition) const {
+	const int32_t Idxs[4] = { ShadowIdxs.x, ShadowIdxs.y, ShadowIdxs.z, ShadowIdxs.w };
+	const float MinZ = LWMatrix4_UseDXOrtho ? 0.0f : -1.0f;
+	//Cascades are ordered nearest first, the first cascade containing the position is used.
+	for (uint32_t i = 0; i < 4; i++) {
+		int32_t TargetPass = Idxs[i];
+		if (TargetPass < 0) return 1.0f;
+		if (TargetPass >= (int32_t)MaxRawPasses) continue;
+		LWVector4f P = (WPosition * F.m_GlobalData.ProjViewMatrixs[TargetPass]).AsVec4();
+		float iW = 1.0f / P.w;
+		LWVector2f TexCoord = LWVector2f(P.x * iW, P.y * iW) * 0.5f + 0.5f;
+		float z = P.z * iW;
+		if (TexCoord.x < 0.0f || TexCoord.x > 1.0f || TexCoord.y < 0.0f || TexCoord.y > 1.0f || z < MinZ || z > 1.0f) continue;
+		return SampleShadow((uint32_t)F.m_GlobalData.TargetValues[TargetPass].x, TexCoord, WindowDepth(z), -0.0001f);
+	}
+	return 1.0f;
+}
+
+float SoftRenderer::SpotShadow(GFrame &F, int32_t TargetPass, const LWSVector4f &WPosition) const {
+	if (TargetPass < 0 || TargetPass >= (int32_t)MaxRawPasses) return 1.0f;
+	LWVector4f P = (WPosition * F.m_GlobalData.ProjViewMatrixs[TargetPass]).AsVec4();
+	float iW = 1.0f / P.w;
+	LWVector2f TexCoord = LWVector2f(P.x * iW, P.y * iW) * 0.5f + 0.5f;
+	return SampleShadow((uint32_t)F.m_GlobalData.TargetValues[TargetPass].x, TexCoord, WindowDepth(P.z * iW), -0.0001f);
+}
+
+SoftRenderer::SoftRenderer(uint32_t ThreadCount) : m_ThreadCount(ThreadCount ? ThreadCount : std::max(std::thread::hardware_concurrency(), 1u)), m_Pool(m_ThreadCount) {
+	size_t TileSamples = (size_t)TileSize * TileSize * SampleCount * m_ThreadCount;
+	m_TileDepth.resize(TileSamples);
+	m_TileColor.resize(TileSamples);
+	m_TileEmission.resize(TileSamples);
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "SpriteHash.h"
+#include <LWPlatform/LWFileStream.h>
+
+//SpriteHasher
+SpriteHasher &SpriteHasher::Push(const void *Data, uint32_t Len) {
+	const uint8_t *Bytes = (const uint8_t*)Data;
+	for (uint32_t i = 0; i < Len; i++) m_Hash = (m_Hash ^ Bytes[i]) * Prime;
+	return *this;
+}
+
+uint64_t SpriteHasher::Get(void) const {
+	return m_Hash;
+}
+
+SpriteHasher::SpriteHasher(uint64_t Hash) : m_Hash(Hash) {}
+
+//SpriteHashFile
+const char8_t *SpriteHashFile::Extension = "hash";
+
+bool SpriteHashFile::Save(const LWUTF8Iterator &Path, LWAllocator &Allocator) const {
+	SpriteHashHeader H = { Magic, Version, m_TexSize.x, m_TexSize.y, m_LayoutHash, (uint32_t)m_Hashes.size(), 0 };
+	uint32_t HashesLen = (uint32_t)(m_Hashes.size() * sizeof(uint64_t));
+	LWFileStream Stream;
+	if (!LWFileStream::OpenStream(Stream, Path, LWFileStream::WriteMode | LWFileStream::BinaryMode, Allocator, nullptr)) return false;
+	uint32_t Written = Stream.Write((const char*)&H, sizeof(H));
+	if (HashesLen) Written += Stream.Write((const char*)m_Hashes.data(), HashesLen);
+	return Written == sizeof(H) + HashesLen;
+}
+
+bool SpriteHashFile::Load(const LWUTF8Iterator &Path, LWAllocator &Allocator) {
+	SpriteHashHeader H;
+	LWFileStream Stream;
+	m_Hashes.clear();
+	if (!LWFileStream::OpenStream(Stream, Path, LWFileStream::ReadMode | LWFileStream::BinaryMode, Allocator, nullptr)) return false;
+	if (Stream.Read((uint8_t*)&H, sizeof(H)) != sizeof(H) || H.m_Magic != Magic || H.m_Version != Version) return false;
+	if (Stream.Length() != sizeof(H) + (uint64_t)H.m_SpriteCount * sizeof(uint64_t)) return false;
+	m_TexSize = LWVector2i(H.m_Width, H.m_Height);
+	m_LayoutHash = H.m_LayoutHash;
+	m_Hashes.resize(H.m_SpriteCount);
+	uint32_t HashesLen = H.m_SpriteCount * sizeof(uint64_t);
+	if (HashesLen && Stream.Read((uint8_t*)m_Hashes.data(), HashesLen) != HashesLen) {
+		m_Hashes.clear();
+		return false;
+	}
+	return true;
+}
\ No newline at end of file
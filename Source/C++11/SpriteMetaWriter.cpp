@@ -0,0 +1,107 @@
+#include "SpriteMetaWriter.h"
+
+static std::string MakeMetaString(const LWUTF8Iterator &Str) {
+	char8_t Buffer[256];
+	Str.Copy(Buffer, sizeof(Buffer));
+	return std::string((const char*)Buffer);
+}
+
+//SpriteMetaWriter
+SpriteMetaWriter &SpriteMetaWriter::SetLayout(uint32_t DirectionCount, uint32_t FrameCount, uint32_t Flags) {
+	m_Header.m_DirectionCount = DirectionCount;
+	m_Header.m_FrameCount = FrameCount;
+	m_Header.m_Flags = Flags;
+	m_FrameTimes.assign(FrameCount, 0.0f);
+	m_Sprites.assign(DirectionCount * FrameCount, SpriteMetaRecord());
+	return *this;
+}
+
+SpriteMetaWriter &SpriteMetaWriter::SetTimes(float TotalTime, float TimeOffset, float RotationOffset) {
+	m_Header.m_TotalTime = TotalTime;
+	m_Header.m_TimeOffset = TimeOffset;
+	m_Header.m_RotationOffset = RotationOffset;
+	return *this;
+}
+
+SpriteMetaWriter &SpriteMetaWriter::PushSheet(const LWUTF8Iterator &Key, const LWUTF8Iterator &Path) {
+	m_SheetKeys.push_back(MakeMetaString(Key));
+	m_SheetPaths.push_back(MakeMetaString(Path));
+	return *this;
+}
+
+bool SpriteMetaWriter::SetSheetPath(const LWUTF8Iterator &Key, const LWUTF8Iterator &Path) {
+	std::string KeyStr = MakeMetaString(Key);
+	for (uint32_t i = 0; i < (uint32_t)m_SheetKeys.size(); i++) {
+		if (m_SheetKeys[i] != KeyStr) continue;
+		m_SheetPaths[i] = MakeMetaString(Path);
+		return true;
+	}
+	return false;
+}
+
+SpriteMetaWriter &SpriteMetaWriter::SetFrameTime(uint32_t Frame, float Time) {
+	m_FrameTimes[Frame] = Time;
+	return *this;
+}
+
+SpriteMetaWriter &SpriteMetaWriter::SetSprite(uint32_t Frame, uint32_t Direction, const SpriteMetaRecord &Record) {
+	m_Sprites[Frame * m_Header.m_DirectionCount + Direction] = Record;
+	return *this;
+}
+
+bool SpriteMetaWriter::Save(const LWUTF8Iterator &Path, LWAllocator &Allocator) {
+	uint32_t SheetCount = (uint32_t)m_SheetKeys.size();
+	std::vector<SpriteMetaSheet> Sheets(SheetCount);
+	std::string StringTable;
+	for (uint32_t i = 0; i < SheetCount; i++) {
+		Sheets[i].m_KeyOffset = (uint32_t)StringTable.size();
+		StringTable.append(m_SheetKeys[i]).push_back('\0');
+		Sheets[i].m_PathOffset = (uint32_t)StringTable.size();
+		StringTable.append(m_SheetPaths[i]).push_back('\0');
+	}
+	//Keep the string table non-empty and the file size a multiple of 4.
+	do StringTable.push_back('\0'); while (StringTable.size() & 3);
+
+	SpriteMetaHeader H = m_Header;
+	H.m_Magic = SpriteMetaMagic;
+	H.m_Version = SpriteMetaVersion;
+	H.m_HeaderSize = sizeof(SpriteMetaHeader);
+	H.m_SheetCount = SheetCount;
+	H.m_SheetTableOffset = sizeof(SpriteMetaHeader);
+	H.m_FrameTableOffset = H.m_SheetTableOffset + SheetCount * sizeof(SpriteMetaSheet);
+	H.m_SpriteTableOffset = H.m_FrameTableOffset + (uint32_t)m_FrameTimes.size() * sizeof(float);
+	H.m_StringTableOffset = H.m_SpriteTableOffset + (uint32_t)m_Sprites.size() * sizeof(SpriteMetaRecord);
+	H.m_StringTableSize = (uint32_t)StringTable.size();
+	H.m_FileSize = H.m_StringTableOffset + H.m_StringTableSize;
+	H.m_Reserved = 0;
+
+	LWFileStream Stream;
+	if (!LWFileStream::OpenStream(Stream, Path, LWFileStream::WriteMode | LWFileStream::BinaryMode, Allocator, nullptr)) return false;
+	uint32_t Written = Stream.Write((const char*)&H, sizeof(H));
+	if (SheetCount) Written += Stream.Write((const char*)Sheets.data(), SheetCount * sizeof(SpriteMetaSheet));
+	if (!m_FrameTimes.empty()) Written += Stream.Write((const char*)m_FrameTimes.data(), (uint32_t)m_FrameTimes.size() * sizeof(float));
+	if (!m_Sprites.empty()) Written += Stream.Write((const char*)m_Sprites.data(), (uint32_t)m_Sprites.size() * sizeof(SpriteMetaRecord));
+	Written += Stream.Write(StringTable.data(), H.m_StringTableSize);
+	return Written == H.m_FileSize;
+}
+
+bool SpriteMetaWriter::Load(const LWUTF8Iterator &Path, LWAllocator &Allocator) {
+	LWFileStream Stream;
+	if (!LWFileStream::OpenStream(Stream, Path, LWFileStream::ReadMode | LWFileStream::BinaryMode, Allocator, nullptr)) return false;
+	uint32_t Len = Stream.Length();
+	uint8_t *Data = Allocator.Allocate<uint8_t>(Len);
+	SpriteMetaReader Reader;
+	bool Result = Stream.Read(Data, Len) == Len && Reader.Open(Data, Len);
+	if (Result) {
+		const SpriteMetaHeader *H = Reader.GetHeader();
+		SetLayout(H->m_DirectionCount, H->m_FrameCount, H->m_Flags);
+		SetTimes(H->m_TotalTime, H->m_TimeOffset, H->m_RotationOffset);
+		m_SheetKeys.clear();
+		m_SheetPaths.clear();
+		for (uint32_t i = 0; i < Reader.GetSheetCount(); i++) PushSheet(Reader.GetSheetKey(i), Reader.GetSheetPath(i));
+		m_FrameTimes.assign(Reader.GetFrameTimes(), Reader.GetFrameTimes() + H->m_FrameCount);
+		m_Sprites.assign(Reader.GetSprites(), Reader.GetSprites() + m_Sprites.size());
+	}
+	LWAllocator::Destroy(Data);
+	return Result;
+}
\ No newline at end of file
@@ -5,11 +5,18 @@
 #include "Logger.h"
 #include "UICameraControls.h"
 #include "UILightingProps.h"
+#include "SpriteMetaWriter.h"
 #include <LWEJson.h>
+#include <algorithm>
+#include <string>
+#include <cstring>
 
 
 const char8_t *State_Viewer::RenderPathNames[] = { "", "_Emissions", "_Normals", "_Albedo", "_MetallicRough" };
+const char8_t *State_Viewer::RenderImageNames[] = { "Color", "Emissions", "Normals", "Albedo", "Metallic" };
 const char8_t *State_Viewer::SettingPath = "App:Settings.json";
+//Color layers are BC7 in srgb, normals keep x/y in BC5, and metallic+roughness is stored as BC5 with roughness in red and metallic in green.
+const SheetEncoding State_Viewer::RenderEncodings[] = { SheetEncoding(BlockCompress::BC7, 0, 1, true), SheetEncoding(BlockCompress::BC7, 0, 1, true), SheetEncoding(BlockCompress::BC5, 0, 1, false), SheetEncoding(BlockCompress::BC7, 0, 1, true), SheetEncoding(BlockCompress::BC5, 1, 2, false) };
 
 void State_Viewer::Update(float dTime, App *A, uint64_t lCurrentTime) {
 	LWEUIManager *UIMan = A->GetUIManager();
@@ -42,8 +49,11 @@ void State_Viewer::Draw(GFrame &F, Renderer *R, LWWindow *Window, App *A) {
 	//Initialize required render passes.
 	F.InitializePass(GFrame::MainViewPass, Cam);
 	F.InitializePass(GFrame::OutlinePass, Cam);
-	//Initialize shadow render pass.
-	F.InitializeRTPasses(LWSVector4f(-10.0f), LWSVector4f(10.0f));
+	//Initialize shadow render pass, fit to the model's world bounds for this frame(or a fixed volume if nothing has a mesh).
+	LWSVector4f MinBounds = LWSVector4f(-10.0f, -10.0f, -10.0f, 1.0f);
+	LWSVector4f MaxBounds = LWSVector4f(10.0f, 10.0f, 10.0f, 1.0f);
+	LWVector4i B = m_ViewScene->CaclulateBounding(m_Time, LWSMatrix4f::RotationY(m_ModelTheta), WndSize, Cam, BorderSize, MinBounds, MaxBounds);
+	F.InitializeRTPasses(MinBounds, MaxBounds);
 	m_ViewScene->DrawScene(F, R, m_Time, ~GFrame::OutlineBits, LWSMatrix4f::RotationY(m_ModelTheta));
 
 	//Draw sun
@@ -55,8 +65,6 @@ void State_Viewer::Draw(GFrame &F, Renderer *R, LWWindow *Window, App *A) {
 	}
 	
 	//Draw tight bounding volume.
-	LWSVector4f MinBounds, MaxBounds;
-	LWVector4i B = m_ViewScene->CaclulateBounding(m_Time, LWSMatrix4f::RotationY(m_ModelTheta), WndSize, Cam, BorderSize, MinBounds, MaxBounds);
 	LWVector4f Bf = B.CastTo<float>();
 	LWEUIMaterial Mat = LWEUIMaterial(LWVector4f(0.0f, 0.0f, 1.0f, 1.0f));
 	LWVector2f BL = LWVector2f(Bf.x, Bf.y);
@@ -75,30 +83,38 @@ bool State_Viewer::ConfigureFrameExportSettings(GFrame &F, Renderer *R, LWWindow
 	LWVector2f WndSize = Window->GetSizef();
 	UIFile &FileProps = m_UIViewer.m_FileProps;
 	UIIsometricProps &IsoProps = m_UIViewer.m_IsometricProps;
+	UIAnimationProps &AnimProps = m_UIViewer.m_AnimationProps;
 	uint32_t ExportCnt = FileProps.GetExportTypeCount();
 	if (m_ExportFirstFrame == -1) {
-		//Initialize exporting sprites.
+		//Initialize exporting sprites, shards still lay out every sprite so their sheets line up, but only render their own directions.
 		m_ExportFirstFrame = F.m_FrameID;
 		m_ExportTexSize = FileProps.CalculateSpriteLocations(WndSize, A, m_ExportList);
-		m_ExportFinalFrame = m_ExportFirstFrame + (uint32_t)m_ExportList.size() * ExportCnt;
-		if (!m_ExportList.size()) {
+		m_ExportSpriteFirst = m_ExportShard.GetFirstDirection(IsoProps.m_DirectionCnt) * AnimProps.m_FrameCnt;
+		m_ExportSpriteCount = m_ExportShard.GetDirectionCount(IsoProps.m_DirectionCnt) * AnimProps.m_FrameCnt;
+		if (!m_ExportSpriteCount || m_ExportSpriteFirst + m_ExportSpriteCount > (uint32_t)m_ExportList.size()) {
 			A->SetMessage("Error: Something went wrong calculating sprite sizes.");
 			m_Exporting = false;
 			return false;
 		}
+		BuildExportRenderList(WndSize, R, A);
+		m_ExportFinalFrame = m_ExportFirstFrame + (uint32_t)m_ExportRenderList.size();
 	}
 	uint32_t ID = F.m_FrameID - m_ExportFirstFrame;
-	uint32_t ExportID = ID / (uint32_t)m_ExportList.size();
-	if (ExportID >= ExportCnt) return false;
-	//Get current sprite index for rendering setting..
-	ID = ID % m_ExportList.size();
-	F.m_SpriteFrame = ID;
-	F.m_GlobalData.RenderOutput = FileProps.GetExportRenderSetting(ExportID);
-
-	Sprite &S = m_ExportList[ID];
+	if (ID >= (uint32_t)m_ExportRenderList.size()) return false;
+	//Find the layer the sprite is rendered into.
+	uint32_t Layer = 0;
+	for (uint32_t i = 0; i < ExportCnt; i++) {
+		Layer = FileProps.GetExportRenderSetting(i);
+		if (ID < m_ExportLayers[Layer].m_RenderFirst + m_ExportLayers[Layer].m_RenderCount) break;
+	}
+	F.m_SpriteFrame = ID - m_ExportLayers[Layer].m_RenderFirst;
+	F.m_GlobalData.RenderOutput = Layer;
+
+	Sprite &S = m_ExportList[m_ExportRenderList[ID]];
 	m_Time = S.m_Time;
 	m_ModelTheta = IsoProps.CalculateDirectionTheta(S.m_Direction);
 	F.m_TargetTextureSize = m_ExportTexSize;
+	for (uint32_t i = 0; i < ExportCnt; i++) F.m_TargetLayers |= 1 << FileProps.GetExportRenderSetting(i);
 	F.m_TargetViewBounds = LWVector4i(S.m_TexPosition, S.m_TexSize);
 	F.m_ViewBounds = S.m_ViewBounds;
 	return true;
@@ -143,127 +159,511 @@ bool State_Viewer::LoadScene(const LWUTF8Iterator &Path, App *A) {
 		return false;
 	}
 	A->SetMessage("Loaded model.");
-	//Push previous scene to old scene to prevent data races until oldscene is fully cleared.
+	//Push previous scene to old scene to prevent data races until oldscene is fully cleared, cached scenes stay owned by the cache.
 	m_Time = 0.0f;
-	m_OldScene = m_ViewScene;
+	m_OldScene = isSceneCached(m_ViewScene) ? nullptr : m_ViewScene;
 	m_ViewScene = S;
 	return true;
 }
 
+bool State_Viewer::LoadCachedScene(const LWUTF8Iterator &Path, App *A, bool &Cached) {
+	LWAllocator &Alloc = A->GetAllocator();
+	char8_t PathBuffer[256];
+	LWFileStream Stream;
+	Cached = false;
+	if (!LWFileStream::OpenStream(Stream, Path, LWFileStream::ReadMode | LWFileStream::BinaryMode, Alloc)) {
+		A->SetMessage("Error loading gltf model.");
+		return false;
+	}
+	uint64_t ModifiedTime = Stream.GetModifiedTime();
+	Path.Copy(PathBuffer, sizeof(PathBuffer));
+	//Find the entry for Path, otherwise take an empty or the least recently used entry.
+	CachedScene *Entry = nullptr;
+	for (auto &&C : m_SceneCache) {
+		if (C.m_Scene && !strcmp((const char*)C.m_Path, (const char*)PathBuffer)) {
+			Entry = &C;
+			break;
+		}
+		if (!Entry || (Entry->m_Scene && (!C.m_Scene || C.m_LastUsed < Entry->m_LastUsed))) Entry = &C;
+	}
+	Scene *PrevScene = m_ViewScene;
+	bool PrevCached = isSceneCached(PrevScene);
+	if (Entry->m_Scene && Entry->m_ModifiedTime == ModifiedTime && !strcmp((const char*)Entry->m_Path, (const char*)PathBuffer)) Cached = true;
+	else {
+		Scene *S = Alloc.Create<Scene>();
+		if (!Scene::LoadGLTFFile(*S, Path, A->GetRenderer(), Alloc)) {
+			A->SetMessage("Error loading gltf model.");
+			LWAllocator::Destroy(S);
+			return false;
+		}
+		//The update thread may still be drawing the current scene, so it's retired through the old scene like LoadScene, any other evicted scene isn't in use.
+		if (Entry->m_Scene && Entry->m_Scene == PrevScene) {
+			m_OldScene = LWAllocator::Destroy(m_OldScene);
+			m_OldScene = PrevScene;
+			PrevCached = true;
+		} else LWAllocator::Destroy(Entry->m_Scene);
+		Entry->m_Scene = S;
+		Entry->m_ModifiedTime = ModifiedTime;
+		memcpy(Entry->m_Path, PathBuffer, sizeof(PathBuffer));
+	}
+	Entry->m_LastUsed = ++m_SceneCacheTick;
+	if (PrevScene && !PrevCached) {
+		m_OldScene = LWAllocator::Destroy(m_OldScene);
+		m_OldScene = PrevScene;
+	}
+	A->SetMessage(Cached ? "Reused loaded model." : "Loaded model.");
+	m_Time = 0.0f;
+	m_ViewScene = Entry->m_Scene;
+	return true;
+}
+
 void State_Viewer::SetTime(float Time) {
 	m_Time = Time;
 	return;
 }
 
 bool State_Viewer::FinalizeExport(Renderer *R, App *A) {
-	//Additional output names.
-	if (m_ExportFinalFrame >= R->GetCurrentRenderedFrame()) return false;
+	UIFile &UIFileProps = m_UIViewer.m_FileProps;
+	uint32_t ExportCnt = UIFileProps.GetExportTypeCount();
+	//Layers are rendered one after another, so each layer is read back as soon as it's last sprite has been rendered while the remaining layers continue rendering.
+	if (m_ExportLayer < ExportCnt) {
+		uint32_t Layer = UIFileProps.GetExportRenderSetting(m_ExportLayer);
+		ExportLayerHashes &L = m_ExportLayers[Layer];
+		uint32_t LayerFinalFrame = m_ExportFirstFrame + L.m_RenderFirst + L.m_RenderCount;
+		if (LayerFinalFrame >= R->GetCurrentRenderedFrame()) return false;
+		if (!WriteExportLayer(Layer, R, A)) {
+			EndExport();
+			return false;
+		}
+		if (++m_ExportLayer < ExportCnt) return false;
+	}
+	//Strip off extension:
+	char8_t NameNoExt[256];
+	MakeExportPathNoExt(NameNoExt, sizeof(NameNoExt));
+
+	//Export Meta-data, the binary meta-data for shards is written by ExportShard::Merge.
+	if (!ExportMetaData(NameNoExt, A)) {
+		EndExport();
+		return true;
+	}
+	bool BinaryMeta = UIFileProps.m_MetaDataTgls.isToggled(1) || m_VerifyMeta;
+	if (BinaryMeta && !m_ExportShard.isSharded() && !ExportBinaryMetaData(NameNoExt, A)) {
+		EndExport();
+		return true;
+	}
+	if (m_VerifyMeta && !m_ExportShard.isSharded() && !VerifyMetaData(NameNoExt, A)) {
+		EndExport();
+		return true;
+	}
+	//Save settings, batch exports leave the user's settings untouched.
+	if (!A->isBatchMode()) SaveSettings(SettingPath, A);
+	m_ExportResult = true;
+	EndExport();
+	A->SetMessage("Finished exporting.");
+	return true;
+}
+
+bool State_Viewer::WriteExportLayer(uint32_t Layer, Renderer *R, App *A) {
 	LWAllocator &Alloc = A->GetAllocator();
-	LWVideoDriver *Driver = A->GetVideoDriver();
-	LWTexture *OutputTex = R->GetOutputTexture();
 	UIFile &UIFileProps = m_UIViewer.m_FileProps;
-	if (!OutputTex) {
+	uint32_t Format = GetExportSheetFormat();
+	SheetEncoding Encoding = RenderEncodings[Layer];
+	Encoding.m_Quality = UIFileProps.GetExportQuality();
+	ExportLayerHashes &L = m_ExportLayers[Layer];
+	//Nothing was rendered into the layer if every sprite is reused.
+	LWVector2i TexSize = L.m_RenderCount ? R->GetOutputSize() : m_ExportTexSize;
+	if (!TexSize.x || !TexSize.y) {
 		A->SetMessage("Error: Texture failed to create(possibly too large.)");
-		m_Exporting = false;
 		return false;
 	}
-	//Strip off extension:
-	LWUTF8Iterator Dir, Name, Ext;
-	LWFileStream::SplitPath(m_ExportPath, Dir, Name, Ext);
-	LWUTF8Iterator NameNoExt = LWUTF8Iterator(Dir, Ext);
+	uint32_t RowLen = (uint32_t)TexSize.x * 4;
+	//Staging buffer is shared by every layer of the export.
+	if (!m_ExportStaging) m_ExportStaging = Alloc.Allocate<uint8_t>(RowLen * (uint32_t)TexSize.y);
+	if (!L.m_RenderCount) std::memset(m_ExportStaging, 0, RowLen * (uint32_t)TexSize.y);
+	else if (!R->ReadOutputLayer(Layer, m_ExportStaging)) {
+		A->SetMessage("Error occurred while exporting.");
+		return false;
+	}
+	//Strip off extension and add layer name:
+	char8_t NameNoExt[256];
+	MakeExportPathNoExt(NameNoExt, sizeof(NameNoExt));
+	auto Path = LWUTF8I::Fmt<256>("{}{}.{}", NameNoExt, RenderPathNames[Layer], SheetWriter::GetExtension(Format));
+	auto HashPath = LWUTF8I::Fmt<256>("{}.{}", Path, SpriteHashFile::Extension);
+	if (L.m_Reuse && !ReuseExportSprites(Layer, Path, TexSize, A)) {
+		//Make sure the next export doesn't trust the unreadable sheet either.
+		SpriteHashFile().Save(HashPath, Alloc);
+		return false;
+	}
 
-	//Download image from gpu and write output.
-	LWImage OutputImg = LWImage(OutputTex->Get2DSize(), OutputTex->GetPackType(), nullptr, 0, A->GetAllocator());
-	for (uint32_t i = 0; i < RenderCount; i++) {
-		if (!UIFileProps.m_ExportTgls.isToggled(i)) continue;
-		if (!Driver->DownloadTexture2DArray(OutputTex, 0, i, OutputImg.GetTexels(0))) {
-			A->SetMessage("Error occurred while exporting.");
-			m_Exporting = false;
-			return false;
-		}
-		//Add final extensions.
+	//Hand rows to the writer in bands so it can compress while the rest of the layer is still in cache.
+	SheetWriter *Writer = SheetWriter::Make(Format, Alloc);
+	bool Result = Writer->Begin(Path, TexSize, Encoding, Alloc);
+	for (uint32_t y = 0; y < (uint32_t)TexSize.y && Result; y += SheetWriter::BandRows) {
+		Result = Writer->WriteRows(m_ExportStaging + RowLen * y, std::min<uint32_t>(SheetWriter::BandRows, (uint32_t)TexSize.y - y));
+	}
+	Result = Result && Writer->Finish();
+	LWAllocator::Destroy(Writer);
+	if (!Result) {
+		A->SetMessage(LWUTF8I::Fmt<128>("Error occurred saving file '{}'", Path));
+		return false;
+	}
+	if (Format == SheetWriter::FormatQOI && !L.m_Hashes.Save(HashPath, Alloc)) {
+		A->SetMessage(LWUTF8I::Fmt<128>("Error occurred saving file '{}'", HashPath));
+		return false;
+	}
+	return true;
+}
 
-		if (!LWImage::SaveImagePNG(OutputImg, LWUTF8I::Fmt<256>("{}.png", NameNoExt), A->GetAllocator())) {
-			A->SetMessage(LWUTF8I::Fmt<128>("Error occurred saving file '{}'", m_ExportPath));
-			m_Exporting = false;
-			return false;
-		}
+bool State_Viewer::ReuseExportSprites(uint32_t Layer, const LWUTF8Iterator &SheetPath, const LWVector2i &TexSize, App *A) {
+	LWAllocator &Alloc = A->GetAllocator();
+	ExportLayerHashes &L = m_ExportLayers[Layer];
+	uint32_t RowLen = (uint32_t)TexSize.x * 4;
+	std::vector<LWVector4i> Reused;
+	for (uint32_t i = m_ExportSpriteFirst; i < m_ExportSpriteFirst + m_ExportSpriteCount; i++) {
+		if (L.m_PrevHashes.m_Hashes[i] != L.m_Hashes.m_Hashes[i]) continue;
+		Sprite &S = m_ExportList[i];
+		Reused.push_back(LWVector4i(S.m_TexPosition, S.m_TexPosition + S.m_TexSize).Max(LWVector4i(0)).Min(LWVector4i(TexSize, TexSize)));
 	}
-	//Export Meta-data:
-	if (!ExportMetaData(NameNoExt, A)) {
-		m_Exporting = false;
-		return true;
+	SheetReaderQOI Reader;
+	if (!Reader.Open(SheetPath, Alloc) || Reader.GetSize() != TexSize) {
+		A->SetMessage(LWUTF8I::Fmt<256>("Error: Could not read the previous sheet '{}', it will be fully rendered by the next export.", SheetPath));
+		return false;
+	}
+	uint8_t *Band = Alloc.Allocate<uint8_t>(RowLen * SheetWriter::BandRows);
+	bool Result = true;
+	for (uint32_t y = 0; y < (uint32_t)TexSize.y && Result; y += SheetWriter::BandRows) {
+		uint32_t RowCount = std::min<uint32_t>(SheetWriter::BandRows, (uint32_t)TexSize.y - y);
+		Result = Reader.ReadRows(Band, RowCount);
+		for (uint32_t i = 0; i < (uint32_t)Reused.size() && Result; i++) {
+			const LWVector4i &R = Reused[i];
+			int32_t Top = std::max<int32_t>(R.y, (int32_t)y);
+			int32_t Bottom = std::min<int32_t>(R.w, (int32_t)(y + RowCount));
+			for (int32_t r = Top; r < Bottom; r++) std::memcpy(m_ExportStaging + RowLen * r + R.x * 4, Band + RowLen * (r - y) + R.x * 4, (R.z - R.x) * 4);
+		}
 	}
-	//Save settings.
-	SaveSettings(SettingPath, A);
+	LWAllocator::Destroy(Band);
+	if (!Result) A->SetMessage(LWUTF8I::Fmt<256>("Error: Could not read the previous sheet '{}', it will be fully rendered by the next export.", SheetPath));
+	return Result;
+}
+
+void State_Viewer::EndExport(void) {
+	m_ExportStaging = LWAllocator::Destroy(m_ExportStaging);
+	m_ExportLayer = 0;
 	m_Exporting = false;
-	A->SetMessage("Finished exporting.");
-	return true;
+	return;
 }
 
 bool State_Viewer::ExportMetaData(const LWUTF8Iterator &ExportPathNoExt, App *A) {
-	const char8_t *RenderImageNames[] = { "Color", "Emissions", "Normals", "Albedo", "Metallic" };
-	char Buffer[1024 * 128]; //128kb buffer for json.
 	UIFile &UIFileProps = m_UIViewer.m_FileProps;
 	UIIsometricProps &IsoProps = m_UIViewer.m_IsometricProps;
 	UIAnimationProps &AnimProps = m_UIViewer.m_AnimationProps;
 	bool isCenterProps = UIFileProps.m_MetaDataTgls.isToggled(0);
 	uint32_t DirectionCnt = IsoProps.m_DirectionCnt;
 	uint32_t FrameCnt = AnimProps.m_FrameCnt;
+	uint32_t Format = GetExportSheetFormat();
 
 	LWAllocator &Alloc = A->GetAllocator();
-	LWEJson J = LWEJson(Alloc);
+	JsonWriter J;
+	if (!J.Open(LWUTF8I::Fmt<256>("{}.json", ExportPathNoExt), Alloc)) {
+		A->SetMessage(LWUTF8I::Fmt<128>("Error occurred while opening file '{}.json'", ExportPathNoExt));
+		return false;
+	}
 	LWUTF8Iterator Dir, Name;
 	LWFileStream::SplitPath(ExportPathNoExt, Dir, Name);
 	for (uint32_t i = 0; i < RenderCount; i++) {
 		if (!UIFileProps.m_ExportTgls.isToggled(i)) continue;
-		J.MakeStringElement(RenderImageNames[i], LWUTF8I::Fmt<256>("{}{}.png", Name, RenderPathNames[i]));
+		J.String(RenderImageNames[i], LWUTF8I::Fmt<256>("{}{}.{}", Name, RenderPathNames[i], SheetWriter::GetExtension(Format)));
 	}
-	J.MakeValueElement("TotalTime", m_ViewScene->GetTotalTime());
-	J.MakeValueElement("TimeOffset", AnimProps.m_Offset);
-	J.MakeValueElement("RotationOffset", IsoProps.m_ThetaOffset * LW_RADTODEG);
-	LWEJObject *JFramesObj = J.MakeArrayElement("Frames", nullptr);
+	J.Value("TotalTime", m_ViewScene->GetTotalTime());
+	J.Value("TimeOffset", AnimProps.m_Offset);
+	J.Value("RotationOffset", IsoProps.m_ThetaOffset * LW_RADTODEG);
+	J.BeginArray("Frames");
 	for (uint32_t i = 0; i < FrameCnt; i++) {
 		float Time = AnimProps.GetFrameTime(i, A);
-		LWEJObject *JFrameObj = J.PushArrayObjectElement(JFramesObj);
-		J.MakeValueElement("Time", Time, JFrameObj);
-		LWEJObject *JSpritesObj = J.MakeArrayElement("Sprites", JFrameObj);
+		J.BeginObject();
+		J.Value("Time", Time);
+		J.BeginArray("Sprites");
 		for (uint32_t n = 0; n < DirectionCnt; n++) {
 			Sprite &S = m_ExportList[n * FrameCnt + i];
-			LWEJObject *JSpriteObj = J.PushArrayObjectElement(JSpritesObj);
-			J.MakeValueElement("x", S.m_TexPosition.x, JSpriteObj);
-			J.MakeValueElement("y", S.m_TexPosition.y, JSpriteObj);
-			J.MakeValueElement("width", S.m_TexSize.x, JSpriteObj);
-			J.MakeValueElement("height", S.m_TexSize.y, JSpriteObj);
+			J.BeginObject();
+			J.Value("x", S.m_TexPosition.x);
+			J.Value("y", S.m_TexPosition.y);
+			J.Value("width", S.m_TexSize.x);
+			J.Value("height", S.m_TexSize.y);
 			if (isCenterProps) {
-				J.MakeValueElement("xOffset", S.m_SpriteCenter.x, JSpriteObj);
-				J.MakeValueElement("yOffset", S.m_SpriteCenter.y, JSpriteObj);
+				J.Value("xOffset", S.m_SpriteCenter.x);
+				J.Value("yOffset", S.m_SpriteCenter.y);
 			}
+			J.EndObject();
 		}
+		J.EndArray();
+		J.EndObject();
 	}
+	J.EndArray();
+	if (m_ExportShard.isSharded()) {
+		//Merge writes the final sheets and meta-data with the settings the shards were exported with.
+		J.BeginObject("Shard");
+		J.Value("Index", m_ExportShard.m_Index);
+		J.Value("Count", m_ExportShard.m_Count);
+		J.Value("Directions", DirectionCnt);
+		J.Value("Format", UIFileProps.GetExportFormat());
+		J.Value("Quality", UIFileProps.GetExportQuality());
+		J.Value("Offsets", isCenterProps);
+		J.Value("BinaryMeta", UIFileProps.m_MetaDataTgls.isToggled(1));
+		J.EndObject();
+	}
+	if (!J.Finish()) {
+		A->SetMessage(LWUTF8I::Fmt<128>("Error occurred while writing file '{}.json'", ExportPathNoExt));
+		return false;
+	}
+	return true;
+}
 
-	uint32_t Len = J.Serialize(Buffer, sizeof(Buffer), true);
-	LWFileStream Stream;
-	if (!LWFileStream::OpenStream(Stream, LWUTF8I::Fmt<256>("{}.json", ExportPathNoExt), LWFileStream::WriteMode | LWFileStream::BinaryMode, Alloc, nullptr)) {
-		A->SetMessage(LWUTF8I::Fmt<128>("Error occurred while opening file '{}.json'", ExportPathNoExt));
+bool State_Viewer::ExportBinaryMetaData(const LWUTF8Iterator &ExportPathNoExt, App *A) {
+	UIFile &UIFileProps = m_UIViewer.m_FileProps;
+	UIIsometricProps &IsoProps = m_UIViewer.m_IsometricProps;
+	UIAnimationProps &AnimProps = m_UIViewer.m_AnimationProps;
+	bool isCenterProps = UIFileProps.m_MetaDataTgls.isToggled(0);
+	uint32_t DirectionCnt = IsoProps.m_DirectionCnt;
+	uint32_t FrameCnt = AnimProps.m_FrameCnt;
+	uint32_t Format = UIFileProps.GetExportFormat();
+
+	SpriteMetaWriter W;
+	W.SetLayout(DirectionCnt, FrameCnt, isCenterProps ? SpriteMetaHasOffsets : 0);
+	W.SetTimes(m_ViewScene->GetTotalTime(), AnimProps.m_Offset, IsoProps.m_ThetaOffset * LW_RADTODEG);
+	LWUTF8Iterator Dir, Name;
+	LWFileStream::SplitPath(ExportPathNoExt, Dir, Name);
+	for (uint32_t i = 0; i < RenderCount; i++) {
+		if (!UIFileProps.m_ExportTgls.isToggled(i)) continue;
+		W.PushSheet(RenderImageNames[i], LWUTF8I::Fmt<256>("{}{}.{}", Name, RenderPathNames[i], SheetWriter::GetExtension(Format)));
+	}
+	for (uint32_t i = 0; i < FrameCnt; i++) {
+		W.SetFrameTime(i, AnimProps.GetFrameTime(i, A));
+		for (uint32_t n = 0; n < DirectionCnt; n++) {
+			Sprite &S = m_ExportList[n * FrameCnt + i];
+			SpriteMetaRecord Record = { (uint16_t)S.m_TexPosition.x, (uint16_t)S.m_TexPosition.y, (uint16_t)S.m_TexSize.x, (uint16_t)S.m_TexSize.y, 0.0f, 0.0f };
+			if (isCenterProps) {
+				Record.m_XOffset = S.m_SpriteCenter.x;
+				Record.m_YOffset = S.m_SpriteCenter.y;
+			}
+			W.SetSprite(i, n, Record);
+		}
+	}
+	if (!W.Save(LWUTF8I::Fmt<256>("{}.ismeta", ExportPathNoExt), A->GetAllocator())) {
+		A->SetMessage(LWUTF8I::Fmt<128>("Error occurred while writing file '{}.ismeta'", ExportPathNoExt));
 		return false;
 	}
-	Stream.Write(Buffer, Len);
 	return true;
 }
 
-bool State_Viewer::SaveSettings(const LWUTF8Iterator &Path, App *A) {
-	char Buffer[1024 * 128]; //128kb buffer.
+bool State_Viewer::VerifyMetaData(const LWUTF8Iterator &ExportPathNoExt, App *A) {
 	LWAllocator &Alloc = A->GetAllocator();
+	char8_t JsonPath[256];
+	char8_t BinaryPath[256];
+	LWUTF8Iterator(LWUTF8I::Fmt<256>("{}.json", ExportPathNoExt)).Copy(JsonPath, sizeof(JsonPath));
+	LWUTF8Iterator(LWUTF8I::Fmt<256>("{}.ismeta", ExportPathNoExt)).Copy(BinaryPath, sizeof(BinaryPath));
+	auto Mismatch = [A, &JsonPath, &BinaryPath](const LWUTF8Iterator &What) -> bool {
+		A->SetMessage(LWUTF8I::Fmt<512>("Error: '{}' doesn't match '{}', {} differs.", LWUTF8Iterator(BinaryPath), LWUTF8Iterator(JsonPath), What));
+		return false;
+	};
+	LWEJson J = LWEJson(Alloc);
+	if (!LWEJson::LoadFile(J, JsonPath, Alloc, nullptr)) {
+		A->SetMessage(LWUTF8I::Fmt<256>("Error: Could not load meta-data '{}'", LWUTF8Iterator(JsonPath)));
+		return false;
+	}
 	LWFileStream Stream;
+	if (!LWFileStream::OpenStream(Stream, BinaryPath, LWFileStream::ReadMode | LWFileStream::BinaryMode, Alloc, nullptr)) {
+		A->SetMessage(LWUTF8I::Fmt<256>("Error: Could not load meta-data '{}'", LWUTF8Iterator(BinaryPath)));
+		return false;
+	}
+	uint32_t Len = Stream.Length();
+	uint8_t *Data = Alloc.Allocate<uint8_t>(Len);
+	SpriteMetaReader Reader;
+	if (Stream.Read(Data, Len) != Len || !Reader.Open(Data, Len)) {
+		LWAllocator::Destroy(Data);
+		A->SetMessage(LWUTF8I::Fmt<256>("Error: '{}' is not valid binary meta-data.", LWUTF8Iterator(BinaryPath)));
+		return false;
+	}
+	//Floats are written to the json with round trip precision, so every value has to match exactly.
+	auto Compare = [&J, &Reader, &Mismatch]() -> bool {
+		const SpriteMetaHeader *H = Reader.GetHeader();
+		LWEJObject *JTotalTime = J.Find("TotalTime");
+		LWEJObject *JTimeOffset = J.Find("TimeOffset");
+		LWEJObject *JRotationOffset = J.Find("RotationOffset");
+		LWEJObject *JFrames = J.Find("Frames");
+		if (!JTotalTime || JTotalTime->AsFloat() != H->m_TotalTime) return Mismatch("TotalTime");
+		if (!JTimeOffset || JTimeOffset->AsFloat() != H->m_TimeOffset) return Mismatch("TimeOffset");
+		if (!JRotationOffset || JRotationOffset->AsFloat() != H->m_RotationOffset) return Mismatch("RotationOffset");
+		uint32_t SheetCount = 0;
+		for (uint32_t i = 0; i < RenderCount; i++) {
+			LWEJObject *JImage = J.Find(RenderImageNames[i]);
+			if (!JImage) continue;
+			const char *Path = Reader.FindSheetPath((const char*)RenderImageNames[i]);
+			if (!Path || strcmp(Path, (const char*)JImage->m_Value)) return Mismatch(RenderImageNames[i]);
+			SheetCount++;
+		}
+		if (SheetCount != Reader.GetSheetCount()) return Mismatch("the sheet count");
+		if (!JFrames || JFrames->m_Length != Reader.GetFrameCount()) return Mismatch("the frame count");
+		for (uint32_t i = 0; i < JFrames->m_Length; i++) {
+			LWEJObject *JFrame = JFrames->GetChild(i, J);
+			LWEJObject *JTime = JFrame->FindChild("Time", J);
+			LWEJObject *JSprites = JFrame->FindChild("Sprites", J);
+			if (!JTime || JTime->AsFloat() != Reader.GetFrameTimes()[i]) return Mismatch(LWUTF8I::Fmt<64>("the time of frame {}", i));
+			if (!JSprites || JSprites->m_Length != Reader.GetDirectionCount()) return Mismatch(LWUTF8I::Fmt<64>("the direction count of frame {}", i));
+			for (uint32_t n = 0; n < JSprites->m_Length; n++) {
+				const SpriteMetaRecord &R = Reader.GetSprite(i, n);
+				LWEJObject *JSprite = JSprites->GetChild(n, J);
+				LWEJObject *JX = JSprite->FindChild("x", J);
+				LWEJObject *JY = JSprite->FindChild("y", J);
+				LWEJObject *JWidth = JSprite->FindChild("width", J);
+				LWEJObject *JHeight = JSprite->FindChild("height", J);
+				LWEJObject *JXOffset = JSprite->FindChild("xOffset", J);
+				LWEJObject *JYOffset = JSprite->FindChild("yOffset", J);
+				bool Same = JX && JY && JWidth && JHeight && JX->AsInt() == R.m_X && JY->AsInt() == R.m_Y && JWidth->AsInt() == R.m_Width && JHeight->AsInt() == R.m_Height;
+				if (Reader.HasOffsets()) Same = Same && JXOffset && JYOffset && JXOffset->AsFloat() == R.m_XOffset && JYOffset->AsFloat() == R.m_YOffset;
+				else Same = Same && !JXOffset && !JYOffset;
+				if (!Same) return Mismatch(LWUTF8I::Fmt<64>("sprite {} of frame {}", n, i));
+			}
+		}
+		return true;
+	};
+	bool Result = Compare();
+	LWAllocator::Destroy(Data);
+	return Result;
+}
+
+bool State_Viewer::ConvertExport(const LWUTF8Iterator &MetaPath, App *A) {
+	LWAllocator &Alloc = A->GetAllocator();
+	UIFile &UIFileProps = m_UIViewer.m_FileProps;
+	uint32_t Format = UIFileProps.GetExportFormat();
+	if (Format == SheetWriter::FormatQOI) {
+		A->SetMessage("Error: Select PNG, DDS or KTX2 as the format to convert to.");
+		return false;
+	}
 	LWEJson J = LWEJson(Alloc);
-	m_UIViewer.SerializeSettings(J, nullptr, A);
-	uint32_t Len = J.Serialize(Buffer, sizeof(Buffer), true);
-	if (!LWFileStream::OpenStream(Stream, Path, LWFileStream::WriteMode | LWFileStream::BinaryMode, Alloc)) {
+	if (!LWEJson::LoadFile(J, MetaPath, Alloc, nullptr)) {
+		A->SetMessage(LWUTF8I::Fmt<256>("Error: Could not load meta-data '{}'", MetaPath));
+		return false;
+	}
+	//Shard sheets are packed by ExportShard::Merge, which reads them as QOI.
+	if (J.Find("Shard")) {
+		A->SetMessage(LWUTF8I::Fmt<256>("Error: '{}' is shard meta-data, merge the shards before converting.", MetaPath));
+		return false;
+	}
+	//Sheet names are relative to the meta-data's directory.
+	LWUTF8Iterator Dir, Name;
+	LWFileStream::SplitPath(MetaPath, Dir, Name);
+	LWUTF8Iterator MetaDir = LWUTF8Iterator(Dir, Name);
+	//Binary meta-data written next to the json is updated with the same sheet names, if it was exported.
+	LWUTF8Iterator MetaExtDir, MetaExtName, MetaExt;
+	LWFileStream::SplitPath(MetaPath, MetaExtDir, MetaExtName, MetaExt);
+	char8_t BinaryPath[256];
+	LWUTF8Iterator(LWUTF8I::Fmt<256>("{}.ismeta", LWUTF8Iterator(MetaExtDir, MetaExt))).Copy(BinaryPath, sizeof(BinaryPath));
+	SpriteMetaWriter BinaryMeta;
+	bool HasBinaryMeta = BinaryMeta.Load(BinaryPath, Alloc);
+	std::string QOIExt = std::string(".") + (const char*)SheetWriter::GetExtension(SheetWriter::FormatQOI);
+	std::string SheetNames[RenderCount]; //Sheet name each layer's meta-data is rewritten with, empty for layers that weren't exported.
+	uint32_t Converted = 0;
+	for (uint32_t i = 0; i < RenderCount; i++) {
+		LWEJObject *JImage = J.Find(RenderImageNames[i]);
+		if (!JImage) continue;
+		SheetNames[i] = (const char*)JImage->m_Value;
+		//Sheets that aren't QOI are already in a final format and are left as is.
+		const std::string &OldName = SheetNames[i];
+		if (OldName.size() <= QOIExt.size() || OldName.compare(OldName.size() - QOIExt.size(), QOIExt.size(), QOIExt)) continue;
+		SheetEncoding Encoding = RenderEncodings[i];
+		Encoding.m_Quality = UIFileProps.GetExportQuality();
+		std::string NewName = OldName.substr(0, OldName.size() - QOIExt.size()) + "." + (const char*)SheetWriter::GetExtension(Format);
+		const char8_t *OldSheet = (const char8_t*)OldName.c_str();
+		const char8_t *NewSheet = (const char8_t*)NewName.c_str();
+		if (!SheetWriter::Convert(LWUTF8I::Fmt<256>("{}{}", MetaDir, OldSheet), LWUTF8I::Fmt<256>("{}{}", MetaDir, NewSheet), Format, Encoding, Alloc)) {
+			A->SetMessage(LWUTF8I::Fmt<256>("Error: Could not convert sheet '{}{}', the meta-data was left unchanged.", MetaDir, OldSheet));
+			return false;
+		}
+		if (HasBinaryMeta) BinaryMeta.SetSheetPath(RenderImageNames[i], NewSheet);
+		SheetNames[i] = NewName;
+		Converted++;
+	}
+	if (!Converted) {
+		A->SetMessage("Error: No QOI sheets found to convert.");
+		return false;
+	}
+	if (!RewriteMetaData(MetaPath, J, SheetNames, A)) return false;
+	if (HasBinaryMeta && !BinaryMeta.Save(BinaryPath, Alloc)) {
+		A->SetMessage(LWUTF8I::Fmt<256>("Error occurred while writing file '{}'", BinaryPath));
+		return false;
+	}
+	A->SetMessage(LWUTF8I::Fmt<128>("Finished converting {} sheets.", Converted));
+	return true;
+}
+
+bool State_Viewer::RewriteMetaData(const LWUTF8Iterator &MetaPath, LWEJson &J, const std::string *SheetNames, App *A) {
+	LWEJObject *JTotalTime = J.Find("TotalTime");
+	LWEJObject *JTimeOffset = J.Find("TimeOffset");
+	LWEJObject *JRotationOffset = J.Find("RotationOffset");
+	LWEJObject *JFrames = J.Find("Frames");
+	if (!JTotalTime || !JTimeOffset || !JRotationOffset || !JFrames) {
+		A->SetMessage(LWUTF8I::Fmt<256>("Error: '{}' is not sprite meta-data.", MetaPath));
+		return false;
+	}
+	LWAllocator &Alloc = A->GetAllocator();
+	JsonWriter W;
+	if (!W.Open(MetaPath, Alloc)) {
+		A->SetMessage(LWUTF8I::Fmt<256>("Error occurred while opening file '{}'", MetaPath));
+		return false;
+	}
+	for (uint32_t i = 0; i < RenderCount; i++) {
+		if (!SheetNames[i].empty()) W.String(RenderImageNames[i], (const char8_t*)SheetNames[i].c_str());
+	}
+	W.Value("TotalTime", JTotalTime->AsFloat());
+	W.Value("TimeOffset", JTimeOffset->AsFloat());
+	W.Value("RotationOffset", JRotationOffset->AsFloat());
+	W.BeginArray("Frames");
+	for (uint32_t i = 0; i < JFrames->m_Length; i++) {
+		LWEJObject *JFrame = JFrames->GetChild(i, J);
+		LWEJObject *JTime = JFrame->FindChild("Time", J);
+		LWEJObject *JSprites = JFrame->FindChild("Sprites", J);
+		W.BeginObject();
+		if (JTime) W.Value("Time", JTime->AsFloat());
+		W.BeginArray("Sprites");
+		for (uint32_t n = 0; JSprites && n < JSprites->m_Length; n++) {
+			LWEJObject *JSprite = JSprites->GetChild(n, J);
+			const char8_t *IntNames[] = { "x", "y", "width", "height" };
+			const char8_t *FloatNames[] = { "xOffset", "yOffset" };
+			W.BeginObject();
+			for (auto &&N : IntNames) {
+				LWEJObject *JValue = JSprite->FindChild(N, J);
+				if (JValue) W.Value(N, (int32_t)JValue->AsInt());
+			}
+			for (auto &&N : FloatNames) {
+				LWEJObject *JValue = JSprite->FindChild(N, J);
+				if (JValue) W.Value(N, JValue->AsFloat());
+			}
+			W.EndObject();
+		}
+		W.EndArray();
+		W.EndObject();
+	}
+	W.EndArray();
+	if (!W.Finish()) {
+		A->SetMessage(LWUTF8I::Fmt<256>("Error occurred while writing file '{}'", MetaPath));
+		return false;
+	}
+	return true;
+}
+
+bool State_Viewer::SaveSettings(const LWUTF8Iterator &Path, App *A) {
+	LWAllocator &Alloc = A->GetAllocator();
+	JsonWriter J;
+	if (!J.Open(Path, Alloc)) {
 		LogWarn(LWUTF8I::Fmt<256>("Error: Could not open setting file: '{}' to write to.", Path));
 		return false;
 	}
-	Stream.Write(Buffer, Len);
+	m_UIViewer.SerializeSettings(J, A);
+	if (!J.Finish()) {
+		LogWarn(LWUTF8I::Fmt<256>("Error: Could not write setting file: '{}'", Path));
+		return false;
+	}
 	return true;
 }
 
@@ -278,15 +678,43 @@ bool State_Viewer::LoadSettings(const LWUTF8Iterator &Path, App *A) {
 	return true;
 }
 
-bool State_Viewer::Export(const LWUTF8Iterator &ExportPath) {
+bool State_Viewer::Export(const LWUTF8Iterator &ExportPath, App *A, const ExportShard &Shard) {
+	if (!m_ViewScene) {
+		A->SetMessage("Must load a model first.");
+		return false;
+	}
+	if (!m_UIViewer.m_FileProps.GetExportTypeCount()) {
+		A->SetMessage("No export setting selected.");
+		return false;
+	}
+	if (Shard.isSharded() && (Shard.m_Index >= Shard.m_Count || Shard.m_Count > m_UIViewer.m_IsometricProps.m_DirectionCnt)) {
+		A->SetMessage(LWUTF8I::Fmt<128>("Error: Can't split {} directions into {} shards.", m_UIViewer.m_IsometricProps.m_DirectionCnt, Shard.m_Count));
+		return false;
+	}
 	//Initialize export settings.
 	ExportPath.Copy(m_ExportPath, sizeof(m_ExportPath));
+	m_ExportShard = Shard;
 	m_ExportFirstFrame = -1;
 	m_ExportFinalFrame = -1;
+	m_ExportLayer = 0;
+	m_ExportResult = false;
 	m_Exporting = true;
 	return true;
 }
 
+bool State_Viewer::isExporting(void) const {
+	return m_Exporting;
+}
+
+State_Viewer &State_Viewer::SetVerifyMeta(bool VerifyMeta) {
+	m_VerifyMeta = VerifyMeta;
+	return *this;
+}
+
+bool State_Viewer::GetExportResult(void) const {
+	return m_ExportResult;
+}
+
 void State_Viewer::SetModelTheta(float Theta) {
 	m_ModelTheta = Theta;
 	return;
@@ -312,6 +740,103 @@ State_Viewer::State_Viewer(App *A, LWAllocator &Allocator) {
 }
 
 State_Viewer::~State_Viewer() {
+	LWAllocator::Destroy(m_ExportStaging);
 	LWAllocator::Destroy(m_OldScene);
-	LWAllocator::Destroy(m_ViewScene);
+	if (!isSceneCached(m_ViewScene)) LWAllocator::Destroy(m_ViewScene);
+	for (auto &&C : m_SceneCache) LWAllocator::Destroy(C.m_Scene);
+}
+
+void State_Viewer::MakeExportPathNoExt(char8_t *Buffer, uint32_t BufferLen) const {
+	if (m_ExportShard.isSharded()) {
+		m_ExportShard.MakePathNoExt(m_ExportPath, Buffer, BufferLen);
+		return;
+	}
+	LWUTF8Iterator Dir, Name, Ext;
+	LWFileStream::SplitPath(m_ExportPath, Dir, Name, Ext);
+	LWUTF8Iterator(Dir, Ext).Copy(Buffer, BufferLen);
+	return;
+}
+
+uint32_t State_Viewer::GetExportSheetFormat(void) {
+	if (m_ExportShard.isSharded()) return SheetWriter::FormatQOI;
+	return m_UIViewer.m_FileProps.GetExportFormat();
+}
+
+void State_Viewer::BuildExportRenderList(const LWVector2f &WndSize, Renderer *R, App *A) {
+	LWAllocator &Alloc = A->GetAllocator();
+	UIFile &FileProps = m_UIViewer.m_FileProps;
+	UIIsometricProps &IsoProps = m_UIViewer.m_IsometricProps;
+	UILightingProps &LightProps = m_UIViewer.m_LightingProps;
+	Camera &Cam = GetCamera();
+	uint32_t ExportCnt = FileProps.GetExportTypeCount();
+	uint32_t SpriteCnt = (uint32_t)m_ExportList.size();
+	uint32_t SpriteEnd = m_ExportSpriteFirst + m_ExportSpriteCount;
+	uint32_t Format = GetExportSheetFormat();
+	bool isUsingIBL = LightProps.isUsingIBL();
+	char8_t NameNoExt[256];
+	MakeExportPathNoExt(NameNoExt, sizeof(NameNoExt));
+
+	//Inputs shared by every sprite, the ibl maps are identified by their path and modified time.
+	SpriteHasher Shared;
+	Shared.Push(SpriteHashFile::Version).Push(R->isSoftware()).Push(WndSize).Push(m_ExportTexSize).Push(Cam.GetProjViewMatrix()).Push(isUsingIBL);
+	if (isUsingIBL) {
+		UILightIBLProps &IBLProps = LightProps.m_IBLProps;
+		const char8_t *IBLPaths[] = { IBLProps.m_brdfPath, IBLProps.m_DiffusePath, IBLProps.m_SpecularPath };
+		for (auto &&Path : IBLPaths) {
+			LWFileStream Stream;
+			uint64_t ModifiedTime = 0;
+			if (LWFileStream::OpenStream(Stream, Path, LWFileStream::ReadMode | LWFileStream::BinaryMode, Alloc)) ModifiedTime = Stream.GetModifiedTime();
+			Shared.Push(Path, (uint32_t)strlen((const char*)Path)).Push(ModifiedTime);
+		}
+	} else {
+		Light SunLight = LightProps.m_SunProps.MakeLightSource();
+		Shared.Push(SunLight.m_Position).Push(SunLight.m_Direction).Push(SunLight.m_Color).Push(SunLight.m_Flag);
+	}
+	SpriteHasher Layout = SpriteHasher().Push(m_ExportTexSize).Push(SpriteCnt);
+	for (auto &&S : m_ExportList) Layout.Push(S.m_TexPosition).Push(S.m_TexSize);
+
+	//Sprites outside of a shard's range are never rendered into it's sheet, and keep a hash of 0.
+	std::vector<uint64_t> SpriteHashes(SpriteCnt, 0);
+	for (uint32_t i = m_ExportSpriteFirst; i < SpriteEnd; i++) {
+		Sprite &S = m_ExportList[i];
+		SpriteHasher H = SpriteHasher(Shared.Get()).Push(S.m_ViewBounds).Push(S.m_TexPosition).Push(S.m_TexSize).Push(S.m_Time);
+		m_ViewScene->HashScene(H, R, S.m_Time, LWSMatrix4f::RotationY(IsoProps.CalculateDirectionTheta(S.m_Direction)));
+		SpriteHashes[i] = H.Get();
+	}
+
+	m_ExportRenderList.clear();
+	for (uint32_t i = 0; i < ExportCnt; i++) {
+		uint32_t Layer = FileProps.GetExportRenderSetting(i);
+		ExportLayerHashes &L = m_ExportLayers[Layer];
+		L.m_Hashes.m_TexSize = m_ExportTexSize;
+		L.m_Hashes.m_LayoutHash = Layout.Get();
+		L.m_Hashes.m_Hashes.assign(SpriteCnt, 0);
+		for (uint32_t n = m_ExportSpriteFirst; n < SpriteEnd; n++) L.m_Hashes.m_Hashes[n] = SpriteHasher(SpriteHashes[n]).Push(Layer).Get();
+
+		L.m_Reuse = false;
+		if (Format == SheetWriter::FormatQOI) {
+			auto Path = LWUTF8I::Fmt<256>("{}{}.{}", NameNoExt, RenderPathNames[Layer], SheetWriter::GetExtension(Format));
+			SpriteHashFile &Prev = L.m_PrevHashes;
+			if (Prev.Load(LWUTF8I::Fmt<256>("{}.{}", Path, SpriteHashFile::Extension), Alloc) && Prev.m_TexSize == m_ExportTexSize && Prev.m_LayoutHash == L.m_Hashes.m_LayoutHash && Prev.m_Hashes.size() == SpriteCnt) {
+				SheetReaderQOI Reader;
+				L.m_Reuse = Reader.Open(Path, Alloc) && Reader.GetSize() == m_ExportTexSize;
+			}
+		}
+		L.m_RenderFirst = (uint32_t)m_ExportRenderList.size();
+		for (uint32_t n = m_ExportSpriteFirst; n < SpriteEnd; n++) {
+			if (!L.m_Reuse || L.m_PrevHashes.m_Hashes[n] != L.m_Hashes.m_Hashes[n]) m_ExportRenderList.push_back(n);
+		}
+		L.m_RenderCount = (uint32_t)m_ExportRenderList.size() - L.m_RenderFirst;
+	}
+	uint32_t Total = m_ExportSpriteCount * ExportCnt;
+	if (m_ExportRenderList.size() < Total) LogEvent(LWUTF8I::Fmt<128>("Incremental export: rendering {} of {} sprites.", m_ExportRenderList.size(), Total));
+	return;
+}
+
+bool State_Viewer::isSceneCached(Scene *S) const {
+	if (!S) return false;
+	for (auto &&C : m_SceneCache) {
+		if (C.m_Scene == S) return true;
+	}
+	return false;
 }
\ No newline at end of file
@@ -33,9 +33,9 @@ void UIAnimationProps::ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *
 	return;
 }
 
-void UIAnimationProps::SerializeSettings(LWEJson &JSon, LWEJObject *Parent, App *A) {
-	JSon.MakeValueElement("FrameCnt", m_FrameCnt, Parent);
-	JSon.MakeValueElement("FrameOffset", m_Offset, Parent);
+void UIAnimationProps::SerializeSettings(JsonWriter &JSon, App *A) {
+	JSon.Value("FrameCnt", m_FrameCnt);
+	JSon.Value("FrameOffset", m_Offset);
 	return;
 }
 
@@ -17,9 +17,9 @@ void UIPerspectiveControls::ProcessInput(float dTime, LWEUIManager *UIMan, LWWin
 }
 
 
-void UIPerspectiveControls::SerializeSettings(LWEJson &JSon, LWEJObject *Parent, App *A) {
+void UIPerspectiveControls::SerializeSettings(JsonWriter &JSon, App *A) {
 	CameraPerspective &P = m_UICamControls->m_Camera.GetPerspectivePropertys();
-	JSon.MakeValueElement("Perspective_FoV", P.m_FOV*LW_RADTODEG, Parent);
+	JSon.Value("Perspective_FoV", P.m_FOV*LW_RADTODEG);
 	return;
 }
 
@@ -58,10 +58,10 @@ void UIOrthoControls::ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *W
 	return;
 }
 
-void UIOrthoControls::SerializeSettings(LWEJson &JSon, LWEJObject *Parent, App *A) {
+void UIOrthoControls::SerializeSettings(JsonWriter &JSon, App *A) {
 	CameraOrtho &O = m_UICamControls->m_Camera.GetOrthoPropertys();
-	JSon.MakeValueElement("Ortho_Width", O.m_Right, Parent);
-	JSon.MakeValueElement("Ortho_Height", O.m_Top, Parent);
+	JSon.Value("Ortho_Width", O.m_Right);
+	JSon.Value("Ortho_Height", O.m_Top);
 	return;
 }
 
@@ -165,7 +165,7 @@ void UICameraControls::ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *
 	return;
 }
 
-void UICameraControls::SerializeSettings(LWEJson &JSon, LWEJObject *Parent, App *A) {
+void UICameraControls::SerializeSettings(JsonWriter &JSon, App *A) {
 	const uint32_t PerspectiveToggle = 0;
 	const uint32_t OrthoToggle = 1;
 
@@ -174,12 +174,12 @@ void UICameraControls::SerializeSettings(LWEJson &JSon, LWEJObject *Parent, App
 	float Theta = atan2f(Dir.z, Dir.x)*LW_RADTODEG;
 	float Len = m_Camera.GetPosition().Length3();
 	uint32_t CType = m_TypeTglGroup.NextToggled();
-	JSon.MakeValueElement("CPitch", Pitch, Parent);
-	JSon.MakeValueElement("CTheta", Theta, Parent);
-	JSon.MakeValueElement("CDistance", Len, Parent);
-	JSon.MakeValueElement("CType", CType, Parent);
-	if (CType == PerspectiveToggle) m_PerspectiveControls.SerializeSettings(JSon, Parent, A);
-	else if (CType == OrthoToggle) m_OrthoControls.SerializeSettings(JSon, Parent, A);
+	JSon.Value("CPitch", Pitch);
+	JSon.Value("CTheta", Theta);
+	JSon.Value("CDistance", Len);
+	JSon.Value("CType", CType);
+	if (CType == PerspectiveToggle) m_PerspectiveControls.SerializeSettings(JSon, A);
+	else if (CType == OrthoToggle) m_OrthoControls.SerializeSettings(JSon, A);
 	return;
 }
 
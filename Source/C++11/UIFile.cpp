@@ -4,6 +4,7 @@
 #include "App.h"
 #include "UIIsometricProps.h"
 #include "UIAnimationProps.h"
+#include "SheetWriter.h"
 #include <LWEJson.h>
 
 //Sprite
@@ -45,15 +46,19 @@ void UIFile::ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *Window, Ap
 	return;
 }
 
-void UIFile::SerializeSettings(LWEJson &J, LWEJObject *Parent, App *A) {
+void UIFile::SerializeSettings(JsonWriter &J, App *A) {
 	//Create bitmask of settings.
 	uint32_t ExportSettings = m_ExportTgls.GetToggledMask();
 	uint32_t PackingSettings = m_PackingTgls.GetToggledMask();
 	uint32_t MetaSettings = m_MetaDataTgls.GetToggledMask();
+	uint32_t FormatSettings = m_FormatTgls.GetToggledMask();
+	uint32_t QualitySettings = m_QualityTgls.GetToggledMask();
 
-	J.MakeValueElement("ExportSettings", ExportSettings, Parent);
-	J.MakeValueElement("PackingSettings", PackingSettings, Parent);
-	J.MakeValueElement("MetaSettings", MetaSettings, Parent);
+	J.Value("ExportSettings", ExportSettings);
+	J.Value("PackingSettings", PackingSettings);
+	J.Value("MetaSettings", MetaSettings);
+	J.Value("FormatSettings", FormatSettings);
+	J.Value("QualitySettings", QualitySettings);
 	return;
 }
 
@@ -61,6 +66,8 @@ void UIFile::DeserializeSettings(LWEJson &J, LWEJObject *Parent, App *A) {
 	LWEJObject *JExportSettings = Parent->FindChild("ExportSettings", J);
 	LWEJObject *JPackingSettings = Parent->FindChild("PackingSettings", J);
 	LWEJObject *JMetaSettings = Parent->FindChild("MetaSettings", J);
+	LWEJObject *JFormatSettings = Parent->FindChild("FormatSettings", J);
+	LWEJObject *JQualitySettings = Parent->FindChild("QualitySettings", J);
 
 	if (JExportSettings) {
 		uint32_t ExportMask = JExportSettings->AsInt();
@@ -74,6 +81,14 @@ void UIFile::DeserializeSettings(LWEJson &J, LWEJObject *Parent, App *A) {
 		uint32_t MetaSettings = JMetaSettings->AsInt();
 		m_MetaDataTgls.ApplyToggledMask(MetaSettings);
 	}
+	if (JFormatSettings) {
+		uint32_t FormatSettings = JFormatSettings->AsInt();
+		m_FormatTgls.ApplyToggledMask(FormatSettings);
+	}
+	if (JQualitySettings) {
+		uint32_t QualitySettings = JQualitySettings->AsInt();
+		m_QualityTgls.ApplyToggledMask(QualitySettings);
+	}
 	return;
 }
 
@@ -98,8 +113,18 @@ void UIFile::ExportFileBtnReleased(LWEUI *UI, uint32_t EventCode, void *UserData
 		A->SetMessage("No export setting selected.");
 		return;
 	}
-	if (!LWWindow::MakeSaveFileDialog("*.png:PNG File", Buffer, sizeof(Buffer))) return;
-	SV->Export(Buffer);
+	const char8_t *FormatFilters[SheetWriter::FormatCount] = { "*.png:PNG File", "*.dds:DDS File", "*.ktx2:KTX2 File", "*.qoi:QOI File" };
+	if (!LWWindow::MakeSaveFileDialog(FormatFilters[GetExportFormat()], Buffer, sizeof(Buffer))) return;
+	SV->Export(Buffer, A);
+	return;
+}
+
+void UIFile::ConvertFileBtnReleased(LWEUI *UI, uint32_t EventCode, void *UserData) {
+	char8_t Buffer[256];
+	App *A = (App*)UserData;
+	State_Viewer *SV = A->GetState<State_Viewer>(State::Viewer);
+	if (!LWWindow::MakeLoadFileDialog("*.json:Meta File", Buffer, sizeof(Buffer))) return;
+	SV->ConvertExport(Buffer, A);
 	return;
 }
 
@@ -121,6 +146,16 @@ uint32_t UIFile::GetExportRenderSetting(uint32_t Idx) {
 	return 0;
 }
 
+uint32_t UIFile::GetExportFormat(void) {
+	uint32_t Format = m_FormatTgls.NextToggled();
+	return Format < SheetWriter::FormatCount ? Format : SheetWriter::FormatPNG;
+}
+
+uint32_t UIFile::GetExportQuality(void) {
+	uint32_t Quality = m_QualityTgls.NextToggled();
+	return Quality < BlockCompress::QualityCount ? Quality : BlockCompress::QualityNormal;
+}
+
 LWVector2i UIFile::CalculateTightSpriteLocations(const LWVector2f &WndSize, Scene *S, Camera &Cam, UIIsometricProps &IsoProps, UIAnimationProps &AnimProps, App *A, std::vector<Sprite> &SpriteArray){
 	const int32_t BorderSize = 1;
 	uint32_t DirectionCnt = IsoProps.m_DirectionCnt;
@@ -216,9 +251,19 @@ void UIFile::MetaDataTglChanged(UIToggleGroup &TglGroup, uint32_t ToggleID, UITo
 	return;
 }
 
+void UIFile::FormatTglChanged(UIToggleGroup &TglGroup, uint32_t ToggleID, UIToggle &Toggle, bool Toggled, void *UserData) {
+	return;
+}
+
+void UIFile::QualityTglChanged(UIToggleGroup &TglGroup, uint32_t ToggleID, UIToggle &Toggle, bool Toggled, void *UserData) {
+	//The preset is read back by GetExportQuality when an export starts.
+	return;
+}
+
 UIFile::UIFile(const LWUTF8Iterator &Name, LWEUIManager *UIMan, UIViewer *Viewer, App *A) : UIItem(Name, UIMan), m_Viewer(Viewer) {
 	UILabelBtn::MakeMethod(m_SelectFileBtn, LWUTF8I::Fmt<128>("{}.SelectFileBtn", Name), UIMan, &UIFile::SelectFileBtnReleased, this, A);
 	UILabelBtn::MakeMethod(m_ExportFileBtn, LWUTF8I::Fmt<128>("{}.ExportBtn", Name), UIMan, &UIFile::ExportFileBtnReleased, this, A);
+	UILabelBtn::MakeMethod(m_ConvertFileBtn, LWUTF8I::Fmt<128>("{}.ConvertBtn", Name), UIMan, &UIFile::ConvertFileBtnReleased, this, A);
 
 	m_TextureSizeLbl = (LWEUILabel *)UIMan->GetNamedUI(LWUTF8I::Fmt<128>("{}.TexSizeLbl", Name));
 
@@ -236,7 +281,21 @@ UIFile::UIFile(const LWUTF8Iterator &Name, LWEUIManager *UIMan, UIViewer *Viewer
 
 	UIToggleGroup::MakeMethod(m_MetaDataTgls, UIToggleGroup::AllowMultipleToggles, &UIFile::MetaDataTglChanged, this, A);
 	m_MetaDataTgls.PushToggle(LWUTF8I::Fmt<128>("{}.MetaCenterTgl", Name), UIMan);
+	m_MetaDataTgls.PushToggle(LWUTF8I::Fmt<128>("{}.MetaBinaryTgl", Name), UIMan);
 	//m_MetaDataTgls.PushToggle(StackText("%s.MetaBonesTgl", Name()), UIMan);
 	m_MetaDataTgls.SetToggled(0, true);
+	m_MetaDataTgls.SetToggled(1, true);
+
+	UIToggleGroup::MakeMethod(m_FormatTgls, UIToggleGroup::AlwaysOneActive, &UIFile::FormatTglChanged, this, A);
+	m_FormatTgls.PushToggle(LWUTF8I::Fmt<128>("{}.FormatPNGTgl", Name), UIMan);
+	m_FormatTgls.PushToggle(LWUTF8I::Fmt<128>("{}.FormatDDSTgl", Name), UIMan);
+	m_FormatTgls.PushToggle(LWUTF8I::Fmt<128>("{}.FormatKTX2Tgl", Name), UIMan);
+	m_FormatTgls.PushToggle(LWUTF8I::Fmt<128>("{}.FormatQOITgl", Name), UIMan);
+	m_FormatTgls.SetToggled(SheetWriter::FormatPNG, true);
 
+	UIToggleGroup::MakeMethod(m_QualityTgls, UIToggleGroup::AlwaysOneActive, &UIFile::QualityTglChanged, this, A);
+	m_QualityTgls.PushToggle(LWUTF8I::Fmt<128>("{}.QualityFastTgl", Name), UIMan);
+	m_QualityTgls.PushToggle(LWUTF8I::Fmt<128>("{}.QualityNormalTgl", Name), UIMan);
+	m_QualityTgls.PushToggle(LWUTF8I::Fmt<128>("{}.QualityBestTgl", Name), UIMan);
+	m_QualityTgls.SetToggled(BlockCompress::QualityNormal, true);
 }
\ No newline at end of file
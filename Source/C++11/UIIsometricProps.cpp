@@ -17,9 +17,9 @@ void UIIsometricProps::ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *
 	return;
 }
 
-void UIIsometricProps::SerializeSettings(LWEJson &J, LWEJObject *Parent, App *A) {
-	J.MakeValueElement("Directions", m_DirectionCnt, Parent);
-	J.MakeValueElement("RotationOffset", m_ThetaOffset * LW_RADTODEG, Parent);
+void UIIsometricProps::SerializeSettings(JsonWriter &J, App *A) {
+	J.Value("Directions", m_DirectionCnt);
+	J.Value("RotationOffset", m_ThetaOffset * LW_RADTODEG);
 	return;
 }
 
@@ -27,9 +27,9 @@ void UILightSunProps::ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *W
 	return;
 }
 
-void UILightSunProps::SerializeSettings(LWEJson &J, LWEJObject *Parent, App *A) {
-	J.MakeValueElement("SunPitch", m_Pitch * LW_RADTODEG, Parent);
-	J.MakeValueElement("SunRotation", m_Rotation * LW_RADTODEG, Parent);
+void UILightSunProps::SerializeSettings(JsonWriter &J, App *A) {
+	J.Value("SunPitch", m_Pitch * LW_RADTODEG);
+	J.Value("SunRotation", m_Rotation * LW_RADTODEG);
 	return;
 }
 
@@ -114,16 +114,10 @@ void UILightIBLProps::ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *W
 	return;
 }
 
-void UILightIBLProps::SerializeSettings(LWEJson &J, LWEJObject *Parent, App *A) {
-	LWEJObject *JIBLbrdf = J.MakeStringElement("IBLbrdf", "", Parent);
-	LWEJObject *JIBLDiffuse = J.MakeStringElement("IBLDiffuse", "", Parent);
-	LWEJObject *JIBLSpecular = J.MakeStringElement("IBLSpecular", "", Parent);
-
-	//TODO: Fix escape text bug in LWEJson implementation.
-	JIBLbrdf->SetValue(J.GetAllocator(), m_brdfPath);
-	JIBLDiffuse->SetValue(J.GetAllocator(), m_DiffusePath);
-	JIBLSpecular->SetValue(J.GetAllocator(), m_SpecularPath);
-
+void UILightIBLProps::SerializeSettings(JsonWriter &J, App *A) {
+	J.String("IBLbrdf", m_brdfPath);
+	J.String("IBLDiffuse", m_DiffusePath);
+	J.String("IBLSpecular", m_SpecularPath);
 	return;
 }
 
@@ -227,11 +221,11 @@ void UILightingProps::ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *W
 	return;
 }
 
-void UILightingProps::SerializeSettings(LWEJson &J, LWEJObject *Parent, App *A) {
+void UILightingProps::SerializeSettings(JsonWriter &J, App *A) {
 	uint32_t LightMask = m_LightTypeTgl.GetToggledMask();
-	J.MakeValueElement("LightType", LightMask, Parent);
-	m_SunProps.SerializeSettings(J, Parent, A);
-	m_IBLProps.SerializeSettings(J, Parent, A);
+	J.Value("LightType", LightMask);
+	m_SunProps.SerializeSettings(J, A);
+	m_IBLProps.SerializeSettings(J, A);
 	return;
 }
 
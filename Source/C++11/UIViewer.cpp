@@ -31,13 +31,14 @@ void UIViewer::ProcessInput(float dTime, LWEUIManager *UIMan, LWWindow *Window,
 	return;
 }
 
-void UIViewer::SerializeSettings(LWEJson &J, LWEJObject *Parent, App *A) {
-	LWEJObject *Settings = J.MakeObjectElement("Settings", Parent);
-	m_FileProps.SerializeSettings(J, Settings, A);
-	m_CameraProps.SerializeSettings(J, Settings, A);
-	m_IsometricProps.SerializeSettings(J, Settings, A);
-	m_AnimationProps.SerializeSettings(J, Settings, A);
-	m_LightingProps.SerializeSettings(J, Settings, A);
+void UIViewer::SerializeSettings(JsonWriter &J, App *A) {
+	J.BeginObject("Settings");
+	m_FileProps.SerializeSettings(J, A);
+	m_CameraProps.SerializeSettings(J, A);
+	m_IsometricProps.SerializeSettings(J, A);
+	m_AnimationProps.SerializeSettings(J, A);
+	m_LightingProps.SerializeSettings(J, A);
+	J.EndObject();
 	return;
 }
 
@@ -0,0 +1,65 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+//WorkerPool
+void WorkerPool::Run(uint32_t JobCount, const JobFunc &Fn) {
+	if (!JobCount) return;
+	if (m_Threads.empty() || JobCount == 1) {
+		for (uint32_t i = 0; i < JobCount; i++) Fn(i, 0);
+		return;
+	}
+	std::lock_guard<std::mutex> RunLock(m_RunLock);
+	{
+		std::lock_guard<std::mutex> Lock(m_Lock);
+		m_Fn = &Fn;
+		m_JobCount = JobCount;
+		m_NextJob = 0;
+		m_BusyWorkers = (uint32_t)m_Threads.size();
+		m_Generation++;
+	}
+	m_WakeCondition.notify_all();
+	Work(0);
+	std::unique_lock<std::mutex> Lock(m_Lock);
+	//Every worker has to check in, so none are still reading m_Fn once Run returns.
+	m_DoneCondition.wait(Lock, [this]() { return !m_BusyWorkers; });
+	m_Fn = nullptr;
+	return;
+}
+
+uint32_t WorkerPool::GetThreadCount(void) const {
+	return (uint32_t)m_Threads.size() + 1;
+}
+
+void WorkerPool::WorkerThread(uint32_t WorkerID) {
+	uint32_t Generation = 0;
+	std::unique_lock<std::mutex> Lock(m_Lock);
+	while (true) {
+		m_WakeCondition.wait(Lock, [this, &Generation]() { return m_Quit || m_Generation != Generation; });
+		if (m_Quit) break;
+		Generation = m_Generation;
+		Lock.unlock();
+		Work(WorkerID);
+		Lock.lock();
+		if (!--m_BusyWorkers) m_DoneCondition.notify_one();
+	}
+	return;
+}
+
+void WorkerPool::Work(uint32_t WorkerID) {
+	for (uint32_t i = m_NextJob.fetch_add(1); i < m_JobCount; i = m_NextJob.fetch_add(1)) (*m_Fn)(i, WorkerID);
+	return;
+}
+
+WorkerPool::WorkerPool(uint32_t ThreadCount) {
+	if (!ThreadCount) ThreadCount = std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+	for (uint32_t i = 1; i < ThreadCount; i++) m_Threads.emplace_back(&WorkerPool::WorkerThread, this, i);
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> Lock(m_Lock);
+		m_Quit = true;
+	}
+	m_WakeCondition.notify_all();
+	for (auto &&T : m_Threads) T.join();
+}
\ No newline at end of file
@@ -6,13 +6,18 @@
 int32_t LWMain(int32_t argc, LWUTF8Iterator *argv) {
 	LWAllocator_Default DefAlloc;
 	//LWAllocator_DefaultDebug DefAlloc;
-	App *A = DefAlloc.Create<App>(DefAlloc);
-	A->Run();
+	BatchExport Batch;
+	uint32_t BatchMode = BatchExport::ParseArguments(argc, argv, Batch);
+	if (BatchMode == BatchExport::Invalid) return 1;
+	//Merging shards only reads and writes files, so no window or renderer is needed.
+	if (BatchMode == BatchExport::Valid && Batch.m_Merge) return ExportShard::Merge(Batch.m_OutputPath, DefAlloc) ? 0 : 1;
+	App *A = DefAlloc.Create<App>(DefAlloc, BatchMode == BatchExport::Valid ? &Batch : nullptr);
+	int32_t ExitCode = A->Run();
 	LWAllocator::Destroy(A);
 	if (DefAlloc.GetAllocatedBytes()) {
 		//DefAlloc.OutputUnfreedIDs();
 		LogCritical(LWUTF8I::Fmt<256>("Error: Memory leak, remaining bytes: {}", DefAlloc.GetAllocatedBytes()));
 	}
 
-	return 0;
+	return ExitCode;
 }
\ No newline at end of file